@@ -0,0 +1,81 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <cstdlib>
+#include "../src/MortonMatrix.h"
+
+using namespace std;
+
+// Compares row-major Matrix with Morton-ordered MortonMatrix on multiplication and transpose.
+// Conversion between the two is timed separately. Usage: morton [size] [repetitions]
+
+const int SIZE = 512;
+const int REPETITIONS = 3;
+
+template<class F>
+double best_seconds(int repetitions, F work) {
+    double best = 1e30;
+    for (int r = 0; r < repetitions; ++r) {
+        auto start = chrono::steady_clock::now();
+        work();
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        best = min(best, elapsed.count());
+    }
+    return best;
+}
+
+void report(const string& name, double seconds, double flops) {
+    cout << "  " << setw(24) << left << name << right << setw(10) << fixed << setprecision(2)
+         << seconds * 1000 << " ms";
+    if (flops > 0) {
+        cout << setw(10) << setprecision(2) << flops / seconds / 1e9 << " GFLOP/s";
+    }
+    cout << endl;
+}
+
+int main(int argc, char** argv) {
+    int size = argc > 1 ? atoi(argv[1]) : SIZE;
+    int repetitions = argc > 2 ? atoi(argv[2]) : REPETITIONS;
+
+    Matrix<double> a = Matrix<double>::natural(size, size);
+    Matrix<double> b = a.transpose();
+    double flops = 2.0 * size * size * size;
+    double checksum = 0;
+
+    cout << size << "x" << size << " doubles, " << parallel_threads() << " threads, best of "
+         << repetitions << endl;
+
+    cout << "row-major Matrix" << endl;
+    report("multiply", best_seconds(repetitions, [&]() {
+        Matrix<double> c = a * b;
+        checksum += c.at(size, size);
+    }), flops);
+    report("transpose", best_seconds(repetitions, [&]() {
+        Matrix<double> t = a.transpose();
+        checksum += t.at(size, 1);
+    }), 0);
+
+    cout << "MortonMatrix" << endl;
+    report("conversion from dense", best_seconds(repetitions, [&]() {
+        MortonMatrix<double> m = MortonMatrix<double>::from_dense(a);
+        checksum += m.at(size, size);
+    }), 0);
+    MortonMatrix<double> ma = MortonMatrix<double>::from_dense(a);
+    MortonMatrix<double> mb = MortonMatrix<double>::from_dense(b);
+    report("multiply", best_seconds(repetitions, [&]() {
+        MortonMatrix<double> c = ma * mb;
+        checksum += c.at(size, size);
+    }), flops);
+    report("transpose", best_seconds(repetitions, [&]() {
+        MortonMatrix<double> t = ma.transpose();
+        checksum += t.at(size, 1);
+    }), 0);
+    report("conversion to dense", best_seconds(repetitions, [&]() {
+        Matrix<double> m = ma.to_dense();
+        checksum += m.at(size, size);
+    }), 0);
+
+    cout << "(checksum " << setprecision(0) << checksum << ")" << endl;
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <cstdlib>
+#include "../src/Matrix.h"
+
+using namespace std;
+
+// STREAM-like memory bandwidth benchmark over matrix rows: copy, scale, add and triad kernels, run
+// for every NUMA placement of the operands. Usage: stream [size] [repetitions]
+
+const int SIZE = 4096;
+const int REPETITIONS = 10;
+
+template<class F>
+double best_seconds(int repetitions, F kernel) {
+    double best = 1e30;
+    for (int r = 0; r < repetitions; ++r) {
+        auto start = chrono::steady_clock::now();
+        kernel();
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        best = min(best, elapsed.count());
+    }
+    return best;
+}
+
+template<class F>
+void rows(Matrix<double>& m, F body) {
+    int cols = m.cols();
+    parallel_for(1, m.rows() + 1, Matrix<double>::row_grain(cols), [&](int from, int to) {
+        for (int i = from; i < to; ++i) {
+            body(i, cols);
+        }
+    });
+}
+
+void run(const string& name, const NumaPolicy& policy, int size, int repetitions) {
+    auto start = chrono::steady_clock::now();
+    Matrix<double> a = Matrix<double>::zeros(size, size, policy);
+    Matrix<double> b = Matrix<double>::zeros(size, size, policy);
+    Matrix<double> c = Matrix<double>::zeros(size, size, policy);
+    rows(a, [&](int i, int cols) {
+        double* row = a.row_data(i);
+        for (int j = 0; j < cols; ++j) {
+            row[j] = 1.0;
+        }
+    });
+    chrono::duration<double> setup = chrono::steady_clock::now() - start;
+
+    double q = 3.0;
+    double bytes = static_cast<double>(size) * size * sizeof(double);
+    double copy = best_seconds(repetitions, [&]() {
+        rows(c, [&](int i, int cols) {
+            const double* x = a.row_data(i);
+            double* y = c.row_data(i);
+            for (int j = 0; j < cols; ++j) {
+                y[j] = x[j];
+            }
+        });
+    });
+    double scale = best_seconds(repetitions, [&]() {
+        rows(b, [&](int i, int cols) {
+            const double* x = c.row_data(i);
+            double* y = b.row_data(i);
+            for (int j = 0; j < cols; ++j) {
+                y[j] = q * x[j];
+            }
+        });
+    });
+    double add = best_seconds(repetitions, [&]() {
+        rows(c, [&](int i, int cols) {
+            const double* x = a.row_data(i);
+            const double* y = b.row_data(i);
+            double* z = c.row_data(i);
+            for (int j = 0; j < cols; ++j) {
+                z[j] = x[j] + y[j];
+            }
+        });
+    });
+    double triad = best_seconds(repetitions, [&]() {
+        rows(a, [&](int i, int cols) {
+            const double* x = b.row_data(i);
+            const double* y = c.row_data(i);
+            double* z = a.row_data(i);
+            for (int j = 0; j < cols; ++j) {
+                z[j] = x[j] + q * y[j];
+            }
+        });
+    });
+
+    cout << setw(12) << name << fixed << setprecision(1)
+         << setw(12) << 2 * bytes / copy / 1e9
+         << setw(12) << 2 * bytes / scale / 1e9
+         << setw(12) << 3 * bytes / add / 1e9
+         << setw(12) << 3 * bytes / triad / 1e9
+         << setw(12) << setprecision(3) << setup.count() << endl;
+}
+
+int main(int argc, char** argv) {
+    int size = argc > 1 ? atoi(argv[1]) : SIZE;
+    int repetitions = argc > 2 ? atoi(argv[2]) : REPETITIONS;
+
+    cout << size << "x" << size << " doubles, " << parallel_threads() << " threads, "
+         << numa_nodes() << " NUMA nodes, best of " << repetitions << endl;
+    cout << setw(12) << "placement" << setw(12) << "copy GB/s" << setw(12) << "scale GB/s"
+         << setw(12) << "add GB/s" << setw(12) << "triad GB/s" << setw(12) << "setup s" << endl;
+
+    run("default", NumaPolicy::default_placement(), size, repetitions);
+    run("first-touch", NumaPolicy::first_touch(), size, repetitions);
+    run("interleave", NumaPolicy::interleave(), size, repetitions);
+    for (int node = 0; node < numa_nodes(); ++node) {
+        run("bind " + to_string(node), NumaPolicy::bind(node), size, repetitions);
+    }
+    return 0;
+}
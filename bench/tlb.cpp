@@ -0,0 +1,140 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include "../src/Matrix.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Compares 4K and huge page backed matrices on page-hostile access: walking down columns (every access
+// touches a different page) and transpose. Data TLB misses are counted with perf_event_open when the kernel
+// allows it, otherwise only times are reported. Usage: tlb [size]
+
+const int SIZE = 4096;
+
+/**
+ * Counter of data TLB read misses of the calling thread, inactive if perf events are not available.
+ */
+class TlbCounter {
+public:
+
+    TlbCounter() : fd(-1) {
+#ifdef __linux__
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~TlbCounter() {
+#ifdef __linux__
+        if (fd >= 0) {
+            close(fd);
+        }
+#endif
+    }
+
+    bool available() const {
+        return fd >= 0;
+    }
+
+    void start() {
+#ifdef __linux__
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    long long stop() {
+        long long count = -1;
+#ifdef __linux__
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd, &count, sizeof(count)) != sizeof(count)) {
+                count = -1;
+            }
+        }
+#endif
+        return count;
+    }
+
+private:
+    int fd;
+};
+
+template<class F>
+void measure(const string& name, F work) {
+    TlbCounter counter;
+    auto start = chrono::steady_clock::now();
+    counter.start();
+    double checksum = work();
+    long long misses = counter.stop();
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+    cout << "  " << setw(16) << left << name << right << setw(10) << fixed << setprecision(1)
+         << elapsed.count() * 1000 << " ms";
+    if (misses >= 0) {
+        cout << setw(14) << misses << " dTLB misses";
+    } else {
+        cout << setw(14) << "n/a" << " dTLB misses";
+    }
+    cout << "   (checksum " << setprecision(0) << checksum << ")" << endl;
+}
+
+void run(const string& name, HugePages::Mode mode, int size) {
+    set_huge_pages(mode);
+    Matrix<double> m = Matrix<double>::natural(size, size);
+    cout << name << endl;
+
+    // single threaded, so that the counter of the calling thread sees all accesses
+    measure("column walk", [&]() {
+        double sum = 0;
+        for (int j = 0; j < size; ++j) {
+            for (int i = 1; i <= size; ++i) {
+                sum += m.row_data(i)[j];
+            }
+        }
+        return sum;
+    });
+
+    int previous = parallel_threads();
+    set_parallel_threads(1);
+    measure("transpose", [&]() {
+        Matrix<double> t = m.transpose();
+        return t.at(size, 1);
+    });
+    set_parallel_threads(previous);
+}
+
+int main(int argc, char** argv) {
+    int size = argc > 1 ? atoi(argv[1]) : SIZE;
+
+    cout << size << "x" << size << " doubles" << endl;
+    if (!TlbCounter().available()) {
+        cout << "perf events not available, reporting times only" << endl;
+    }
+
+    run("4K pages", HugePages::NONE, size);
+    run("transparent huge pages", HugePages::TRANSPARENT, size);
+    run("explicit huge pages", HugePages::EXPLICIT, size);
+    set_huge_pages(HugePages::TRANSPARENT);
+    return 0;
+}
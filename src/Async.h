@@ -0,0 +1,238 @@
+#ifndef _ASYNC_H
+#define _ASYNC_H
+
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <vector>
+#include <utility>
+#include "Matrix.h"
+#include "Parallel.h"
+
+/**
+ * Shared state between an asynchronous operation and its futures: the result or the exception,
+ * and continuations waiting for it.
+ */
+template<class R>
+class AsyncState {
+public:
+
+    AsyncState() : done(false) {}
+
+    bool ready() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return done;
+    }
+
+    void set_value(R&& result) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            value.reset(new R(std::move(result)));
+        }
+        finish();
+    }
+
+    void set_error(std::exception_ptr exception) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            error = exception;
+        }
+        finish();
+    }
+
+    /**
+     * Runs job and stores its result or exception.
+     */
+    template<class F>
+    void run(F& job) {
+        try {
+            set_value(job());
+        } catch (...) {
+            set_error(std::current_exception());
+        }
+    }
+
+    /**
+     * Schedules callback on the thread pool once the result is known, immediately if it already is.
+     */
+    void on_done(std::function<void()> callback) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!done) {
+                continuations.push_back(std::move(callback));
+                return;
+            }
+        }
+        parallel_submit(std::move(callback));
+    }
+
+    void wait() {
+        ParallelScheduler& scheduler = ParallelScheduler::instance();
+        if (scheduler.on_worker_thread()) {
+            // a blocked worker could starve the very task it waits for, so it keeps working instead
+            scheduler.help_until([this]() { return ready(); });
+        } else {
+            std::unique_lock<std::mutex> lock(mutex);
+            finished.wait(lock, [this]() { return done; });
+        }
+    }
+
+    const R& get() {
+        wait();
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return *value;
+    }
+
+    const std::exception_ptr& exception() const {
+        return error;
+    }
+
+    const R& result() const {
+        return *value;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable finished;
+    bool done;
+    std::unique_ptr<R> value;
+    std::exception_ptr error;
+    std::vector<std::function<void()> > continuations;
+
+    void finish() {
+        std::vector<std::function<void()> > waiting;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done = true;
+            waiting.swap(continuations);
+        }
+        finished.notify_all();
+        for (std::function<void()>& callback : waiting) {
+            parallel_submit(std::move(callback));
+        }
+    }
+};
+
+/**
+ * Result of an operation running on the library's thread pool. Copies share the same result.
+ */
+template<class R>
+class Future {
+public:
+
+    explicit Future(std::shared_ptr<AsyncState<R> > state) : state(std::move(state)) {}
+
+    /**
+     * Checks if the result (or exception) is already available, never blocks.
+     */
+    bool ready() const {
+        return state->ready();
+    }
+
+    /**
+     * Waits until the operation finishes. Called from a pool thread, executes other tasks meanwhile.
+     */
+    void wait() const {
+        state->wait();
+    }
+
+    /**
+     * Waits for the result and returns it, rethrows exception thrown by the operation.
+     * The reference stays valid as long as any copy of this future exists.
+     */
+    const R& get() const {
+        return state->get();
+    }
+
+    /**
+     * Chains continuation(result) to run on the pool once the result is available, without blocking
+     * any thread. If this operation fails, continuation is skipped and the exception is passed on.
+     * Continuation must return a value, which becomes the result of the returned future.
+     */
+    template<class F>
+    auto then(F continuation) const -> Future<decltype(continuation(std::declval<const R&>()))> {
+        typedef decltype(continuation(std::declval<const R&>())) U;
+        std::shared_ptr<AsyncState<R> > source = state;
+        std::shared_ptr<AsyncState<U> > next = std::make_shared<AsyncState<U> >();
+
+        source->on_done([source, next, continuation]() {
+            if (source->exception()) {
+                next->set_error(source->exception());
+                return;
+            }
+            auto job = [&]() { return continuation(source->result()); };
+            next->run(job);
+        });
+        return Future<U>(next);
+    }
+
+private:
+    std::shared_ptr<AsyncState<R> > state;
+};
+
+/**
+ * Runs job() on the library's thread pool and returns future of its result.
+ */
+template<class F>
+auto async_call(F job) -> Future<decltype(job())> {
+    typedef decltype(job()) R;
+    std::shared_ptr<AsyncState<R> > state = std::make_shared<AsyncState<R> >();
+    parallel_submit([state, job]() mutable {
+        state->run(job);
+    });
+    return Future<R>(state);
+}
+
+/**
+ * Multiplies matrices in background. Operands are copied, so they may be changed or destroyed
+ * right after the call.
+ */
+template<class T>
+Future<Matrix<T> > async_multiply(const Matrix<T>& a, const Matrix<T>& b) {
+    std::shared_ptr<Matrix<T> > first = std::make_shared<Matrix<T> >(a.clone());
+    std::shared_ptr<Matrix<T> > second = std::make_shared<Matrix<T> >(b.clone());
+    return async_call([first, second]() {
+        return (*first) * (*second);
+    });
+}
+
+/**
+ * Calculates inverse in background. Operand is copied.
+ */
+template<class T>
+Future<Matrix<T> > async_inverse(const Matrix<T>& a) {
+    std::shared_ptr<Matrix<T> > matrix = std::make_shared<Matrix<T> >(a.clone());
+    return async_call([matrix]() {
+        return matrix->inverse();
+    });
+}
+
+/**
+ * Calculates determinant in background. Operand is copied.
+ */
+template<class T>
+Future<T> async_det(const Matrix<T>& a) {
+    std::shared_ptr<Matrix<T> > matrix = std::make_shared<Matrix<T> >(a.clone());
+    return async_call([matrix]() {
+        return matrix->det();
+    });
+}
+
+/**
+ * Solves a system of linear equations Ax=B in background. Operands are copied.
+ */
+template<class T>
+Future<Matrix<T> > async_solve(const Matrix<T>& a, const Matrix<T>& b) {
+    std::shared_ptr<Matrix<T> > matrix = std::make_shared<Matrix<T> >(a.clone());
+    std::shared_ptr<Matrix<T> > rhs = std::make_shared<Matrix<T> >(b.clone());
+    return async_call([matrix, rhs]() {
+        // the task runs once, so the copies are handed over to solve
+        return Matrix<T>::solve(std::move(*matrix), std::move(*rhs));
+    });
+}
+
+#endif
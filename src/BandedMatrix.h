@@ -0,0 +1,276 @@
+#ifndef _BANDED_MATRIX_H
+#define _BANDED_MATRIX_H
+
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include "Matrix.h"
+#include "Vector.h"
+#include "Parallel.h"
+
+/**
+ * Square banded matrix with kl subdiagonals and ku superdiagonals, stored like in LAPACK: column by column,
+ * every column keeps kl + ku + 1 elements of the band (element (i, j) is at row ku + i - j of column j).
+ * Memory and all operations are O(n * bandwidth).
+ */
+template<class T>
+class BandedMatrix {
+public:
+
+    /**
+     * Creates NxN banded matrix filled with zeros.
+     */
+    static BandedMatrix<T> zeros(int size, int lower, int upper) {
+        if (!(size > 0 && lower >= 0 && upper >= 0)) {
+            throw std::runtime_error("Cannot create banded matrix with invalid dimensions");
+        }
+
+        return BandedMatrix<T>(size, std::min(lower, size - 1), std::min(upper, size - 1));
+    }
+
+    /**
+     * Creates banded matrix from the band of a square dense matrix, elements outside of it are ignored.
+     */
+    static BandedMatrix<T> from_dense(const Matrix<T>& dense, int lower, int upper) {
+        if (dense.rows() != dense.cols()) {
+            throw std::runtime_error("Cannot create banded matrix from non-square matrix");
+        }
+
+        BandedMatrix<T> result = zeros(dense.rows(), lower, upper);
+        for (int j = 1; j <= result._size; ++j) {
+            for (int i = result.first_row(j); i <= result.last_row(j); ++i) {
+                result.at(i, j) = dense.at(i, j);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Returns number of rows and columns.
+     */
+    int size() const {
+        return _size;
+    }
+
+    /**
+     * Returns number of subdiagonals.
+     */
+    int lower() const {
+        return _lower;
+    }
+
+    /**
+     * Returns number of superdiagonals.
+     */
+    int upper() const {
+        return _upper;
+    }
+
+    /**
+     * Gets element at the specific coordinates. Only elements inside of the band can be accessed.
+     */
+    T& at(int row, int col) {
+        return _data[offset(row, col)];
+    }
+
+    const T& at(int row, int col) const {
+        return _data[offset(row, col)];
+    }
+
+    /**
+     * Converts to a dense matrix.
+     */
+    Matrix<T> to_dense() const {
+        Matrix<T> result = Matrix<T>::zeros(_size, _size);
+        for (int j = 1; j <= _size; ++j) {
+            for (int i = first_row(j); i <= last_row(j); ++i) {
+                result.at(i, j) = at(i, j);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Banded matrix-vector product.
+     */
+    Vector<T> operator*(const Vector<T>& x) const {
+        if (x.size() != _size) {
+            throw std::runtime_error("Cannot multiply, invalid dimensions");
+        }
+
+        Vector<T> y = Vector<T>::zeros(_size);
+        const T* in = x.data();
+        T* out = y.data();
+        int ld = leading_dimension();
+        int grain = std::max(1, PARALLEL_THRESHOLD / ld);
+        parallel_for(0, _size, grain, [&](int from, int to) {
+            for (int i = from; i < to; ++i) {
+                // row i of the band runs diagonally through the columns, with stride ld - 1
+                int first = std::max(0, i - _lower), last = std::min(_size - 1, i + _upper);
+                const T* element = &_data[static_cast<size_t>(first) * ld + _upper + i - first];
+                T sum = 0;
+                for (int j = first; j <= last; ++j, element += ld - 1) {
+                    sum += *element * in[j];
+                }
+                out[i] = sum;
+            }
+        });
+        return y;
+    }
+
+    /**
+     * Solves tridiagonal system with the Thomas algorithm in O(n). No pivoting is done, so the matrix
+     * should be diagonally dominant or positive definite; throws on zero pivot.
+     */
+    Vector<T> solve_tridiagonal(const Vector<T>& b) const {
+        if (_lower > 1 || _upper > 1) {
+            throw std::runtime_error("Thomas algorithm requires a tridiagonal matrix");
+        }
+        if (b.size() != _size) {
+            throw std::runtime_error("Cannot solve, invalid dimensions");
+        }
+
+        std::vector<T> modified_upper(_size);
+        Vector<T> x = b;
+        T* d = x.data();
+
+        for (int i = 0; i < _size; ++i) {
+            T pivot = at(i + 1, i + 1);
+            if (i > 0 && _lower == 1) {
+                T below = at(i + 1, i);
+                pivot -= below * modified_upper[i - 1];
+                d[i] -= below * d[i - 1];
+            }
+            if (pivot == 0) {
+                throw std::runtime_error("Cannot solve, zero pivot in Thomas algorithm");
+            }
+            modified_upper[i] = (i + 1 < _size && _upper == 1) ? at(i + 1, i + 2) / pivot : 0;
+            d[i] /= pivot;
+        }
+
+        for (int i = _size - 2; i >= 0; --i) {
+            d[i] -= modified_upper[i] * d[i + 1];
+        }
+        return x;
+    }
+
+    /**
+     * Solves Ax=b with banded LU decomposition with partial pivoting, in O(n * kl * (kl + ku)).
+     */
+    Vector<T> solve(const Vector<T>& b) const {
+        return Vector<T>::from_matrix(solve(b.to_matrix()));
+    }
+
+    /**
+     * Solves AX=B with banded LU decomposition with partial pivoting. The factorization is shared
+     * by all columns of B.
+     */
+    Matrix<T> solve(const Matrix<T>& b) const {
+        if (b.rows() != _size) {
+            throw std::runtime_error("Cannot solve, invalid dimensions");
+        }
+
+        // LU with pivoting needs kl extra superdiagonals for the fill-in caused by row interchanges
+        int kv = _lower + _upper;
+        int ldw = 2 * _lower + _upper + 1;
+        std::vector<T> w(static_cast<size_t>(_size) * ldw, 0);
+        auto element = [&](int i, int j) -> T& {
+            return w[static_cast<size_t>(j) * ldw + kv + i - j];
+        };
+        for (int j = 0; j < _size; ++j) {
+            for (int i = first_row(j + 1) - 1; i < last_row(j + 1); ++i) {
+                element(i, j) = at(i + 1, j + 1);
+            }
+        }
+
+        std::vector<int> pivots(_size);
+        int last_column = 0;
+        for (int j = 0; j < _size; ++j) {
+            int below = std::min(_lower, _size - 1 - j);
+            int pivot = 0;
+            for (int r = 1; r <= below; ++r) {
+                if (std::abs(element(j + r, j)) > std::abs(element(j + pivot, j))) {
+                    pivot = r;
+                }
+            }
+            pivots[j] = j + pivot;
+            if (element(j + pivot, j) == 0) {
+                throw std::runtime_error("Cannot solve, singular matrix");
+            }
+
+            last_column = std::max(last_column, std::min(j + _upper + pivot, _size - 1));
+            if (pivot != 0) {
+                for (int c = j; c <= last_column; ++c) {
+                    std::swap(element(j, c), element(j + pivot, c));
+                }
+            }
+            for (int r = 1; r <= below; ++r) {
+                element(j + r, j) /= element(j, j);
+            }
+            for (int c = j + 1; c <= last_column; ++c) {
+                T top = element(j, c);
+                for (int r = 1; r <= below; ++r) {
+                    element(j + r, c) -= element(j + r, j) * top;
+                }
+            }
+        }
+
+        Matrix<T> x = b.clone();
+        int width = b.cols();
+        for (int j = 0; j < _size; ++j) {
+            if (pivots[j] != j) {
+                std::swap_ranges(x.row_data(j + 1), x.row_data(j + 1) + width, x.row_data(pivots[j] + 1));
+            }
+            for (int r = 1; r <= std::min(_lower, _size - 1 - j); ++r) {
+                Vector<T>::axpy_kernel(-element(j + r, j), x.row_data(j + 1), x.row_data(j + r + 1), width);
+            }
+        }
+        for (int i = _size - 1; i >= 0; --i) {
+            T* out = x.row_data(i + 1);
+            for (int c = i + 1; c <= std::min(_size - 1, i + kv); ++c) {
+                Vector<T>::axpy_kernel(-element(i, c), x.row_data(c + 1), out, width);
+            }
+            for (int k = 0; k < width; ++k) {
+                out[k] /= element(i, i);
+            }
+        }
+        return x;
+    }
+
+private:
+
+    // number of stored elements below which products stay on one thread
+    static const int PARALLEL_THRESHOLD = 1 << 16;
+
+    int _size, _lower, _upper;
+    std::vector<T> _data;
+
+    BandedMatrix(int size, int lower, int upper)
+            : _size(size), _lower(lower), _upper(upper),
+              _data(static_cast<size_t>(size) * (lower + upper + 1)) {}
+
+    int leading_dimension() const {
+        return _lower + _upper + 1;
+    }
+
+    int first_row(int col) const {
+        return std::max(1, col - _upper);
+    }
+
+    int last_row(int col) const {
+        return std::min(_size, col + _lower);
+    }
+
+    size_t offset(int row, int col) const {
+        if (row <= 0 || col <= 0 || row > _size || col > _size) {
+            throw std::runtime_error("Invalid element access");
+        }
+        if (row - col > _lower || col - row > _upper) {
+            throw std::runtime_error("Invalid element access, element is outside of the band");
+        }
+        return static_cast<size_t>(col - 1) * leading_dimension() + (_upper + row - col);
+    }
+};
+
+#endif
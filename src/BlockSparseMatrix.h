@@ -0,0 +1,280 @@
+#ifndef _BLOCK_SPARSE_MATRIX_H
+#define _BLOCK_SPARSE_MATRIX_H
+
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+#include "Matrix.h"
+#include "Vector.h"
+#include "Parallel.h"
+
+/**
+ * Sparse matrix in block sparse row (BSR) format. The matrix is divided into RxC tiles and only
+ * nonzero tiles are stored, every one of them as a contiguous row-major dense block. Tiles are organised
+ * like elements of a CSR matrix: block rows one after another, block columns sorted inside a block row.
+ * Element indices start at 1, block indices too, like in Matrix.
+ */
+template<class T>
+class BlockSparseMatrix {
+public:
+
+    /**
+     * Creates matrix made of block_rows x block_cols empty tiles, every tile has block_height x block_width
+     * elements.
+     */
+    static BlockSparseMatrix<T> zeros(int block_rows, int block_cols, int block_height, int block_width) {
+        if (!(block_rows > 0 && block_cols > 0 && block_height > 0 && block_width > 0)) {
+            throw std::runtime_error("Cannot create matrix with nonpositive dimensions");
+        }
+
+        return BlockSparseMatrix<T>(block_rows, block_cols, block_height, block_width);
+    }
+
+    /**
+     * Returns number of rows (in elements).
+     */
+    int rows() const {
+        return _block_rows * _block_height;
+    }
+
+    /**
+     * Returns number of columns (in elements).
+     */
+    int cols() const {
+        return _block_cols * _block_width;
+    }
+
+    int block_rows() const {
+        return _block_rows;
+    }
+
+    int block_cols() const {
+        return _block_cols;
+    }
+
+    int block_height() const {
+        return _block_height;
+    }
+
+    int block_width() const {
+        return _block_width;
+    }
+
+    /**
+     * Returns number of stored tiles.
+     */
+    int nonzero_blocks() const {
+        return static_cast<int>(_block_col_indices.size());
+    }
+
+    /**
+     * Pastes a dense tile at the specified block coordinates, replacing the existing one. Tiles are kept
+     * sorted: appending them in order of block rows (and columns inside a block row) takes amortized
+     * constant time, inserting a tile before stored ones moves all tiles after it.
+     */
+    void put(const Matrix<T>& block, int block_row, int block_col) {
+        T* tile = find_or_insert(block, block_row, block_col);
+        for (int i = 1; i <= _block_height; ++i) {
+            std::copy(block.row_data(i), block.row_data(i) + _block_width, tile + (i - 1) * _block_width);
+        }
+    }
+
+    /**
+     * Adds a dense tile to the one at the specified block coordinates, as done in finite element assembly.
+     */
+    void add(const Matrix<T>& block, int block_row, int block_col) {
+        T* tile = find_or_insert(block, block_row, block_col);
+        for (int i = 1; i <= _block_height; ++i) {
+            const T* source = block.row_data(i);
+            for (int j = 0; j < _block_width; ++j) {
+                tile[(i - 1) * _block_width + j] += source[j];
+            }
+        }
+    }
+
+    /**
+     * Returns copy of the tile at the specified block coordinates (zeros if it is not stored).
+     */
+    Matrix<T> block(int block_row, int block_col) const {
+        check_block(block_row, block_col);
+
+        Matrix<T> result = Matrix<T>::zeros(_block_height, _block_width);
+        int position = find(block_row - 1, block_col - 1);
+        if (position >= 0) {
+            const T* tile = &_values[position * tile_size()];
+            for (int i = 1; i <= _block_height; ++i) {
+                std::copy(tile + (i - 1) * _block_width, tile + i * _block_width, result.row_data(i));
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Gets value of element at the specific coordinates, zero if it is not stored.
+     */
+    T at(int row, int col) const {
+        if (row <= 0 || col <= 0 || row > rows() || col > cols()) {
+            throw std::runtime_error("Invalid element access");
+        }
+
+        int position = find((row - 1) / _block_height, (col - 1) / _block_width);
+        if (position < 0) {
+            return 0;
+        }
+        return _values[position * tile_size() + ((row - 1) % _block_height) * _block_width
+                       + (col - 1) % _block_width];
+    }
+
+    /**
+     * Converts to a dense matrix.
+     */
+    Matrix<T> to_dense() const {
+        Matrix<T> result = Matrix<T>::zeros(rows(), cols());
+        for (int bi = 0; bi < _block_rows; ++bi) {
+            for (int k = row_offset(bi); k < row_offset(bi + 1); ++k) {
+                result.put(block(bi + 1, _block_col_indices[k] + 1), bi * _block_height + 1,
+                           _block_col_indices[k] * _block_width + 1);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Block sparse matrix-vector product y = A * x, written into existing vector y.
+     */
+    void multiply(const Vector<T>& x, Vector<T>& y) const {
+        if (cols() != x.size() || rows() != y.size()) {
+            throw std::runtime_error("Cannot multiply, invalid dimensions");
+        }
+
+        const T* in = x.data();
+        T* out = y.data();
+        parallel_for(0, _block_rows, block_row_grain(1), [&](int from, int to) {
+            for (int bi = from; bi < to; ++bi) {
+                T* out_block = out + bi * _block_height;
+                std::fill(out_block, out_block + _block_height, T(0));
+                for (int k = row_offset(bi); k < row_offset(bi + 1); ++k) {
+                    const T* tile = &_values[k * tile_size()];
+                    const T* in_block = in + _block_col_indices[k] * _block_width;
+                    for (int i = 0; i < _block_height; ++i) {
+                        out_block[i] += Vector<T>::dot_kernel(tile + i * _block_width, in_block, _block_width);
+                    }
+                }
+            }
+        });
+    }
+
+    /**
+     * Block sparse matrix-vector product.
+     */
+    Vector<T> operator*(const Vector<T>& x) const {
+        Vector<T> y = Vector<T>::zeros(rows());
+        multiply(x, y);
+        return y;
+    }
+
+    /**
+     * Product of block sparse and dense matrix, the result is dense.
+     */
+    Matrix<T> operator*(const Matrix<T>& dense) const {
+        if (cols() != dense.rows()) {
+            throw std::runtime_error("Cannot multiply, invalid dimensions");
+        }
+
+        Matrix<T> result = Matrix<T>::zeros(rows(), dense.cols());
+        int width = dense.cols();
+        parallel_for(0, _block_rows, block_row_grain(width), [&](int from, int to) {
+            for (int bi = from; bi < to; ++bi) {
+                for (int k = row_offset(bi); k < row_offset(bi + 1); ++k) {
+                    const T* tile = &_values[k * tile_size()];
+                    int first_col = _block_col_indices[k] * _block_width;
+                    for (int i = 0; i < _block_height; ++i) {
+                        T* out = result.row_data(bi * _block_height + i + 1);
+                        for (int j = 0; j < _block_width; ++j) {
+                            Vector<T>::axpy_kernel(tile[i * _block_width + j], dense.row_data(first_col + j + 1),
+                                                   out, width);
+                        }
+                    }
+                }
+            }
+        });
+
+        return result;
+    }
+
+private:
+
+    // number of stored elements below which products stay on one thread
+    static const int PARALLEL_THRESHOLD = 1 << 15;
+
+    int _block_rows, _block_cols, _block_height, _block_width;
+    // offsets of block rows up to the last one holding tiles, later block rows are empty
+    std::vector<int> _row_offsets;
+    std::vector<int> _block_col_indices;
+    std::vector<T> _values;
+
+    BlockSparseMatrix(int block_rows, int block_cols, int block_height, int block_width)
+            : _block_rows(block_rows), _block_cols(block_cols), _block_height(block_height),
+              _block_width(block_width), _row_offsets(1, 0) {}
+
+    int tile_size() const {
+        return _block_height * _block_width;
+    }
+
+    /**
+     * Returns position of the first tile of block row (0-based), or the number of tiles past the last one.
+     */
+    int row_offset(int block_row) const {
+        return block_row < static_cast<int>(_row_offsets.size()) ? _row_offsets[block_row] : nonzero_blocks();
+    }
+
+    int block_row_grain(int width) const {
+        int per_block_row = std::max(1, static_cast<int>(_values.size()) * width / _block_rows);
+        return std::max(1, PARALLEL_THRESHOLD / per_block_row);
+    }
+
+    void check_block(int block_row, int block_col) const {
+        if (block_row <= 0 || block_col <= 0 || block_row > _block_rows || block_col > _block_cols) {
+            throw std::runtime_error("Invalid block position");
+        }
+    }
+
+    /**
+     * Returns position of tile (block_row, block_col) among stored tiles, or -1. Coordinates are 0-based.
+     */
+    int find(int block_row, int block_col) const {
+        auto first = _block_col_indices.begin() + row_offset(block_row);
+        auto last = _block_col_indices.begin() + row_offset(block_row + 1);
+        auto it = std::lower_bound(first, last, block_col);
+        return (it != last && *it == block_col) ? static_cast<int>(it - _block_col_indices.begin()) : -1;
+    }
+
+    T* find_or_insert(const Matrix<T>& block, int block_row, int block_col) {
+        check_block(block_row, block_col);
+        if (block.rows() != _block_height || block.cols() != _block_width) {
+            throw std::runtime_error("Invalid block dimensions");
+        }
+
+        int position = find(block_row - 1, block_col - 1);
+        if (position < 0) {
+            // block rows after the last stored one start at the end
+            if (block_row >= static_cast<int>(_row_offsets.size())) {
+                _row_offsets.resize(block_row + 1, nonzero_blocks());
+            }
+            auto first = _block_col_indices.begin() + _row_offsets[block_row - 1];
+            auto last = _block_col_indices.begin() + _row_offsets[block_row];
+            position = static_cast<int>(std::lower_bound(first, last, block_col - 1) - _block_col_indices.begin());
+
+            // inserting at the end, only the offset of the last block row changes
+            _block_col_indices.insert(_block_col_indices.begin() + position, block_col - 1);
+            _values.insert(_values.begin() + static_cast<size_t>(position) * tile_size(), tile_size(), T(0));
+            for (size_t bi = block_row; bi < _row_offsets.size(); ++bi) {
+                _row_offsets[bi]++;
+            }
+        }
+
+        return &_values[position * tile_size()];
+    }
+};
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef _CHECKSUM_H
+#define _CHECKSUM_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include "Parallel.h"
+
+/**
+ * Lookup tables of CRC-32 (polynomial 0xEDB88320, as in zip and PNG) for slicing-by-8: table[k][b] is the CRC
+ * of byte b followed by k zero bytes.
+ */
+struct Crc32Tables {
+
+    uint32_t table[8][256];
+
+    Crc32Tables() {
+        for (uint32_t b = 0; b < 256; ++b) {
+            uint32_t crc = b;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+            }
+            table[0][b] = crc;
+        }
+        for (uint32_t b = 0; b < 256; ++b) {
+            for (int k = 1; k < 8; ++k) {
+                table[k][b] = (table[k - 1][b] >> 8) ^ table[0][table[k - 1][b] & 0xFF];
+            }
+        }
+    }
+
+    static const Crc32Tables& instance() {
+        static Crc32Tables tables;
+        return tables;
+    }
+};
+
+/**
+ * Continues CRC-32 crc of previous data with length bytes at data; crc is 0 at the beginning.
+ */
+inline uint32_t crc32(const void* data, size_t length, uint32_t crc = 0) {
+    const uint32_t (*table)[256] = Crc32Tables::instance().table;
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+
+    // eight bytes per step, assembled byte by byte so it does not depend on alignment or byte order
+    while (length >= 8) {
+        uint32_t low = crc ^ (bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24));
+        uint32_t high = bytes[4] | (bytes[5] << 8) | (bytes[6] << 16) | (static_cast<uint32_t>(bytes[7]) << 24);
+        crc = table[7][low & 0xFF] ^ table[6][(low >> 8) & 0xFF] ^ table[5][(low >> 16) & 0xFF] ^
+              table[4][low >> 24] ^ table[3][high & 0xFF] ^ table[2][(high >> 8) & 0xFF] ^
+              table[1][(high >> 16) & 0xFF] ^ table[0][high >> 24];
+        bytes += 8;
+        length -= 8;
+    }
+    while (length-- > 0) {
+        crc = (crc >> 8) ^ table[0][(crc ^ *bytes++) & 0xFF];
+    }
+    return ~crc;
+}
+
+/**
+ * Multiplies 32x32 matrix over GF(2) (given by columns) by vector.
+ */
+inline uint32_t crc32_gf2_times(const uint32_t* matrix, uint32_t vector) {
+    uint32_t sum = 0;
+    for (int i = 0; vector != 0; ++i, vector >>= 1) {
+        if (vector & 1) {
+            sum ^= matrix[i];
+        }
+    }
+    return sum;
+}
+
+inline void crc32_gf2_square(uint32_t* square, const uint32_t* matrix) {
+    for (int i = 0; i < 32; ++i) {
+        square[i] = crc32_gf2_times(matrix, matrix[i]);
+    }
+}
+
+/**
+ * Returns CRC-32 of concatenation of two blocks given their CRCs and length of the second one.
+ * Shifts first through length2 zero bytes by repeated squaring of the one-bit shift operator.
+ */
+inline uint32_t crc32_combine(uint32_t crc1, uint32_t crc2, size_t length2) {
+    if (length2 == 0) {
+        return crc1;
+    }
+
+    uint32_t even[32], odd[32];
+    odd[0] = 0xEDB88320u;
+    uint32_t row = 1;
+    for (int i = 1; i < 32; ++i) {
+        odd[i] = row;
+        row <<= 1;
+    }
+    crc32_gf2_square(even, odd); // two zero bits
+    crc32_gf2_square(odd, even); // four zero bits
+
+    // first squaring gives operator for one zero byte
+    do {
+        crc32_gf2_square(even, odd);
+        if (length2 & 1) {
+            crc1 = crc32_gf2_times(even, crc1);
+        }
+        length2 >>= 1;
+        if (length2 == 0) {
+            break;
+        }
+
+        crc32_gf2_square(odd, even);
+        if (length2 & 1) {
+            crc1 = crc32_gf2_times(odd, crc1);
+        }
+        length2 >>= 1;
+    } while (length2 != 0);
+
+    return crc1 ^ crc2;
+}
+
+// bytes checksummed by one task of crc32_parallel
+const size_t CRC32_CHUNK = 1 << 20;
+
+/**
+ * Computes CRC-32 of large blocks in parallel: chunks are checksummed independently, then combined.
+ */
+inline uint32_t crc32_parallel(const void* data, size_t length) {
+    if (length <= CRC32_CHUNK) {
+        return crc32(data, length);
+    }
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    int chunks = static_cast<int>((length + CRC32_CHUNK - 1) / CRC32_CHUNK);
+    std::vector<uint32_t> crcs(chunks);
+    parallel_for(0, chunks, 1, [&](int from, int to) {
+        for (int c = from; c < to; ++c) {
+            size_t start = static_cast<size_t>(c) * CRC32_CHUNK;
+            crcs[c] = crc32(bytes + start, std::min(CRC32_CHUNK, length - start));
+        }
+    });
+
+    uint32_t crc = crcs[0];
+    for (int c = 1; c < chunks; ++c) {
+        size_t start = static_cast<size_t>(c) * CRC32_CHUNK;
+        crc = crc32_combine(crc, crcs[c], std::min(CRC32_CHUNK, length - start));
+    }
+    return crc;
+}
+
+#endif
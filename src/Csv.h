@@ -0,0 +1,311 @@
+#ifndef _CSV_H
+#define _CSV_H
+
+#include <stdexcept>
+#include <string>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include "Matrix.h"
+#include "Parallel.h"
+#include "FileMapping.h"
+#include "Text.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * Dialect of delimited text files: delimiter (',' for CSV, '\t' for TSV), whether the first line holds
+ * names of the columns, and tokens read as NaN, which mark missing values.
+ */
+struct CsvFormat {
+    char delimiter;
+    bool header;
+    std::vector<std::string> nan_tokens;
+
+    CsvFormat(char delimiter = ',', bool header = false)
+            : delimiter(delimiter), header(header), nan_tokens({"", "NA", "N/A", "NaN", "nan", "null"}) {}
+
+    static CsvFormat tsv(bool header = false) {
+        return CsvFormat('\t', header);
+    }
+};
+
+inline const char* csv_trim(const char* from, const char* to) {
+    while (to > from && (to[-1] == ' ' || to[-1] == '\t' || to[-1] == '\r')) {
+        --to;
+    }
+    return to;
+}
+
+/**
+ * Returns offset of the first line, after UTF-8 byte order mark if there is one.
+ */
+inline size_t csv_start(const char* bytes, size_t length) {
+    return length >= 3 && std::memcmp(bytes, "\xEF\xBB\xBF", 3) == 0 ? 3 : 0;
+}
+
+/**
+ * Splits line into fields, removing quotes (doubled quotes inside quoted fields stand for one).
+ */
+inline std::vector<std::string> csv_fields(const char* line, const char* end, char delimiter) {
+    std::vector<std::string> fields(1);
+    bool quoted = false;
+    for (const char* p = line; p < end; ++p) {
+        if (quoted) {
+            if (*p == '"' && p + 1 < end && p[1] == '"') {
+                fields.back() += '"';
+                ++p;
+            } else if (*p == '"') {
+                quoted = false;
+            } else {
+                fields.back() += *p;
+            }
+        } else if (*p == '"') {
+            quoted = true;
+        } else if (*p == delimiter) {
+            fields.push_back(std::string());
+        } else if (*p != '\r') {
+            fields.back() += *p;
+        }
+    }
+    return fields;
+}
+
+/**
+ * Parses field holding a floating point value.
+ */
+template<class T>
+bool csv_value(const char* from, const char* to, T& value, std::true_type) {
+    double real;
+    if (!text_real(from, to, real) || from != to) {
+        return false;
+    }
+    value = static_cast<T>(real);
+    return true;
+}
+
+/**
+ * Parses field holding an integer value, which must fit T.
+ */
+template<class T>
+bool csv_value(const char* from, const char* to, T& value, std::false_type) {
+    long long integer;
+    if (!text_integer(from, to, integer) || from != to ||
+        (std::is_signed<T>::value && integer < static_cast<long long>(std::numeric_limits<T>::min())) ||
+        (!std::is_signed<T>::value && integer < 0) ||
+        static_cast<unsigned long long>(std::max(integer, 0LL)) >
+        static_cast<unsigned long long>(std::numeric_limits<T>::max())) {
+        return false;
+    }
+    value = static_cast<T>(integer);
+    return true;
+}
+
+/**
+ * Parses all fields of a line into row of cols elements; row is the number of the row in the matrix,
+ * used in errors.
+ */
+template<class T>
+void csv_row(const char* line, const char* end, const CsvFormat& format, T* values, int cols, int row) {
+    const char* field = line;
+    for (int j = 0; j < cols; ++j) {
+        if (field == nullptr) {
+            throw std::runtime_error("Cannot load csv: row " + std::to_string(row) + " has fewer than " +
+                                     std::to_string(cols) + " values");
+        }
+        const char* next = static_cast<const char*>(std::memchr(field, format.delimiter, end - field));
+        const char* from = text_blank(field, next != nullptr ? next : end);
+        const char* to = csv_trim(from, next != nullptr ? next : end);
+        if (to - from >= 2 && *from == '"' && to[-1] == '"') {
+            ++from;
+            --to;
+        }
+        if (!csv_value(from, to, values[j], std::is_floating_point<T>())) {
+            std::string token(from, to);
+            if (std::find(format.nan_tokens.begin(), format.nan_tokens.end(), token) == format.nan_tokens.end()) {
+                throw std::runtime_error("Cannot load csv: invalid value '" + token + "' in row " +
+                                         std::to_string(row));
+            }
+            if (!std::numeric_limits<T>::has_quiet_NaN) {
+                throw std::runtime_error("Cannot load csv: missing value in row " + std::to_string(row));
+            }
+            values[j] = std::numeric_limits<T>::quiet_NaN();
+        }
+        field = next != nullptr ? next + 1 : nullptr;
+    }
+    if (field != nullptr) {
+        throw std::runtime_error("Cannot load csv: row " + std::to_string(row) + " has more than " +
+                                 std::to_string(cols) + " values");
+    }
+}
+
+inline bool csv_blank(const char* line, const char* end) {
+    return text_blank(line, end) == end;
+}
+
+/**
+ * Reads names of the columns from the first line of the file.
+ */
+inline std::vector<std::string> read_csv_header(const std::string& path, const CsvFormat& format = CsvFormat()) {
+    FileMapping file(path);
+    const char* start = file.bytes() + csv_start(file.bytes(), file.length);
+    return csv_fields(start, text_line_end(start, file.bytes() + file.length), format.delimiter);
+}
+
+/**
+ * Loads matrix from delimited text file, one row per line; blank lines are skipped and the first line
+ * is skipped when the format has a header. Values may be quoted, tokens of the format are read as NaN.
+ *
+ * The file is mapped and split into ranges of whole lines. Rows are counted in parallel first, so the
+ * matrix is allocated once, then every range is parsed in parallel straight into its rows.
+ */
+template<class T>
+Matrix<T> load_csv(const std::string& path, const CsvFormat& format = CsvFormat()) {
+    static_assert(std::is_arithmetic<T>::value, "CSV requires arithmetic element type");
+
+    FileMapping file(path);
+    file.sequential();
+    const char* bytes = file.bytes();
+    const char* end = bytes + file.length;
+    size_t begin = csv_start(bytes, file.length);
+    if (format.header) {
+        const char* first = text_line_end(bytes + begin, end);
+        begin = first < end ? first - bytes + 1 : file.length;
+    }
+
+    std::vector<size_t> bounds = text_chunks(bytes, begin, file.length);
+    int chunks = static_cast<int>(bounds.size()) - 1;
+    std::vector<int> offsets(chunks + 1, 0);
+    parallel_for(0, chunks, 1, [&](int from, int to) {
+        for (int c = from; c < to; ++c) {
+            const char* line = bytes + bounds[c];
+            const char* last = bytes + bounds[c + 1];
+            while (line < last) {
+                const char* next = text_line_end(line, last);
+                offsets[c + 1] += !csv_blank(line, next);
+                line = next < last ? next + 1 : last;
+            }
+        }
+    });
+    for (int c = 0; c < chunks; ++c) {
+        if (offsets[c + 1] > INT32_MAX - offsets[c]) {
+            throw std::runtime_error("Cannot load csv: too many rows");
+        }
+        offsets[c + 1] += offsets[c];
+    }
+    if (offsets[chunks] == 0) {
+        throw std::runtime_error("Cannot load csv: file has no rows");
+    }
+
+    // columns of the first row
+    const char* line = bytes + begin;
+    const char* next = text_line_end(line, end);
+    while (csv_blank(line, next)) {
+        line = next + 1;
+        next = text_line_end(line, end);
+    }
+    int cols = 1;
+    for (const char* p = line; (p = static_cast<const char*>(std::memchr(p, format.delimiter, next - p))) != nullptr;
+         ++p) {
+        ++cols;
+    }
+
+    Matrix<T> result = Matrix<T>::zeros(offsets[chunks], cols);
+    parallel_for(0, chunks, 1, [&](int from, int to) {
+        for (int c = from; c < to; ++c) {
+            const char* line = bytes + bounds[c];
+            const char* last = bytes + bounds[c + 1];
+            int row = offsets[c] + 1;
+            while (line < last) {
+                const char* next = text_line_end(line, last);
+                if (!csv_blank(line, next)) {
+                    csv_row(line, next, format, result.row_data(row), cols, row);
+                    ++row;
+                }
+                line = next < last ? next + 1 : last;
+            }
+        }
+    });
+    return result;
+}
+
+/**
+ * Returns field quoted if it holds the delimiter, quotes or line breaks.
+ */
+inline std::string csv_quote(const std::string& field, char delimiter) {
+    if (field.find_first_of(std::string(1, delimiter) + "\"\r\n") == std::string::npos) {
+        return field;
+    }
+    std::string quoted = "\"";
+    for (char c : field) {
+        quoted += c;
+        if (c == '"') {
+            quoted += '"';
+        }
+    }
+    return quoted + "\"";
+}
+
+/**
+ * Saves matrix to delimited text file, preceded by a line of column names when they are given.
+ * Floating point values are written with the shortest text read back exactly. Rows are formatted in
+ * parallel into large buffers, a batch at a time, written with plain write calls.
+ */
+template<class T, class Layout>
+void save_csv(const Matrix<T, Layout>& m, const std::string& path, const CsvFormat& format = CsvFormat(),
+              const std::vector<std::string>& names = std::vector<std::string>()) {
+    static_assert(std::is_arithmetic<T>::value, "CSV requires arithmetic element type");
+    if (!names.empty() && static_cast<int>(names.size()) != m.cols()) {
+        throw std::runtime_error("Cannot save csv: expected " + std::to_string(m.cols()) + " column names");
+    }
+
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create file " + path);
+    }
+    try {
+        if (!names.empty()) {
+            std::string header;
+            for (size_t j = 0; j < names.size(); ++j) {
+                header += (j > 0 ? std::string(1, format.delimiter) : std::string()) +
+                          csv_quote(names[j], format.delimiter);
+            }
+            text_write(fd, header + "\n", path);
+        }
+
+        int cols = m.cols(), batch = std::max(1, TEXT_BATCH / cols);
+        int pieces = parallel_threads() * 4;
+        std::vector<std::string> texts(pieces);
+        for (int first = 1; first <= m.rows(); first += batch) {
+            int last = std::min(m.rows(), first + batch - 1);
+            int size = (last - first + pieces) / pieces;
+            parallel_for(0, pieces, 1, [&](int from, int to) {
+                char buffer[TEXT_NUMBER];
+                for (int piece = from; piece < to; ++piece) {
+                    std::string& text = texts[piece];
+                    text.clear();
+                    for (int i = first + piece * size; i <= std::min(last, first + (piece + 1) * size - 1); ++i) {
+                        for (int j = 1; j <= cols; ++j) {
+                            text.append(buffer, text_format(buffer, m.at(i, j)));
+                            text += j < cols ? format.delimiter : '\n';
+                        }
+                    }
+                }
+            });
+            for (const std::string& text : texts) {
+                text_write(fd, text, path);
+            }
+        }
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    if (::close(fd) != 0) {
+        throw std::runtime_error("Cannot write file " + path);
+    }
+}
+
+#endif
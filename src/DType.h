@@ -0,0 +1,96 @@
+#ifndef _DTYPE_H
+#define _DTYPE_H
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Element types of matrices stored in files. Codes are part of file formats, never renumber them.
+ */
+struct DType {
+
+    enum Code {
+        UNKNOWN = 0, INT8 = 1, UINT8 = 2, INT16 = 3, UINT16 = 4, INT32 = 5, UINT32 = 6, INT64 = 7, UINT64 = 8,
+        FLOAT32 = 9, FLOAT64 = 10
+    };
+
+    /**
+     * Returns size of one element in bytes, 0 for UNKNOWN.
+     */
+    static size_t size(Code code) {
+        switch (code) {
+            case INT8:
+            case UINT8:
+                return 1;
+            case INT16:
+            case UINT16:
+                return 2;
+            case INT32:
+            case UINT32:
+            case FLOAT32:
+                return 4;
+            case INT64:
+            case UINT64:
+            case FLOAT64:
+                return 8;
+            default:
+                return 0;
+        }
+    }
+
+    static const char* name(Code code) {
+        switch (code) {
+            case INT8:
+                return "int8";
+            case UINT8:
+                return "uint8";
+            case INT16:
+                return "int16";
+            case UINT16:
+                return "uint16";
+            case INT32:
+                return "int32";
+            case UINT32:
+                return "uint32";
+            case INT64:
+                return "int64";
+            case UINT64:
+                return "uint64";
+            case FLOAT32:
+                return "float32";
+            case FLOAT64:
+                return "float64";
+            default:
+                return "unknown";
+        }
+    }
+};
+
+/**
+ * Maps C++ element type to its DType code, UNKNOWN for types that cannot be stored.
+ */
+template<class T>
+struct dtype_of {
+    static const DType::Code code = DType::UNKNOWN;
+};
+
+#define DTYPE_OF(type, value) \
+    template<> \
+    struct dtype_of<type> { \
+        static const DType::Code code = value; \
+    };
+
+DTYPE_OF(int8_t, DType::INT8)
+DTYPE_OF(uint8_t, DType::UINT8)
+DTYPE_OF(int16_t, DType::INT16)
+DTYPE_OF(uint16_t, DType::UINT16)
+DTYPE_OF(int32_t, DType::INT32)
+DTYPE_OF(uint32_t, DType::UINT32)
+DTYPE_OF(int64_t, DType::INT64)
+DTYPE_OF(uint64_t, DType::UINT64)
+DTYPE_OF(float, DType::FLOAT32)
+DTYPE_OF(double, DType::FLOAT64)
+
+#undef DTYPE_OF
+
+#endif
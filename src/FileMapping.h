@@ -0,0 +1,64 @@
+#ifndef _FILE_MAPPING_H
+#define _FILE_MAPPING_H
+
+#include <stdexcept>
+#include <string>
+#include <cstddef>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * Whole file mapped privately into memory, pages are read lazily by the kernel.
+ * Memory is writable, but changes stay in memory and never reach the file. Shared by matrices loaded
+ * from the file without copying, see load_npy.
+ */
+struct FileMapping {
+    void* base;
+    size_t length;
+
+    explicit FileMapping(const std::string& path) : base(nullptr), length(0) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open file " + path);
+        }
+        struct stat status;
+        if (fstat(fd, &status) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot read file " + path);
+        }
+
+        length = static_cast<size_t>(status.st_size);
+        if (length > 0) {
+            base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+        if (base == MAP_FAILED || length == 0) {
+            base = nullptr;
+            throw std::runtime_error("Cannot map file " + path);
+        }
+    }
+
+    FileMapping(const FileMapping&) = delete;
+
+    ~FileMapping() {
+        if (base != nullptr) {
+            munmap(base, length);
+        }
+    }
+
+    /**
+     * Hints the kernel that the file is going to be read from start to end, enabling aggressive read-ahead.
+     */
+    void sequential() const {
+        madvise(base, length, MADV_SEQUENTIAL);
+    }
+
+    const char* bytes() const {
+        return static_cast<const char*>(base);
+    }
+};
+
+#endif
@@ -0,0 +1,158 @@
+#ifndef _FORMAT_H
+#define _FORMAT_H
+
+#include <string>
+#include <sstream>
+#include <cstdio>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include "Parallel.h"
+#include "Text.h"
+
+// Formatting of matrices as text for Matrix::to_string, print and operator<<. Every element is right-aligned
+// to a width and followed by ", ", rows are put between "[" and "]" lines. Large matrices are summarized
+// like in NumPy: only a few rows and columns at each edge are shown, the rest is replaced with "...".
+
+/**
+ * Options of printing: matrices of more than threshold elements are summarized, showing edge rows and
+ * columns at each side; floating point elements get precision significant digits.
+ */
+struct FormatOptions {
+    int threshold;
+    int edge;
+    int precision;
+
+    FormatOptions(int threshold = 1000, int edge = 3, int precision = 6)
+            : threshold(threshold), edge(edge), precision(precision) {}
+};
+
+// minimum width of a formatted element
+const int FORMAT_WIDTH = 5;
+
+// how elements are formatted: like printf %g, as decimal integers, or by the stream operator (characters
+// are printed as characters, other types as they define it)
+template<class T>
+struct FormatKind {
+    static const int VALUE = std::is_floating_point<T>::value ? 0 :
+                             (std::is_integral<T>::value && !std::is_same<T, char>::value &&
+                              !std::is_same<T, signed char>::value && !std::is_same<T, unsigned char>::value) ? 1 : 2;
+};
+
+template<class T>
+void format_element(std::string& out, const T& value, int width, int precision, std::integral_constant<int, 0>) {
+    char buffer[TEXT_NUMBER];
+    int length = std::snprintf(buffer, sizeof(buffer), "%.*Lg", precision, static_cast<long double>(value));
+    length = std::min(length, static_cast<int>(sizeof(buffer)) - 1);
+    out.append(std::max(0, width - length), ' ');
+    out.append(buffer, length);
+}
+
+template<class T>
+void format_element(std::string& out, const T& value, int width, int, std::integral_constant<int, 1>) {
+    char buffer[TEXT_NUMBER];
+    int length = text_format(buffer, value);
+    out.append(std::max(0, width - length), ' ');
+    out.append(buffer, length);
+}
+
+template<class T>
+void format_element(std::string& out, const T& value, int width, int precision, std::integral_constant<int, 2>) {
+    std::ostringstream stream;
+    stream.precision(precision);
+    stream << value;
+    std::string text = stream.str();
+    out.append(std::max(0, width - static_cast<int>(text.size())), ' ');
+    out += text;
+}
+
+/**
+ * Appends value right-aligned to width, formatted the same as by std::ostream with given precision.
+ */
+template<class T>
+void format_element(std::string& out, const T& value, int width, int precision) {
+    format_element(out, value, width, precision, std::integral_constant<int, FormatKind<T>::VALUE>());
+}
+
+/**
+ * Returns indices (1-based) of rows or columns shown out of count, 0 stands for the ones left out.
+ */
+inline std::vector<int> format_shown(int count, bool summary, int edge) {
+    std::vector<int> shown;
+    if (!summary || count <= 2 * edge) {
+        for (int i = 1; i <= count; ++i) {
+            shown.push_back(i);
+        }
+        return shown;
+    }
+    for (int i = 1; i <= edge; ++i) {
+        shown.push_back(i);
+    }
+    shown.push_back(0);
+    for (int i = count - edge + 1; i <= count; ++i) {
+        shown.push_back(i);
+    }
+    return shown;
+}
+
+/**
+ * Formats rows x cols elements given by value(row, col), passing text to sink(const std::string&) in order,
+ * a batch of rows at a time. Rows of a batch are formatted in parallel, so the whole text is never held at
+ * once. Summaries get a width for every column, the widest of its shown elements.
+ */
+template<class F, class Sink>
+void format_matrix(int rows, int cols, F value, Sink sink, const FormatOptions& options, bool summarize) {
+    bool summary = summarize && static_cast<long long>(rows) * cols > options.threshold;
+    std::vector<int> shown_rows = format_shown(rows, summary, options.edge);
+    std::vector<int> shown_cols = format_shown(cols, summary, options.edge);
+
+    std::vector<int> widths(shown_cols.size(), FORMAT_WIDTH);
+    if (summary) {
+        std::string text;
+        for (int row : shown_rows) {
+            for (size_t k = 0; k < shown_cols.size(); ++k) {
+                if (row != 0 && shown_cols[k] != 0) {
+                    text.clear();
+                    format_element(text, value(row, shown_cols[k]), 0, options.precision);
+                    widths[k] = std::max(widths[k], static_cast<int>(text.size()));
+                }
+            }
+        }
+    }
+
+    sink(std::string("[\n"));
+    int count = static_cast<int>(shown_rows.size());
+    int batch = std::max(1, TEXT_BATCH / std::max(1, cols));
+    std::vector<std::string> lines;
+    for (int first = 0; first < count; first += batch) {
+        int last = std::min(count, first + batch);
+        lines.assign(last - first, std::string());
+        parallel_for(first, last, std::max(1, 4096 / std::max(1, cols)), [&](int from, int to) {
+            for (int r = from; r < to; ++r) {
+                std::string& line = lines[r - first];
+                if (shown_rows[r] == 0) {
+                    line = "  ...\n";
+                    continue;
+                }
+                for (size_t k = 0; k < shown_cols.size(); ++k) {
+                    if (shown_cols[k] == 0) {
+                        line += "  ..., ";
+                    } else {
+                        format_element(line, value(shown_rows[r], shown_cols[k]), widths[k], options.precision);
+                        line += ", ";
+                    }
+                }
+                line += '\n';
+            }
+        });
+
+        std::string text;
+        for (const std::string& line : lines) {
+            text += line;
+        }
+        sink(text);
+    }
+    sink(std::string("]\n"));
+}
+
+#endif
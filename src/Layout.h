@@ -0,0 +1,129 @@
+#ifndef _LAYOUT_H
+#define _LAYOUT_H
+
+#include <cstddef>
+#include "Storage.h"
+
+// Storage layouts of Matrix. A layout maps 0-based coordinates to an offset in storage, given dimensions
+// of the matrix and its stride. Storage is split into lines (rows, columns or rows of tiles) of equal length,
+// which is the unit of allocation and first touch initialization. contiguous() tells if a block of given
+// size starting at (row, col) occupies storage without gaps. CODE identifies the layout in file headers.
+
+/**
+ * Rows one after another, stride is the distance between starts of rows.
+ */
+struct RowMajor {
+
+    static const bool ROWS_CONTIGUOUS = true;
+    static const int CODE = 1;
+
+    template<class T>
+    static int default_stride(int, int cols) {
+        return default_pitch<T>(cols);
+    }
+
+    static int min_stride(int, int cols) {
+        return cols;
+    }
+
+    static int lines(int rows, int) {
+        return rows;
+    }
+
+    static size_t line_elements(int, int cols) {
+        return cols;
+    }
+
+    static size_t line_length(int, int, int stride) {
+        return stride;
+    }
+
+    static size_t offset(int row, int col, int, int, int stride) {
+        return static_cast<size_t>(row) * stride + col;
+    }
+
+    static bool contiguous(int rows, int cols, int stride, int, int) {
+        return rows == 1 || stride == cols;
+    }
+};
+
+/**
+ * Columns one after another, stride is the distance between starts of columns.
+ */
+struct ColumnMajor {
+
+    static const bool ROWS_CONTIGUOUS = false;
+    static const int CODE = 2;
+
+    template<class T>
+    static int default_stride(int rows, int) {
+        return default_pitch<T>(rows);
+    }
+
+    static int min_stride(int rows, int) {
+        return rows;
+    }
+
+    static int lines(int, int cols) {
+        return cols;
+    }
+
+    static size_t line_elements(int rows, int) {
+        return rows;
+    }
+
+    static size_t line_length(int, int, int stride) {
+        return stride;
+    }
+
+    static size_t offset(int row, int col, int, int, int stride) {
+        return static_cast<size_t>(col) * stride + row;
+    }
+
+    static bool contiguous(int rows, int cols, int stride, int, int) {
+        return cols == 1 || stride == rows;
+    }
+};
+
+/**
+ * Square SIZExSIZE tiles stored one after another, row by row of tiles, each tile row-major. Tiles at the
+ * bottom and right edges are padded to full size. Stride is the number of tiles in a row of tiles.
+ */
+template<int SIZE = 64>
+struct Tiled {
+
+    static const bool ROWS_CONTIGUOUS = false;
+    static const int CODE = 3 | (SIZE << 8);
+
+    template<class T>
+    static int default_stride(int rows, int cols) {
+        return min_stride(rows, cols);
+    }
+
+    static int min_stride(int, int cols) {
+        return (cols + SIZE - 1) / SIZE;
+    }
+
+    static int lines(int rows, int) {
+        return (rows + SIZE - 1) / SIZE;
+    }
+
+    static size_t line_elements(int, int cols) {
+        return static_cast<size_t>(cols) * SIZE;
+    }
+
+    static size_t line_length(int, int, int stride) {
+        return static_cast<size_t>(stride) * SIZE * SIZE;
+    }
+
+    static size_t offset(int row, int col, int, int, int stride) {
+        size_t tile = static_cast<size_t>(row / SIZE) * stride + col / SIZE;
+        return tile * SIZE * SIZE + (row % SIZE) * SIZE + col % SIZE;
+    }
+
+    static bool contiguous(int rows, int cols, int stride, int row, int col) {
+        return row % SIZE == 0 && col == 0 && rows % SIZE == 0 && stride * SIZE == cols;
+    }
+};
+
+#endif
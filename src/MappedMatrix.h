@@ -0,0 +1,296 @@
+#ifndef _MAPPED_MATRIX_H
+#define _MAPPED_MATRIX_H
+
+#include <stdexcept>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include "Matrix.h"
+#include "DType.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * Header at the start of a mapped matrix file. Elements start at data_offset, which is page aligned,
+ * and are stored exactly like in memory: native byte order, layout and stride as recorded.
+ */
+struct MappedHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t dtype;
+    uint32_t layout;
+    uint32_t reserved;
+    int64_t rows;
+    int64_t cols;
+    int64_t stride;
+    uint64_t data_offset;
+};
+
+const char MAPPED_MAGIC[8] = {'Z', 'B', 'P', 'M', 'A', 'P', '\0', '\0'};
+const uint32_t MAPPED_VERSION = 1;
+const size_t MAPPED_DATA_OFFSET = 4096;
+
+/**
+ * Matrix stored in a file mapped into memory (POSIX only). Opening only reads the header, elements
+ * are paged in lazily by the kernel when touched, so files may be much larger than memory.
+ * matrix() gives a regular Matrix over the mapping, usable with views, put and arithmetic operators.
+ *
+ * Writable mappings are shared with the file, sync() writes dirty pages back as a checkpoint.
+ * Read-only mappings are private: changes are allowed but stay in memory and never reach the file.
+ */
+template<class T, class Layout = RowMajor>
+class MappedMatrix {
+
+    static_assert(dtype_of<T>::code != DType::UNKNOWN, "MappedMatrix requires arithmetic element type");
+
+public:
+
+    /**
+     * Access patterns passed to the kernel as madvise hints.
+     */
+    enum Advice {
+        NORMAL, SEQUENTIAL, RANDOM, WILL_NEED, DONT_NEED
+    };
+
+    /**
+     * Creates (or truncates) file holding MxN matrix filled with zeros and maps it for writing.
+     * The file is sparse, so creating even a huge matrix is cheap.
+     */
+    static MappedMatrix create(const std::string& path, int rows, int cols) {
+        if (!(rows > 0 && cols > 0)) {
+            throw std::runtime_error("Cannot create matrix with nonpositive dimensions");
+        }
+
+        MappedHeader header;
+        std::memcpy(header.magic, MAPPED_MAGIC, sizeof(header.magic));
+        header.version = MAPPED_VERSION;
+        header.dtype = dtype_of<T>::code;
+        header.layout = Layout::CODE;
+        header.reserved = 0;
+        header.rows = rows;
+        header.cols = cols;
+        header.stride = Layout::template default_stride<T>(rows, cols);
+        header.data_offset = MAPPED_DATA_OFFSET;
+
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot create file " + path);
+        }
+        size_t length = header.data_offset + data_bytes(rows, cols, static_cast<int>(header.stride));
+        if (ftruncate(fd, static_cast<off_t>(length)) != 0 ||
+            pwrite(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+            ::close(fd);
+            throw std::runtime_error("Cannot write file " + path);
+        }
+
+        return MappedMatrix(path, fd, length, header, true);
+    }
+
+    /**
+     * Maps existing matrix file, checking that it holds elements of type T in this layout.
+     */
+    static MappedMatrix open(const std::string& path, bool writable = false) {
+        int fd = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open file " + path);
+        }
+
+        MappedHeader header;
+        try {
+            header = read_header(fd, path);
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+
+        size_t length = header.data_offset + data_bytes(static_cast<int>(header.rows),
+                                                        static_cast<int>(header.cols),
+                                                        static_cast<int>(header.stride));
+        return MappedMatrix(path, fd, length, header, writable);
+    }
+
+    /**
+     * Reads header of an open matrix file and checks it against T, Layout and size of the file.
+     */
+    static MappedHeader read_header(int fd, const std::string& path) {
+        MappedHeader header;
+        struct stat status;
+        if (fstat(fd, &status) != 0 ||
+            pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+            throw std::runtime_error("Cannot read matrix file " + path);
+        }
+
+        const char* problem = validate(header, static_cast<size_t>(status.st_size));
+        if (problem != nullptr) {
+            throw std::runtime_error(std::string("Cannot open matrix file ") + path + ": " + problem);
+        }
+        return header;
+    }
+
+    /**
+     * Returns matrix over the mapped elements.
+     */
+    Matrix<T, Layout>& matrix() {
+        return mapped;
+    }
+
+    const Matrix<T, Layout>& matrix() const {
+        return mapped;
+    }
+
+    int rows() const {
+        return mapped.rows();
+    }
+
+    int cols() const {
+        return mapped.cols();
+    }
+
+    const std::string& path() const {
+        return _path;
+    }
+
+    bool writable() const {
+        return _writable;
+    }
+
+    T& at(int row, int col) const {
+        return mapped.at(row, col);
+    }
+
+    Matrix<T, Layout> view(int from_row, int from_col, int to_row, int to_col) {
+        return mapped.view(from_row, from_col, to_row, to_col);
+    }
+
+    void put(const Matrix<T, Layout>& source, int row, int col) {
+        mapped.put(source, row, col);
+    }
+
+    /**
+     * Tells the kernel how the elements are going to be accessed, which drives read-ahead and eviction.
+     */
+    void advise(Advice advice) {
+        int flag = MADV_NORMAL;
+        switch (advice) {
+            case SEQUENTIAL:
+                flag = MADV_SEQUENTIAL;
+                break;
+            case RANDOM:
+                flag = MADV_RANDOM;
+                break;
+            case WILL_NEED:
+                flag = MADV_WILLNEED;
+                break;
+            case DONT_NEED:
+                flag = MADV_DONTNEED;
+                break;
+            default:
+                break;
+        }
+        if (madvise(base, length, flag) != 0) {
+            throw std::runtime_error("Cannot advise kernel about mapped matrix");
+        }
+    }
+
+    /**
+     * Writes modified pages back to the file. With wait, returns only when they are on the device,
+     * making the file a consistent checkpoint; otherwise just schedules the writes. No-op for read-only
+     * mappings.
+     */
+    void sync(bool wait = true) {
+        if (!_writable) {
+            return;
+        }
+        if (msync(base, length, wait ? MS_SYNC : MS_ASYNC) != 0) {
+            throw std::runtime_error("Cannot synchronize mapped matrix with " + _path);
+        }
+    }
+
+    MappedMatrix(MappedMatrix&& rvalue) : _path(std::move(rvalue._path)), _writable(rvalue._writable),
+                                          fd(rvalue.fd), base(rvalue.base), length(rvalue.length),
+                                          mapped(std::move(rvalue.mapped)) {
+        rvalue.fd = -1;
+        rvalue.base = nullptr;
+    }
+
+    MappedMatrix(const MappedMatrix&) = delete;
+
+    /**
+     * Unmaps the file; pages of writable mappings are written back by the kernel eventually,
+     * call sync() first to be sure they are on the device.
+     */
+    ~MappedMatrix() {
+        if (base != nullptr) {
+            munmap(base, length);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+private:
+    std::string _path;
+    bool _writable;
+    int fd;
+    void* base;
+    size_t length;
+    Matrix<T, Layout> mapped;
+
+    MappedMatrix(const std::string& path, int fd, size_t length, const MappedHeader& header, bool writable)
+            : _path(path), _writable(writable), fd(fd), base(map(fd, length, writable, path)), length(length),
+              mapped(Matrix<T, Layout>::wrap(reinterpret_cast<T*>(static_cast<char*>(base) + header.data_offset),
+                                             static_cast<int>(header.rows), static_cast<int>(header.cols),
+                                             static_cast<int>(header.stride))) {}
+
+    static void* map(int fd, size_t length, bool writable, const std::string& path) {
+        void* memory = mmap(nullptr, length, PROT_READ | PROT_WRITE, writable ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+        if (memory == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Cannot map file " + path);
+        }
+        return memory;
+    }
+
+    static size_t data_bytes(int rows, int cols, int stride) {
+        return static_cast<size_t>(Layout::lines(rows, cols)) * Layout::line_length(rows, cols, stride) * sizeof(T);
+    }
+
+    /**
+     * Returns description of the problem with header of a file of given size, nullptr if there is none.
+     */
+    static const char* validate(const MappedHeader& header, size_t file_size) {
+        if (std::memcmp(header.magic, MAPPED_MAGIC, sizeof(header.magic)) != 0) {
+            return "not a matrix file";
+        }
+        if (header.version != MAPPED_VERSION) {
+            return "unsupported version";
+        }
+        if (header.dtype != static_cast<uint32_t>(dtype_of<T>::code)) {
+            return "element type does not match";
+        }
+        if (header.layout != static_cast<uint32_t>(Layout::CODE)) {
+            return "layout does not match";
+        }
+        if (header.rows <= 0 || header.cols <= 0 || header.rows > INT32_MAX || header.cols > INT32_MAX ||
+            header.stride > INT32_MAX || header.stride < Layout::min_stride(static_cast<int>(header.rows),
+                                                                          static_cast<int>(header.cols))) {
+            return "invalid dimensions";
+        }
+        if (header.data_offset < sizeof(MappedHeader) || header.data_offset % MAPPED_DATA_OFFSET != 0) {
+            return "invalid data offset";
+        }
+        // compared by division, as the size in a corrupt header may not fit size_t
+        int rows = static_cast<int>(header.rows), cols = static_cast<int>(header.cols);
+        size_t line = Layout::line_length(rows, cols, static_cast<int>(header.stride));
+        if (header.data_offset > file_size ||
+            static_cast<size_t>(Layout::lines(rows, cols)) > (file_size - header.data_offset) / sizeof(T) / line) {
+            return "file is truncated";
+        }
+        return nullptr;
+    }
+};
+
+#endif
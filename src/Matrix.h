@@ -6,9 +6,25 @@
 #include <sstream>
 #include <iomanip>
 #include <iostream>
-
-template<class T>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <functional>
+#include "Parallel.h"
+#include "Storage.h"
+#include "Layout.h"
+#include "Format.h"
+
+/**
+ * Dense MxN matrix. Layout decides the order of elements in storage, see Layout.h; operations work the same
+ * for all layouts, only row_data requires the default row-major one.
+ */
+template<class T, class Layout = RowMajor>
 class Matrix {
+
+    template<class, class> friend class Matrix;
+
 public:
 
     /**
@@ -39,33 +55,159 @@ public:
             if (row > _rows || col > _cols) {
                 throw std::runtime_error("Invalid element access");
             }
-            return _data[(row - 1) * _cols + (col - 1)];
+            return _data[Layout::offset(row - 1, col - 1, _rows, _cols, _stride)];
+        }
+    }
+
+    /**
+     * Returns pointer to the first element of the specified row (view-aware). Elements of a single row
+     * are contiguous in memory, which is what the dedicated kernels rely on.
+     */
+    T* row_data(int row) const {
+        static_assert(Layout::ROWS_CONTIGUOUS, "row_data requires a layout with contiguous rows");
+        if (row <= 0 || row > rows()) {
+            throw std::runtime_error("Invalid row access");
         }
+
+        return locate(row, 1);
+    }
+
+    /**
+     * Returns stride of the storage (view-aware): distance in elements between the starts of consecutive rows
+     * for row-major layout, columns for column-major one. It can be larger than the row (column) length,
+     * long rows are padded to keep them aligned.
+     */
+    int stride() const {
+        return parent != nullptr ? parent->stride() : _stride;
+    }
+
+    /**
+     * Checks if elements are stored in one contiguous block, in the order of the layout without gaps.
+     */
+    bool contiguous() const {
+        int row = 1, col = 1;
+        const Matrix* base = resolve(row, col);
+        return Layout::contiguous(rows(), cols(), base->_stride, row - 1, col - 1);
+    }
+
+    /**
+     * Returns number of rows processed as one chunk by parallel operations. First touch initialization
+     * uses the same partitioning.
+     */
+    static int row_grain(int cols) {
+        return std::max(1, PARALLEL_THRESHOLD / std::max(1, cols));
+    }
+
+    /**
+     * Returns copy of the matrix stored with another layout. Rows are converted in parallel.
+     */
+    template<class Other>
+    Matrix<T, Other> to_layout() const {
+        Matrix<T, Other> result = Matrix<T, Other>::zeros(rows(), cols());
+        int width = cols();
+        for_each_row([&](int i) {
+            for (int j = 1; j <= width; ++j) {
+                *result.locate(i, j) = *locate(i, j);
+            }
+        });
+        return result;
     }
 
     /**
      * Creates MxN matrix filled with zeros.
      */
-    static Matrix<T> zeros(int rows, int cols) {
+    static Matrix zeros(int rows, int cols) {
+        if (!(rows > 0 && cols > 0)) {
+            throw std::runtime_error("Cannot create matrix with nonpositive dimensions");
+        }
+
+        return Matrix(rows, cols, Layout::template default_stride<T>(rows, cols), numa_policy());
+    }
+
+    /**
+     * Creates MxN matrix filled with zeros, with storage placed on NUMA nodes according to policy
+     * instead of the global one.
+     */
+    static Matrix zeros(int rows, int cols, const NumaPolicy& policy) {
+        if (!(rows > 0 && cols > 0)) {
+            throw std::runtime_error("Cannot create matrix with nonpositive dimensions");
+        }
+
+        return Matrix(rows, cols, Layout::template default_stride<T>(rows, cols), policy);
+    }
+
+    /**
+     * Creates MxN matrix filled with zeros, with given stride of the storage.
+     */
+    static Matrix with_stride(int rows, int cols, int stride) {
         if (!(rows > 0 && cols > 0)) {
             throw std::runtime_error("Cannot create matrix with nonpositive dimensions");
         }
+        if (stride < Layout::min_stride(rows, cols)) {
+            throw std::runtime_error("Cannot create matrix with stride smaller than length of a row");
+        }
+
+        return Matrix(rows, cols, stride, numa_policy());
+    }
+
+    /**
+     * Creates MxN matrix over external storage, without copying. Stride defaults to the smallest
+     * valid one for the layout. The matrix does not own the storage, which must outlive it and all views;
+     * copies of the matrix are regular matrices with own storage.
+     */
+    static Matrix wrap(T* data, int rows, int cols, int stride = 0) {
+        Matrix wrapped = external(data, rows, cols, stride);
+        wrapped.owner = false;
+        return wrapped;
+    }
+
+    /**
+     * Creates MxN matrix taking ownership of external storage, without copying. The storage is released
+     * with deleter(data) when the matrix is destroyed.
+     */
+    static Matrix adopt(T* data, int rows, int cols, std::function<void(T*)> deleter) {
+        return adopt(data, rows, cols, 0, std::move(deleter));
+    }
+
+    /**
+     * Creates MxN matrix with given stride taking ownership of external storage, see adopt above.
+     */
+    static Matrix adopt(T* data, int rows, int cols, int stride, std::function<void(T*)> deleter) {
+        if (!deleter) {
+            throw std::runtime_error("Cannot adopt storage without deleter");
+        }
+
+        Matrix adopted = external(data, rows, cols, stride);
+        adopted.deleter = std::move(deleter);
+        return adopted;
+    }
+
+    /**
+     * Checks if the matrix is a view of another one.
+     */
+    bool is_view() const {
+        return parent != nullptr;
+    }
 
-        return Matrix<T>(rows, cols);
+    /**
+     * Checks if the storage is owned by the matrix (allocated by it or adopted). Views own nothing.
+     */
+    bool owns_storage() const {
+        return parent == nullptr && owner;
     }
 
     /**
      * Creates MxM matrix filled with zeros.
      */
-    static Matrix<T> zeros(int size) {
+    static Matrix zeros(int size) {
         return zeros(size, size);
     }
 
     /**
      * Creates MxM identity matrix (1-s on diagonal and 0-s elsewhere)
      */
-    static Matrix<int> eye(int size) {
-        Matrix<T> identity = zeros(size);
+    static Matrix eye(int size) {
+        Matrix identity = zeros(size);
         for (int i = 1; i <= size; ++i) {
             identity.at(i, i) = 1;
         }
@@ -76,40 +218,41 @@ public:
      * Creates MxN matrix filled with natural numbers increasing.
      * Used mainly for testing and visualisation.
      */
-    static Matrix<int> natural(int rows, int cols) {
-        Matrix<T> nat = zeros(rows, cols);
+    static Matrix natural(int rows, int cols) {
+        Matrix nat = zeros(rows, cols);
 
-        for (int i = 1; i <= nat.rows(); ++i) {
-            for (int j = 1; j <= nat.cols(); ++j) {
-                nat.at(i, j) = j + (i - 1) * nat.cols();
+        nat.for_each_row([&](int i) {
+            for (int j = 1; j <= cols; ++j) {
+                *nat.locate(i, j) = j + (i - 1) * cols;
             }
-        }
+        });
         return nat;
     }
 
     /**
      * Clones matrix and copies all internal data structures to a new matrix.
      */
-    Matrix<T> clone() const {
-        Matrix<T> cloned = zeros(rows(), cols());
-        for (int i = 1; i <= rows(); ++i) {
-            for (int j = 1; j <= cols(); ++j) {
-                cloned.at(i, j) = at(i, j);
-            }
-        }
+    Matrix clone() const {
+        Matrix cloned = zeros(rows(), cols());
+        cloned.zip_rows(*this, [](T& target, const T& source) {
+            target = source;
+        });
         return cloned;
     }
 
     /**
      * Returns transposed matrix, that is, matrix with every element (i,j) moved to (j,i).
      */
-    Matrix<T> transpose() const {
-        Matrix<T> transposed = zeros(cols(), rows());
-        for (int i = 1; i <= rows(); ++i) {
-            for (int j = 1; j <= cols(); ++j) {
-                transposed.at(j, i) = at(i, j);
+    Matrix transpose() const {
+        Matrix transposed = zeros(cols(), rows());
+        // every thread fills a band of rows of the result, reading the same band of columns of the source
+        transposed.for_each_row_range([&](int from, int to) {
+            for (int i = 1; i <= rows(); ++i) {
+                for (int j = from; j < to; ++j) {
+                    *transposed.locate(j, i) = *locate(i, j);
+                }
             }
-        }
+        });
 
         return transposed;
     }
@@ -120,7 +263,7 @@ public:
      * Destructing view will not do any harm to base matrix.
      * If unsure, clone the result to avoid confusion.
      */
-    Matrix<T> view(int from_row, int from_col, int to_row, int to_col) {
+    Matrix view(int from_row, int from_col, int to_row, int to_col) {
         bool min_check = from_row >= 1 && to_row >= 1 && from_col >= 1 && to_col >= 1;
         bool max_check = from_row <= rows() && to_row <= rows() && from_col <= cols() && to_col <= cols();
         bool overlap_check = from_row <= to_row && from_col <= to_col;
@@ -157,7 +300,7 @@ public:
             throw std::runtime_error("Cannot concat matrices, nonmatching dimensions");
         }
 
-        Matrix<T> result = zeros(rows(), cols() + right.cols());
+        Matrix result = zeros(rows(), cols() + right.cols());
         result.put(*this, 1, 1);
         result.put(right, 1, cols() + 1);
 
@@ -172,7 +315,7 @@ public:
             throw std::runtime_error("Cannot concat matrices, nonmatching dimensions");
         }
 
-        Matrix<T> result = zeros(rows() + bottom.rows(), cols());
+        Matrix result = zeros(rows() + bottom.rows(), cols());
         result.put(*this, 1, 1);
         result.put(bottom, rows() + 1, 1);
 
@@ -182,16 +325,14 @@ public:
     /**
      * Adds matrices (mutating).
      */
-    Matrix<T>& operator+=(const Matrix& other) {
+    Matrix& operator+=(const Matrix& other) {
         if (!(other.rows() == rows() && other.cols() == cols())) {
             throw std::runtime_error("Incompatible dimensions");
         }
 
-        for (int i = 1; i <= rows(); ++i) {
-            for (int j = 1; j <= cols(); ++j) {
-                at(i, j) += other.at(i, j);
-            }
-        }
+        zip_rows(other, [](T& target, const T& source) {
+            target += source;
+        });
 
         return *this;
     }
@@ -199,8 +340,8 @@ public:
     /**
      * Adds matrices (non-mutating).
      */
-    Matrix<T> operator+(const Matrix& other) const {
-        Matrix<int> result = *this;
+    Matrix operator+(const Matrix& other) const {
+        Matrix result = *this;
         result += other;
         return result;
     }
@@ -208,12 +349,10 @@ public:
     /**
      * Multiplies matrices (mutating).
      */
-    Matrix<T>& operator*=(T factor) {
-        for (int i = 1; i <= rows(); ++i) {
-            for (int j = 1; j <= cols(); ++j) {
-                at(i, j) *= factor;
-            }
-        }
+    Matrix& operator*=(T factor) {
+        zip_rows(*this, [factor](T& target, const T&) {
+            target *= factor;
+        });
 
         return *this;
     }
@@ -221,8 +360,8 @@ public:
     /**
      * Multiplies matrices by a factor (non-mutating).
      */
-    Matrix<T> operator*(T factor) const {
-        Matrix<int> result = *this;
+    Matrix operator*(T factor) const {
+        Matrix result = *this;
         result *= factor;
         return result;
     }
@@ -230,14 +369,14 @@ public:
     /**
      * Subtracts matrices (non-mutating).
      */
-    Matrix<T> operator-(const Matrix& other) const {
+    Matrix operator-(const Matrix& other) const {
         return (*this + (other * (-1)));
     }
 
     /**
      * Subtracts matrices (mutating).
      */
-    Matrix<T>& operator-=(const Matrix& other) {
+    Matrix& operator-=(const Matrix& other) {
         *this += other * (-1);
         return *this;
     }
@@ -258,7 +397,7 @@ public:
             throw std::runtime_error("Cannot remove intersection from 1x1 matrix");
         }
 
-        Matrix<T> result = Matrix<T>::zeros(cols() - 1, rows() - 1);
+        Matrix result = Matrix::zeros(cols() - 1, rows() - 1);
         for (int i = 1; i <= rows() - 1; ++i) {
             for (int j = 1; j <= cols() - 1; ++j) {
                 result.at(i, j) = at(i >= row ? (i + 1) : i, j >= col ? (j + 1) : j);
@@ -271,12 +410,12 @@ public:
     /**
      * Matrix multiplication (non-mutating).
      */
-    Matrix<T> operator*(Matrix<T>& second) {
+    Matrix operator*(Matrix& second) {
         if (cols() != second.rows()) {
             throw std::runtime_error("Cannot multiply, invalid dimensions");
         }
 
-        Matrix<T> result = Matrix<T>::zeros(rows(), second.cols());
+        Matrix result = Matrix::zeros(rows(), second.cols());
 
         for (int i = 1; i <= result.rows(); ++i) {
             for (int j = 1; j <= result.cols(); ++j) {
@@ -309,16 +448,16 @@ public:
     /**
      * Calculates matrix inverse, if exists.
      */
-    Matrix<T> inverse() const {
+    Matrix inverse() const {
         T thisDet = det();
         if (thisDet == 0) {
             throw std::runtime_error("Cannot invert non-rectangular matrix");
         }
 
-        Matrix<T> inverted = zeros(rows(), cols());
+        Matrix inverted = zeros(rows(), cols());
 
         if (rows() == 1 && cols() == 1) {
-            Matrix<T> result = zeros(1, 1);
+            Matrix result = zeros(1, 1);
             result.at(1, 1) = 1.0 / at(1, 1);
             return result;
         }
@@ -335,7 +474,7 @@ public:
     /**
      * Solves a system of linear equations Ax=B.
      */
-    static Matrix<T> solve(Matrix<T> a, Matrix<T> b) {
+    static Matrix solve(Matrix a, Matrix b) {
         return a.inverse() * b;
     }
 
@@ -343,21 +482,28 @@ public:
         _data = rvalue._data;
         _rows = rvalue._rows;
         _cols = rvalue._cols;
+        _stride = rvalue._stride;
         parent = rvalue.parent;
+        from_row = rvalue.from_row;
+        from_col = rvalue.from_col;
+        to_row = rvalue.to_row;
+        to_col = rvalue.to_col;
+        owner = rvalue.owner;
+        deleter = std::move(rvalue.deleter);
         rvalue._data = nullptr;
     }
 
-    Matrix(const Matrix<T>& other) {
+    Matrix(const Matrix& other) {
         if (other.parent == nullptr) {
             parent = nullptr;
             _rows = other.rows();
             _cols = other.cols();
-            _data = new T[_rows * _cols];
-            for (int i = 1; i <= _rows; ++i) {
-                for (int j = 1; j <= _cols; ++j) {
-                    at(i, j) = other.at(i, j);
-                }
-            }
+            _stride = Layout::template default_stride<T>(_rows, _cols);
+            _data = allocate(_rows, _cols, _stride, numa_policy());
+            owner = true;
+            zip_rows(other, [](T& target, const T& source) {
+                target = source;
+            });
         } else {
             parent = other.parent;
             from_row = other.from_row;
@@ -367,38 +513,82 @@ public:
         }
     }
 
+    /**
+     * Releases owned storage, with the deleter for adopted one. Views and wrapped matrices do not own any.
+     */
+    ~Matrix() {
+        if (parent != nullptr || _data == nullptr || !owner) {
+            return;
+        }
+
+        if (deleter) {
+            deleter(_data);
+        } else {
+            release_storage(_data, storage_size(_rows, _cols, _stride));
+        }
+    }
+
     bool operator==(const Matrix& other) const {
         if (!(rows() == other.rows() && cols() == other.cols())) {
             return false;
         }
 
-        for (int i = 1; i <= rows(); ++i) {
-            for (int j = 1; j <= cols(); ++j) {
-                if (at(i, j) != other.at(i, j)) {
-                    return false;
+        // every chunk stops at its first mismatch, other chunks at the start of their next row
+        std::atomic<bool> equal(true);
+        int width = cols();
+        for_each_row_range([&](int from, int to) {
+            for (int i = from; i < to && equal.load(std::memory_order_relaxed); ++i) {
+                if (Layout::ROWS_CONTIGUOUS) {
+                    const T* row = locate(i, 1);
+                    if (!std::equal(row, row + width, other.locate(i, 1))) {
+                        equal.store(false, std::memory_order_relaxed);
+                        return;
+                    }
+                    continue;
+                }
+                for (int j = 1; j <= width; ++j) {
+                    if (*locate(i, j) != *other.locate(i, j)) {
+                        equal.store(false, std::memory_order_relaxed);
+                        return;
+                    }
                 }
             }
-        }
+        });
 
-        return true;
+        return equal.load();
     }
 
     bool operator!=(const Matrix& other) const {
         return !(*this == other);
     }
 
+    /**
+     * Returns all elements as text, every one right-aligned to at least 5 characters and followed by ", ",
+     * row by row. Rows are formatted in parallel.
+     */
     std::string to_string() const {
-        std::stringstream output;
-        output << "[\n";
-        for (int i = 1; i <= rows(); ++i) {
-            for (int j = 1; j <= cols(); ++j) {
-                output << std::setfill(' ') << std::setw(5) << at(i, j) << ", ";
-            }
-            output << "\n";
-        }
-        output << "]\n";
+        std::string output;
+        format_matrix(rows(), cols(), [this](int i, int j) -> const T& { return *locate(i, j); },
+                      [&output](const std::string& text) { output += text; }, FormatOptions(), false);
+        return output;
+    }
 
-        return output.str();
+    /**
+     * Writes the matrix to the stream like to_string, but summarized when it has more elements than
+     * the threshold of options. Text goes to the stream a batch of rows at a time.
+     */
+    void print(std::ostream& out, const FormatOptions& options = FormatOptions()) const {
+        format_matrix(rows(), cols(), [this](int i, int j) -> const T& { return *locate(i, j); },
+                      [&out](const std::string& text) { out.write(text.data(), text.size()); }, options, true);
+    }
+
+    /**
+     * Writes the matrix to the file descriptor, see print above.
+     */
+    void print(int fd, const FormatOptions& options = FormatOptions()) const {
+        format_matrix(rows(), cols(), [this](int i, int j) -> const T& { return *locate(i, j); },
+                      [fd](const std::string& text) { text_write(fd, text, "descriptor " + std::to_string(fd)); },
+                      options, true);
     }
 
     class matrix_iterator {
@@ -453,24 +643,126 @@ public:
 
 private:
 
+    // number of elements below which bulk operations stay on the calling thread
+    static const int PARALLEL_THRESHOLD = 1 << 15;
+
     // when not a view - real data structure with pointer to elements
-    int _rows, _cols;
+    int _rows, _cols, _stride;
     T* _data;
 
+    // whether the storage is released by the matrix, with deleter when set (adopted storage)
+    bool owner;
+    std::function<void(T*)> deleter;
+
     // when view
-    Matrix<T>* parent;
+    Matrix* parent;
     int from_row, from_col, to_row, to_col;
 
-    Matrix(int rows, int cols) : _rows(rows), _cols(cols), parent(nullptr), _data(new T[rows * cols]()) {}
+    Matrix(int rows, int cols, int stride, const NumaPolicy& policy)
+            : _rows(rows), _cols(cols), _stride(stride), _data(allocate(rows, cols, stride, policy)), owner(true),
+              parent(nullptr) {}
+
+    Matrix(T* data, int rows, int cols, int stride)
+            : _rows(rows), _cols(cols), _stride(stride), _data(data), owner(true), parent(nullptr) {}
+
+    static Matrix external(T* data, int rows, int cols, int stride) {
+        if (data == nullptr) {
+            throw std::runtime_error("Cannot create matrix over null storage");
+        }
+        if (!(rows > 0 && cols > 0)) {
+            throw std::runtime_error("Cannot create matrix with nonpositive dimensions");
+        }
+        if (stride == 0) {
+            stride = Layout::min_stride(rows, cols);
+        }
+        if (stride < Layout::min_stride(rows, cols)) {
+            throw std::runtime_error("Cannot create matrix with stride smaller than length of a row");
+        }
+
+        return Matrix(data, rows, cols, stride);
+    }
+
+    static T* allocate(int rows, int cols, int stride, const NumaPolicy& policy) {
+        int grain = static_cast<int>(std::max<size_t>(1, PARALLEL_THRESHOLD / Layout::line_elements(rows, cols)));
+        return allocate_storage<T>(Layout::lines(rows, cols), static_cast<int>(Layout::line_length(rows, cols, stride)),
+                                   grain, policy);
+    }
+
+    static size_t storage_size(int rows, int cols, int stride) {
+        return static_cast<size_t>(Layout::lines(rows, cols)) * Layout::line_length(rows, cols, stride);
+    }
+
+    /**
+     * Returns the matrix owning the storage and translates coordinates to it.
+     */
+    const Matrix* resolve(int& row, int& col) const {
+        const Matrix* base = this;
+        while (base->parent != nullptr) {
+            row += base->from_row - 1;
+            col += base->from_col - 1;
+            base = base->parent;
+        }
+        return base;
+    }
+
+    /**
+     * Returns pointer to element at the specific coordinates (view-aware), without bound checking.
+     */
+    T* locate(int row, int col) const {
+        const Matrix* base = resolve(row, col);
+        return base->_data + Layout::offset(row - 1, col - 1, base->_rows, base->_cols, base->_stride);
+    }
+
+    /**
+     * Calls body(element, other element) for all pairs of corresponding elements, row by row,
+     * in parallel for large matrices.
+     */
+    template<class F>
+    void zip_rows(const Matrix& other, F body) const {
+        int width = cols();
+        for_each_row([&](int i) {
+            if (Layout::ROWS_CONTIGUOUS) {
+                T* row = locate(i, 1);
+                T* second = other.locate(i, 1);
+                for (int j = 0; j < width; ++j) {
+                    body(row[j], second[j]);
+                }
+            } else {
+                for (int j = 1; j <= width; ++j) {
+                    body(*locate(i, j), *other.locate(i, j));
+                }
+            }
+        });
+    }
 
-    Matrix(Matrix<T>& parent, int from_row, int from_col, int to_row, int to_col)
-            : from_row(from_row), from_col(from_col), to_row(to_row), to_col(to_col), parent(&parent) {}
+    Matrix(Matrix& parent, int from_row, int from_col, int to_row, int to_col)
+            : owner(false), parent(&parent), from_row(from_row), from_col(from_col), to_row(to_row), to_col(to_col) {}
 
 
+    /**
+     * Calls body(from, to) for ranges of rows, in parallel for large matrices.
+     */
+    template<class F>
+    void for_each_row_range(F body) const {
+        parallel_for(1, rows() + 1, row_grain(cols()), body);
+    }
+
+    /**
+     * Calls body(row) for every row, in parallel for large matrices.
+     */
+    template<class F>
+    void for_each_row(F body) const {
+        for_each_row_range([&](int from, int to) {
+            for (int i = from; i < to; ++i) {
+                body(i);
+            }
+        });
+    }
+
     /**
      * Calculates dot product of two vectors (1xM / Mx1).
      */
-    T dot_product(const Matrix<T>& second) const {
+    T dot_product(const Matrix& second) const {
         matrix_iterator it_first = begin();
         matrix_iterator it_second = second.begin();
 
@@ -486,5 +778,13 @@ private:
     }
 };
 
+/**
+ * Prints the matrix, summarized when large, see Matrix::print.
+ */
+template<class T, class Layout>
+std::ostream& operator<<(std::ostream& out, const Matrix<T, Layout>& m) {
+    m.print(out);
+    return out;
+}
 
 #endif
@@ -0,0 +1,318 @@
+#ifndef _MATRIX_BATCH_H
+#define _MATRIX_BATCH_H
+
+#include <stdexcept>
+#include <vector>
+#include <atomic>
+#include <cmath>
+#include <type_traits>
+#include "Matrix.h"
+#include "Parallel.h"
+
+/**
+ * A batch of N matrices of the same shape stored in one contiguous buffer. Storage is interleaved:
+ * element (i, j) of all matrices is stored next to each other, so every batched kernel runs its
+ * innermost loop across the batch. Such loops have no dependencies between iterations and get
+ * vectorized, and the batch is split between threads in contiguous ranges of matrices.
+ */
+template<class T>
+class MatrixBatch {
+public:
+
+    /**
+     * Creates a batch of count MxN matrices filled with zeros.
+     */
+    static MatrixBatch<T> zeros(int count, int rows, int cols) {
+        if (!(count > 0 && rows > 0 && cols > 0)) {
+            throw std::runtime_error("Cannot create batch with nonpositive dimensions");
+        }
+
+        return MatrixBatch<T>(count, rows, cols);
+    }
+
+    /**
+     * Returns number of matrices in the batch.
+     */
+    int count() const {
+        return _count;
+    }
+
+    /**
+     * Returns number of rows of every matrix.
+     */
+    int rows() const {
+        return _rows;
+    }
+
+    /**
+     * Returns number of columns of every matrix.
+     */
+    int cols() const {
+        return _cols;
+    }
+
+    /**
+     * Gets element (row, col) of the index-th matrix. All indices start at 1.
+     */
+    T& at(int index, int row, int col) {
+        check_access(index, row, col);
+        return _data[offset(row - 1, col - 1) + (index - 1)];
+    }
+
+    const T& at(int index, int row, int col) const {
+        check_access(index, row, col);
+        return _data[offset(row - 1, col - 1) + (index - 1)];
+    }
+
+    /**
+     * Copies the index-th matrix out of the batch.
+     */
+    Matrix<T> get(int index) const {
+        Matrix<T> result = Matrix<T>::zeros(_rows, _cols);
+        for (int i = 1; i <= _rows; ++i) {
+            for (int j = 1; j <= _cols; ++j) {
+                result.at(i, j) = at(index, i, j);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Replaces the index-th matrix of the batch.
+     */
+    void set(int index, const Matrix<T>& source) {
+        if (source.rows() != _rows || source.cols() != _cols) {
+            throw std::runtime_error("Incompatible dimensions");
+        }
+
+        for (int i = 1; i <= _rows; ++i) {
+            for (int j = 1; j <= _cols; ++j) {
+                at(index, i, j) = source.at(i, j);
+            }
+        }
+    }
+
+    /**
+     * Multiplies matrices pairwise, C[k] = A[k] * B[k].
+     */
+    static MatrixBatch<T> gemm(const MatrixBatch<T>& a, const MatrixBatch<T>& b) {
+        if (a._count != b._count || a._cols != b._rows) {
+            throw std::runtime_error("Cannot multiply, invalid dimensions");
+        }
+
+        MatrixBatch<T> c(a._count, a._rows, b._cols);
+        parallel_for(0, a._count, BATCH_GRAIN, [&](int from, int to) {
+            for (int i = 0; i < a._rows; ++i) {
+                for (int k = 0; k < a._cols; ++k) {
+                    const T* left = &a._data[a.offset(i, k)];
+                    for (int j = 0; j < b._cols; ++j) {
+                        const T* right = &b._data[b.offset(k, j)];
+                        T* out = &c._data[c.offset(i, j)];
+                        for (int l = from; l < to; ++l) {
+                            out[l] += left[l] * right[l];
+                        }
+                    }
+                }
+            }
+        });
+
+        return c;
+    }
+
+    /**
+     * Calculates determinants of all matrices using LU decomposition with partial pivoting.
+     * Singular matrices give 0.
+     */
+    std::vector<T> det() const {
+        static_assert(std::is_floating_point<T>::value, "MatrixBatch det requires floating point element type");
+        if (_rows != _cols) {
+            throw std::runtime_error("Cannot calculate determinant of non-square matrix");
+        }
+
+        MatrixBatch<T> work = *this;
+        std::vector<T> result(_count, 1);
+        parallel_for(0, _count, BATCH_GRAIN, [&](int from, int to) {
+            std::vector<T> sign(to - from, 1);
+            work.eliminate(nullptr, from, to, sign.data());
+            for (int k = 0; k < _rows; ++k) {
+                const T* pivot = &work._data[work.offset(k, k)];
+                for (int l = from; l < to; ++l) {
+                    result[l] *= pivot[l];
+                }
+            }
+            for (int l = from; l < to; ++l) {
+                result[l] *= sign[l - from];
+            }
+        });
+
+        return result;
+    }
+
+    /**
+     * Calculates inverses of all matrices. Throws if any of them is singular.
+     */
+    MatrixBatch<T> inverse() const {
+        static_assert(std::is_floating_point<T>::value, "MatrixBatch inverse requires floating point element type");
+        if (_rows != _cols) {
+            throw std::runtime_error("Cannot invert non-square matrix");
+        }
+
+        MatrixBatch<T> identity(_count, _rows, _rows);
+        for (int i = 0; i < _rows; ++i) {
+            T* diagonal = &identity._data[identity.offset(i, i)];
+            for (int l = 0; l < _count; ++l) {
+                diagonal[l] = 1;
+            }
+        }
+        return solve(*this, identity);
+    }
+
+    /**
+     * Solves systems of linear equations A[k] * X[k] = B[k]. Throws if any A[k] is singular.
+     */
+    static MatrixBatch<T> solve(const MatrixBatch<T>& a, const MatrixBatch<T>& b) {
+        static_assert(std::is_floating_point<T>::value, "MatrixBatch solve requires floating point element type");
+        if (a._rows != a._cols || a._count != b._count || a._rows != b._rows) {
+            throw std::runtime_error("Cannot solve, invalid dimensions");
+        }
+
+        MatrixBatch<T> work = a;
+        MatrixBatch<T> x = b;
+        std::atomic<bool> singular(false);
+
+        parallel_for(0, a._count, BATCH_GRAIN, [&](int from, int to) {
+            if (!work.eliminate(&x, from, to, nullptr)) {
+                singular = true;
+                return;
+            }
+
+            // back substitution, U is stored in the upper triangle of work
+            int n = work._rows;
+            for (int i = n - 1; i >= 0; --i) {
+                const T* pivot = &work._data[work.offset(i, i)];
+                for (int j = 0; j < x._cols; ++j) {
+                    T* out = &x._data[x.offset(i, j)];
+                    for (int k = i + 1; k < n; ++k) {
+                        const T* u = &work._data[work.offset(i, k)];
+                        const T* solved = &x._data[x.offset(k, j)];
+                        for (int l = from; l < to; ++l) {
+                            out[l] -= u[l] * solved[l];
+                        }
+                    }
+                    for (int l = from; l < to; ++l) {
+                        out[l] /= pivot[l];
+                    }
+                }
+            }
+        });
+
+        if (singular) {
+            throw std::runtime_error("Cannot solve, singular matrix in batch");
+        }
+        return x;
+    }
+
+private:
+
+    // number of matrices processed by one thread at least
+    static const int BATCH_GRAIN = 256;
+
+    int _count, _rows, _cols;
+    std::vector<T> _data;
+
+    MatrixBatch(int count, int rows, int cols) : _count(count), _rows(rows), _cols(cols),
+                                                 _data(static_cast<size_t>(count) * rows * cols) {}
+
+    size_t offset(int row, int col) const {
+        return (static_cast<size_t>(row) * _cols + col) * _count;
+    }
+
+    void check_access(int index, int row, int col) const {
+        if (index <= 0 || row <= 0 || col <= 0 || index > _count || row > _rows || col > _cols) {
+            throw std::runtime_error("Invalid element access");
+        }
+    }
+
+    void swap_rows(int lane, int first, int second) {
+        for (int j = 0; j < _cols; ++j) {
+            std::swap(_data[offset(first, j) + lane], _data[offset(second, j) + lane]);
+        }
+    }
+
+    /**
+     * Gaussian elimination with partial pivoting of matrices [from, to), leaving U in the upper triangle.
+     * Row operations are mirrored on rhs, if given. Sign of row permutation is accumulated into sign,
+     * if given. Returns false if a zero pivot was found.
+     */
+    bool eliminate(MatrixBatch<T>* rhs, int from, int to, T* sign) {
+        int n = _rows;
+        int lanes = to - from;
+        std::vector<int> pivot_row(lanes);
+        std::vector<T> factor(lanes);
+        bool regular = true;
+
+        for (int k = 0; k < n; ++k) {
+            // choose pivots for every lane
+            for (int l = 0; l < lanes; ++l) {
+                pivot_row[l] = k;
+            }
+            for (int i = k + 1; i < n; ++i) {
+                const T* candidate = &_data[offset(i, k)];
+                for (int l = 0; l < lanes; ++l) {
+                    if (std::abs(candidate[l + from]) > std::abs(_data[offset(pivot_row[l], k) + l + from])) {
+                        pivot_row[l] = i;
+                    }
+                }
+            }
+            for (int l = 0; l < lanes; ++l) {
+                if (pivot_row[l] != k) {
+                    swap_rows(l + from, k, pivot_row[l]);
+                    if (rhs != nullptr) {
+                        rhs->swap_rows(l + from, k, pivot_row[l]);
+                    }
+                    if (sign != nullptr) {
+                        sign[l] = -sign[l];
+                    }
+                }
+            }
+
+            const T* pivot = &_data[offset(k, k)];
+            for (int l = from; l < to; ++l) {
+                if (pivot[l] == 0) {
+                    regular = false;
+                }
+            }
+            // a zero pivot means zero determinant, remaining lanes are eliminated as usual
+            if (!regular && rhs != nullptr) {
+                return false;
+            }
+
+            for (int i = k + 1; i < n; ++i) {
+                T* target = &_data[offset(i, k)];
+                for (int l = 0; l < lanes; ++l) {
+                    factor[l] = pivot[l + from] == 0 ? 0 : target[l + from] / pivot[l + from];
+                }
+                for (int j = k; j < _cols; ++j) {
+                    T* row = &_data[offset(i, j)];
+                    const T* source = &_data[offset(k, j)];
+                    for (int l = 0; l < lanes; ++l) {
+                        row[l + from] -= factor[l] * source[l + from];
+                    }
+                }
+                if (rhs != nullptr) {
+                    for (int j = 0; j < rhs->_cols; ++j) {
+                        T* row = &rhs->_data[rhs->offset(i, j)];
+                        const T* source = &rhs->_data[rhs->offset(k, j)];
+                        for (int l = 0; l < lanes; ++l) {
+                            row[l + from] -= factor[l] * source[l + from];
+                        }
+                    }
+                }
+            }
+        }
+
+        return regular;
+    }
+};
+
+#endif
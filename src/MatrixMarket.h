@@ -0,0 +1,469 @@
+#ifndef _MATRIX_MARKET_H
+#define _MATRIX_MARKET_H
+
+#include <stdexcept>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cctype>
+#include <limits>
+#include <fstream>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include "Matrix.h"
+#include "SparseMatrix.h"
+#include "Parallel.h"
+#include "FileMapping.h"
+#include "Text.h"
+
+// Matrix Market (.mtx) files, the format of the SuiteSparse collection. Both coordinate (sparse) and array
+// (dense) formats are read, with real, integer or pattern values and general, symmetric, skew-symmetric
+// or (real) hermitian symmetry; complex matrices are not supported. Files are mapped into memory and split
+// into byte ranges at line boundaries, which are parsed in parallel, see Text.h.
+
+/**
+ * Contents of the banner and the size line. data is the offset of the first entry in the file.
+ */
+struct MatrixMarketHeader {
+
+    enum Field {
+        REAL, INTEGER, PATTERN
+    };
+
+    enum Symmetry {
+        GENERAL, SYMMETRIC, SKEW_SYMMETRIC
+    };
+
+    bool coordinate;
+    Field field;
+    Symmetry symmetry;
+    int rows;
+    int cols;
+    long long entries;
+    size_t data;
+};
+
+/**
+ * Parses integer after blanks at position, moving past it. Returns false if there is none.
+ */
+inline bool matrix_market_integer(const char*& position, const char* end, long long& value) {
+    position = text_blank(position, end);
+    return text_integer(position, end, value);
+}
+
+inline bool matrix_market_real(const char*& position, const char* end, double& value) {
+    position = text_blank(position, end);
+    return text_real(position, end, value);
+}
+
+/**
+ * Parses value of an entry of given field into T.
+ */
+template<class T>
+bool matrix_market_value(const char*& position, const char* end, MatrixMarketHeader::Field field, T& value) {
+    if (field == MatrixMarketHeader::PATTERN) {
+        value = 1;
+        return true;
+    }
+    if (field == MatrixMarketHeader::INTEGER) {
+        long long integer;
+        if (!matrix_market_integer(position, end, integer)) {
+            return false;
+        }
+        value = static_cast<T>(integer);
+        return true;
+    }
+    double real;
+    if (!matrix_market_real(position, end, real)) {
+        return false;
+    }
+    value = static_cast<T>(real);
+    return true;
+}
+
+/**
+ * Returns next word of the banner in lower case.
+ */
+inline std::string matrix_market_word(const char*& position, const char* end) {
+    position = text_blank(position, end);
+    std::string word;
+    for (; position < end && !std::isspace(static_cast<unsigned char>(*position)); ++position) {
+        word += static_cast<char>(std::tolower(static_cast<unsigned char>(*position)));
+    }
+    return word;
+}
+
+/**
+ * Parses banner, comments and size line at the start of the file.
+ */
+inline MatrixMarketHeader matrix_market_header(const char* bytes, size_t length) {
+    const char* end = bytes + length;
+    const char* position = bytes;
+    if (matrix_market_word(position, end) != "%%matrixmarket" || matrix_market_word(position, end) != "matrix") {
+        throw std::runtime_error("Cannot load matrix market: not a matrix market file");
+    }
+
+    MatrixMarketHeader header;
+    std::string format = matrix_market_word(position, end);
+    std::string field = matrix_market_word(position, end);
+    std::string symmetry = matrix_market_word(position, end);
+    if (format != "coordinate" && format != "array") {
+        throw std::runtime_error("Cannot load matrix market: unknown format " + format);
+    }
+    header.coordinate = format == "coordinate";
+
+    if (field == "real" || field == "double") {
+        header.field = MatrixMarketHeader::REAL;
+    } else if (field == "integer") {
+        header.field = MatrixMarketHeader::INTEGER;
+    } else if (field == "pattern" && header.coordinate) {
+        header.field = MatrixMarketHeader::PATTERN;
+    } else {
+        throw std::runtime_error("Cannot load matrix market: unsupported field " + field);
+    }
+
+    if (symmetry == "general") {
+        header.symmetry = MatrixMarketHeader::GENERAL;
+    } else if (symmetry == "symmetric" || symmetry == "hermitian") {
+        header.symmetry = MatrixMarketHeader::SYMMETRIC;
+    } else if (symmetry == "skew-symmetric") {
+        header.symmetry = MatrixMarketHeader::SKEW_SYMMETRIC;
+    } else {
+        throw std::runtime_error("Cannot load matrix market: unknown symmetry " + symmetry);
+    }
+
+    // comments and blank lines up to the size line
+    position = text_line_end(position, end);
+    while (position < end) {
+        ++position;
+        const char* line = text_blank(position, end);
+        if (line < end && *line != '%' && *line != '\n') {
+            break;
+        }
+        position = text_line_end(position, end);
+    }
+
+    long long rows, cols, entries = 0;
+    if (!matrix_market_integer(position, end, rows) || !matrix_market_integer(position, end, cols) ||
+        (header.coordinate && !matrix_market_integer(position, end, entries))) {
+        throw std::runtime_error("Cannot load matrix market: invalid size line");
+    }
+    if (rows <= 0 || cols <= 0 || rows > INT32_MAX || cols > INT32_MAX || entries < 0) {
+        throw std::runtime_error("Cannot load matrix market: invalid dimensions");
+    }
+    if (header.symmetry != MatrixMarketHeader::GENERAL && rows != cols) {
+        throw std::runtime_error("Cannot load matrix market: symmetric matrix is not square");
+    }
+    header.rows = static_cast<int>(rows);
+    header.cols = static_cast<int>(cols);
+
+    if (!header.coordinate) {
+        long long n = rows;
+        entries = header.symmetry == MatrixMarketHeader::GENERAL ? rows * cols :
+                  header.symmetry == MatrixMarketHeader::SYMMETRIC ? n * (n + 1) / 2 : n * (n - 1) / 2;
+    }
+    header.entries = entries;
+    position = text_line_end(position, end);
+    header.data = position < end ? position - bytes + 1 : length;
+    return header;
+}
+
+inline std::runtime_error matrix_market_invalid(const char* line, const char* end) {
+    return std::runtime_error("Cannot load matrix market: invalid entry " +
+                              std::string(line, text_line_end(line, end)));
+}
+
+/**
+ * Parses entries in a range of whole lines, calling entry(position) at the start of every line holding one,
+ * which parses it and returns its end. Blank lines and comments are skipped.
+ */
+template<class F>
+void matrix_market_lines(const char* from, const char* to, F entry) {
+    const char* position = from;
+    while (position < to) {
+        const char* line = text_blank(position, to);
+        if (line < to && *line != '\n' && *line != '%') {
+            const char* rest = text_blank(entry(line), to);
+            if (rest < to && *rest != '\n') {
+                throw matrix_market_invalid(line, to);
+            }
+            line = rest;
+        }
+        const char* next = text_line_end(line, to);
+        position = next < to ? next + 1 : to;
+    }
+}
+
+/**
+ * Parses entries of a coordinate file in parallel, returns them per chunk with symmetric ones expanded.
+ */
+template<class T>
+std::vector<std::vector<Triplet<T> > > matrix_market_triplets(const FileMapping& file,
+                                                              const MatrixMarketHeader& header) {
+    const char* bytes = file.bytes();
+    std::vector<size_t> bounds = text_chunks(bytes, header.data, file.length);
+    int chunks = static_cast<int>(bounds.size()) - 1;
+    std::vector<std::vector<Triplet<T> > > parts(chunks);
+    std::vector<long long> counts(chunks, 0);
+
+    parallel_for(0, chunks, 1, [&](int from, int to) {
+        for (int c = from; c < to; ++c) {
+            const char* end = bytes + bounds[c + 1];
+            std::vector<Triplet<T> >& part = parts[c];
+            part.reserve((bounds[c + 1] - bounds[c]) / 16);
+            matrix_market_lines(bytes + bounds[c], end, [&](const char* line) {
+                const char* position = line;
+                long long row, col;
+                Triplet<T> triplet;
+                if (!matrix_market_integer(position, end, row) || !matrix_market_integer(position, end, col) ||
+                    !matrix_market_value(position, end, header.field, triplet.value) ||
+                    row <= 0 || col <= 0 || row > header.rows || col > header.cols) {
+                    throw matrix_market_invalid(line, end);
+                }
+                triplet.row = static_cast<int>(row);
+                triplet.col = static_cast<int>(col);
+                part.push_back(triplet);
+                if (header.symmetry != MatrixMarketHeader::GENERAL && row != col) {
+                    Triplet<T> mirror = {triplet.col, triplet.row, triplet.value};
+                    if (header.symmetry == MatrixMarketHeader::SKEW_SYMMETRIC) {
+                        mirror.value = -mirror.value;
+                    }
+                    part.push_back(mirror);
+                }
+                ++counts[c];
+                return position;
+            });
+        }
+    });
+
+    long long found = 0;
+    for (long long count : counts) {
+        found += count;
+    }
+    if (found != header.entries) {
+        throw std::runtime_error("Cannot load matrix market: expected " + std::to_string(header.entries) +
+                                 " entries, found " + std::to_string(found));
+    }
+    return parts;
+}
+
+/**
+ * Parses values of an array file in parallel and stores them in the dense matrix, column by column
+ * (only the lower triangle for symmetric matrices, without the diagonal for skew-symmetric ones).
+ */
+template<class T>
+void matrix_market_array(const FileMapping& file, const MatrixMarketHeader& header, Matrix<T>& result) {
+    const char* bytes = file.bytes();
+    std::vector<size_t> bounds = text_chunks(bytes, header.data, file.length);
+    int chunks = static_cast<int>(bounds.size()) - 1;
+    std::vector<std::vector<T> > parts(chunks);
+
+    parallel_for(0, chunks, 1, [&](int from, int to) {
+        for (int c = from; c < to; ++c) {
+            const char* end = bytes + bounds[c + 1];
+            std::vector<T>& part = parts[c];
+            matrix_market_lines(bytes + bounds[c], end, [&](const char* line) {
+                const char* position = line;
+                T value;
+                if (!matrix_market_value(position, end, header.field, value)) {
+                    throw matrix_market_invalid(line, end);
+                }
+                part.push_back(value);
+                return position;
+            });
+        }
+    });
+
+    std::vector<long long> offsets(chunks + 1, 0);
+    for (int c = 0; c < chunks; ++c) {
+        offsets[c + 1] = offsets[c] + static_cast<long long>(parts[c].size());
+    }
+    if (offsets[chunks] != header.entries) {
+        throw std::runtime_error("Cannot load matrix market: expected " + std::to_string(header.entries) +
+                                 " entries, found " + std::to_string(offsets[chunks]));
+    }
+
+    // first row stored in column col (0-based)
+    int skip = header.symmetry == MatrixMarketHeader::SKEW_SYMMETRIC ? 1 : 0;
+    auto first_row = [&](int col) {
+        return header.symmetry == MatrixMarketHeader::GENERAL ? 0 : col + skip;
+    };
+
+    parallel_for(0, chunks, 1, [&](int from, int to) {
+        for (int c = from; c < to; ++c) {
+            // coordinates of the first value of the chunk
+            long long index = offsets[c];
+            int col = 0;
+            while (col < header.cols && index >= header.rows - first_row(col)) {
+                index -= header.rows - first_row(col);
+                ++col;
+            }
+            int row = first_row(col) + static_cast<int>(index);
+
+            for (const T& value : parts[c]) {
+                result.row_data(row + 1)[col] = value;
+                if (header.symmetry != MatrixMarketHeader::GENERAL && row != col) {
+                    result.row_data(col + 1)[row] = header.symmetry == MatrixMarketHeader::SYMMETRIC ? value : -value;
+                }
+                if (++row == header.rows) {
+                    ++col;
+                    row = first_row(col);
+                }
+            }
+        }
+    });
+}
+
+/**
+ * Reads header of a Matrix Market file.
+ */
+inline MatrixMarketHeader read_matrix_market_header(const std::string& path) {
+    FileMapping file(path);
+    return matrix_market_header(file.bytes(), file.length);
+}
+
+/**
+ * Loads Matrix Market file of any format as a dense matrix. Missing entries of coordinate files are zeros,
+ * duplicate ones are summed.
+ */
+template<class T>
+Matrix<T> load_matrix_market(const std::string& path) {
+    FileMapping file(path);
+    file.sequential();
+    MatrixMarketHeader header = matrix_market_header(file.bytes(), file.length);
+    Matrix<T> result = Matrix<T>::zeros(header.rows, header.cols);
+
+    if (header.coordinate) {
+        std::vector<std::vector<Triplet<T> > > parts = matrix_market_triplets<T>(file, header);
+        for (const std::vector<Triplet<T> >& part : parts) {
+            for (const Triplet<T>& triplet : part) {
+                result.row_data(triplet.row)[triplet.col - 1] += triplet.value;
+            }
+        }
+    } else {
+        matrix_market_array(file, header, result);
+    }
+    return result;
+}
+
+/**
+ * Loads Matrix Market file of any format as a sparse matrix, see load_matrix_market.
+ */
+template<class T>
+SparseMatrix<T> load_matrix_market_sparse(const std::string& path) {
+    FileMapping file(path);
+    file.sequential();
+    MatrixMarketHeader header = matrix_market_header(file.bytes(), file.length);
+    if (!header.coordinate) {
+        Matrix<T> dense = Matrix<T>::zeros(header.rows, header.cols);
+        matrix_market_array(file, header, dense);
+        return SparseMatrix<T>::from_dense(dense);
+    }
+
+    std::vector<std::vector<Triplet<T> > > parts = matrix_market_triplets<T>(file, header);
+    size_t total = 0;
+    for (const std::vector<Triplet<T> >& part : parts) {
+        total += part.size();
+    }
+    std::vector<Triplet<T> > triplets;
+    triplets.reserve(total);
+    for (std::vector<Triplet<T> >& part : parts) {
+        triplets.insert(triplets.end(), part.begin(), part.end());
+        std::vector<Triplet<T> >().swap(part);
+    }
+    return SparseMatrix<T>::from_triplets(header.rows, header.cols, triplets);
+}
+
+template<class T>
+const char* matrix_market_field() {
+    return std::is_floating_point<T>::value ? "real" : "integer";
+}
+
+/**
+ * Saves dense matrix to Matrix Market file in array format. Values are formatted in parallel, a batch
+ * of columns at a time.
+ */
+template<class T, class Layout>
+void save_matrix_market(const Matrix<T, Layout>& m, const std::string& path) {
+    static_assert(std::is_arithmetic<T>::value, "Matrix Market requires arithmetic element type");
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Cannot create file " + path);
+    }
+    out << "%%MatrixMarket matrix array " << matrix_market_field<T>() << " general\n"
+        << m.rows() << " " << m.cols() << "\n";
+
+    int rows = m.rows(), batch = std::max(1, TEXT_BATCH / rows);
+    std::vector<std::string> texts;
+    for (int first = 1; first <= m.cols(); first += batch) {
+        int last = std::min(m.cols(), first + batch - 1);
+        texts.assign(last - first + 1, std::string());
+        parallel_for(first, last + 1, std::max(1, 4096 / rows), [&](int from, int to) {
+            char buffer[TEXT_NUMBER];
+            for (int j = from; j < to; ++j) {
+                std::string& text = texts[j - first];
+                for (int i = 1; i <= rows; ++i) {
+                    text.append(buffer, text_format(buffer, m.at(i, j)));
+                    text += '\n';
+                }
+            }
+        });
+        for (const std::string& text : texts) {
+            out.write(text.data(), text.size());
+        }
+    }
+    if (!out.flush()) {
+        throw std::runtime_error("Cannot write file " + path);
+    }
+}
+
+/**
+ * Saves sparse matrix to Matrix Market file in coordinate format, entries row by row.
+ */
+template<class T>
+void save_matrix_market(const SparseMatrix<T>& m, const std::string& path) {
+    static_assert(std::is_arithmetic<T>::value, "Matrix Market requires arithmetic element type");
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Cannot create file " + path);
+    }
+    out << "%%MatrixMarket matrix coordinate " << matrix_market_field<T>() << " general\n"
+        << m.rows() << " " << m.cols() << " " << m.nonzeros() << "\n";
+
+    const std::vector<int>& offsets = m.row_offsets();
+    int average = std::max(1, m.nonzeros() / m.rows());
+    int batch = std::max(1, TEXT_BATCH / average);
+    std::vector<std::string> texts;
+    for (int first = 0; first < m.rows(); first += batch) {
+        int last = std::min(m.rows(), first + batch);
+        texts.assign(last - first, std::string());
+        parallel_for(first, last, std::max(1, 4096 / average), [&](int from, int to) {
+            char buffer[TEXT_NUMBER];
+            for (int i = from; i < to; ++i) {
+                std::string& text = texts[i - first];
+                for (int k = offsets[i]; k < offsets[i + 1]; ++k) {
+                    text.append(buffer, text_format(buffer, i + 1));
+                    text += ' ';
+                    text.append(buffer, text_format(buffer, m.col_indices()[k] + 1));
+                    text += ' ';
+                    text.append(buffer, text_format(buffer, m.values()[k]));
+                    text += '\n';
+                }
+            }
+        });
+        for (const std::string& text : texts) {
+            out.write(text.data(), text.size());
+        }
+    }
+    if (!out.flush()) {
+        throw std::runtime_error("Cannot write file " + path);
+    }
+}
+
+#endif
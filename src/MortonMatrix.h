@@ -0,0 +1,391 @@
+#ifndef _MORTON_MATRIX_H
+#define _MORTON_MATRIX_H
+
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+#include "Matrix.h"
+
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+/**
+ * Spreads bits of x apart, bit i goes to bit 2i.
+ */
+inline uint64_t morton_spread(uint32_t x) {
+    uint64_t v = x;
+    v = (v | (v << 16)) & 0x0000FFFF0000FFFFULL;
+    v = (v | (v << 8)) & 0x00FF00FF00FF00FFULL;
+    v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    v = (v | (v << 2)) & 0x3333333333333333ULL;
+    v = (v | (v << 1)) & 0x5555555555555555ULL;
+    return v;
+}
+
+/**
+ * Inverse of morton_spread, gathers even bits of v.
+ */
+inline uint32_t morton_compact(uint64_t v) {
+    v &= 0x5555555555555555ULL;
+    v = (v | (v >> 1)) & 0x3333333333333333ULL;
+    v = (v | (v >> 2)) & 0x0F0F0F0F0F0F0F0FULL;
+    v = (v | (v >> 4)) & 0x00FF00FF00FF00FFULL;
+    v = (v | (v >> 8)) & 0x0000FFFF0000FFFFULL;
+    v = (v | (v >> 16)) & 0x00000000FFFFFFFFULL;
+    return static_cast<uint32_t>(v);
+}
+
+/**
+ * Returns position of (row, col) on the Z-order curve: bits of col go to even bits of the result,
+ * bits of row to odd ones. Uses PDEP when compiled for BMI2.
+ */
+inline uint64_t morton_encode(uint32_t row, uint32_t col) {
+#ifdef __BMI2__
+    return _pdep_u64(col, 0x5555555555555555ULL) | _pdep_u64(row, 0xAAAAAAAAAAAAAAAAULL);
+#else
+    return morton_spread(col) | (morton_spread(row) << 1);
+#endif
+}
+
+/**
+ * Inverse of morton_encode.
+ */
+inline void morton_decode(uint64_t code, uint32_t& row, uint32_t& col) {
+#ifdef __BMI2__
+    col = static_cast<uint32_t>(_pext_u64(code, 0x5555555555555555ULL));
+    row = static_cast<uint32_t>(_pext_u64(code, 0xAAAAAAAAAAAAAAAAULL));
+#else
+    col = morton_compact(code);
+    row = morton_compact(code >> 1);
+#endif
+}
+
+/**
+ * Side of the square tiles of MortonMatrix; three tiles of doubles fit in L1 cache.
+ */
+const int MORTON_TILE = 32;
+
+/**
+ * Dense matrix stored as a 2^L x 2^L grid of MORTON_TILE x MORTON_TILE tiles ordered along the Z-order
+ * curve, every tile row-major. Any quadrant, at any level of recursive splitting, occupies a contiguous
+ * block of storage, which makes recursive (cache-oblivious) algorithms such as gemm and transpose below
+ * cache friendly at all levels. The grid covers the larger dimension and the padding is kept zero,
+ * so the layout is meant for roughly square matrices.
+ *
+ * Quadrants are views sharing storage with the matrix, copies are always deep.
+ */
+template<class T>
+class MortonMatrix {
+public:
+
+    /**
+     * Creates MxN matrix filled with zeros.
+     */
+    static MortonMatrix zeros(int rows, int cols) {
+        if (!(rows > 0 && cols > 0)) {
+            throw std::runtime_error("Cannot create matrix with nonpositive dimensions");
+        }
+
+        return MortonMatrix(rows, cols, level_for(std::max(rows, cols)));
+    }
+
+    /**
+     * Copies dense row-major matrix, tile rows are converted in parallel.
+     */
+    static MortonMatrix from_dense(const Matrix<T>& dense) {
+        MortonMatrix result = zeros(dense.rows(), dense.cols());
+        int tiles = (dense.rows() + MORTON_TILE - 1) / MORTON_TILE;
+        parallel_for(0, tiles, tile_grain(dense.cols()), [&](int from, int to) {
+            for (int ti = from; ti < to; ++ti) {
+                int height = std::min(MORTON_TILE, dense.rows() - ti * MORTON_TILE);
+                for (int tj = 0; tj * MORTON_TILE < dense.cols(); ++tj) {
+                    int width = std::min(MORTON_TILE, dense.cols() - tj * MORTON_TILE);
+                    T* tile = result.tile_at(ti, tj);
+                    for (int r = 0; r < height; ++r) {
+                        const T* row = dense.row_data(ti * MORTON_TILE + r + 1) + tj * MORTON_TILE;
+                        std::copy(row, row + width, tile + r * MORTON_TILE);
+                    }
+                }
+            }
+        });
+        return result;
+    }
+
+    /**
+     * Copies the matrix to a dense row-major one, tile rows are converted in parallel.
+     */
+    Matrix<T> to_dense() const {
+        Matrix<T> result = Matrix<T>::zeros(_rows, _cols);
+        int tiles = (_rows + MORTON_TILE - 1) / MORTON_TILE;
+        parallel_for(0, tiles, tile_grain(_cols), [&](int from, int to) {
+            for (int ti = from; ti < to; ++ti) {
+                int height = std::min(MORTON_TILE, _rows - ti * MORTON_TILE);
+                for (int tj = 0; tj * MORTON_TILE < _cols; ++tj) {
+                    int width = std::min(MORTON_TILE, _cols - tj * MORTON_TILE);
+                    const T* tile = tile_at(ti, tj);
+                    for (int r = 0; r < height; ++r) {
+                        std::copy(tile + r * MORTON_TILE, tile + r * MORTON_TILE + width,
+                                  result.row_data(ti * MORTON_TILE + r + 1) + tj * MORTON_TILE);
+                    }
+                }
+            }
+        });
+        return result;
+    }
+
+    int rows() const {
+        return _rows;
+    }
+
+    int cols() const {
+        return _cols;
+    }
+
+    /**
+     * Returns number of times the grid of tiles can be split into quadrants.
+     */
+    int level() const {
+        return _level;
+    }
+
+    /**
+     * Returns side of the padded square covered by storage.
+     */
+    int side() const {
+        return MORTON_TILE << _level;
+    }
+
+    /**
+     * Checks if the matrix is a quadrant of another one.
+     */
+    bool is_view() const {
+        return !owner;
+    }
+
+    /**
+     * Gets element at the specific coordinates.
+     */
+    T& at(int row, int col) const {
+        if (row <= 0 || col <= 0 || row > _rows || col > _cols) {
+            throw std::runtime_error("Invalid element access");
+        }
+
+        int r = row - 1, c = col - 1;
+        return tile_at(r / MORTON_TILE, c / MORTON_TILE)[(r % MORTON_TILE) * MORTON_TILE + c % MORTON_TILE];
+    }
+
+    /**
+     * Returns pointer to the contiguous row-major tile at the specific tile coordinates.
+     */
+    T* tile_data(int tile_row, int tile_col) const {
+        int tiles = 1 << _level;
+        if (tile_row <= 0 || tile_col <= 0 || tile_row > tiles || tile_col > tiles) {
+            throw std::runtime_error("Invalid tile access");
+        }
+
+        return tile_at(tile_row - 1, tile_col - 1);
+    }
+
+    /**
+     * Returns view of one of the four quadrants, row and col are 1 or 2. Quadrants of the padding
+     * have zero dimensions.
+     */
+    MortonMatrix quadrant(int row, int col) const {
+        if (row < 1 || row > 2 || col < 1 || col > 2) {
+            throw std::runtime_error("Invalid quadrant access");
+        }
+        if (_level == 0) {
+            throw std::runtime_error("Cannot split single tile into quadrants");
+        }
+
+        int half = side() / 2;
+        return MortonMatrix(_data + quadrant_offset(_level, row - 1, col - 1),
+                            clamp_extent(_rows, row - 1, half), clamp_extent(_cols, col - 1, half), _level - 1);
+    }
+
+    /**
+     * Returns transposed matrix, computed recursively quadrant by quadrant.
+     */
+    MortonMatrix transpose() const {
+        MortonMatrix result(_cols, _rows, _level);
+        transpose_block(_data, result._data, _level, _rows, _cols);
+        return result;
+    }
+
+    /**
+     * Computes c += a * b recursively: every quadrant of c accumulates two products of quadrants of a and b,
+     * the four quadrants of c are computed in parallel. Operands may have different levels, a smaller
+     * matrix is exactly the leading block of storage of a larger one, so the recursion runs at the
+     * largest level and skips blocks outside of the operands.
+     */
+    static void gemm(const MortonMatrix& a, const MortonMatrix& b, MortonMatrix& c) {
+        if (a._cols != b._rows || a._rows != c._rows || b._cols != c._cols) {
+            throw std::runtime_error("Cannot multiply matrices with mismatching dimensions");
+        }
+
+        int level = std::max(a._level, std::max(b._level, c._level));
+        multiply_block(a._data, b._data, c._data, level, a._rows, a._cols, b._cols);
+    }
+
+    MortonMatrix operator*(const MortonMatrix& other) const {
+        MortonMatrix result = zeros(_rows, other._cols);
+        gemm(*this, other, result);
+        return result;
+    }
+
+    bool operator==(const MortonMatrix& other) const {
+        if (_rows != other._rows || _cols != other._cols) {
+            return false;
+        }
+
+        for (int i = 1; i <= _rows; ++i) {
+            for (int j = 1; j <= _cols; ++j) {
+                if (at(i, j) != other.at(i, j)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool operator!=(const MortonMatrix& other) const {
+        return !(*this == other);
+    }
+
+    MortonMatrix(const MortonMatrix& other) : MortonMatrix(other._rows, other._cols, other._level) {
+        std::copy(other._data, other._data + storage_size(_level), _data);
+    }
+
+    MortonMatrix(MortonMatrix&& rvalue) : _rows(rvalue._rows), _cols(rvalue._cols), _level(rvalue._level),
+                                          _data(rvalue._data), owner(rvalue.owner) {
+        rvalue._data = nullptr;
+        rvalue.owner = false;
+    }
+
+    ~MortonMatrix() {
+        if (owner) {
+            release_storage(_data, storage_size(_level));
+        }
+    }
+
+private:
+    int _rows, _cols, _level;
+    T* _data;
+    bool owner;
+
+    static const int PARALLEL_THRESHOLD = 1 << 15;
+
+    MortonMatrix(int rows, int cols, int level)
+            : _rows(rows), _cols(cols), _level(level),
+              _data(allocate_storage<T>(1 << (2 * level), MORTON_TILE * MORTON_TILE,
+                                        std::max(1, PARALLEL_THRESHOLD / (MORTON_TILE * MORTON_TILE)),
+                                        numa_policy())),
+              owner(true) {}
+
+    MortonMatrix(T* data, int rows, int cols, int level)
+            : _rows(rows), _cols(cols), _level(level), _data(data), owner(false) {}
+
+    static int level_for(int size) {
+        int level = 0;
+        while ((MORTON_TILE << level) < size) {
+            ++level;
+        }
+        return level;
+    }
+
+    static size_t storage_size(int level) {
+        return (static_cast<size_t>(1) << (2 * level)) * MORTON_TILE * MORTON_TILE;
+    }
+
+    static int tile_grain(int cols) {
+        return std::max(1, PARALLEL_THRESHOLD / (MORTON_TILE * std::max(1, cols)));
+    }
+
+    /**
+     * Returns offset of quadrant (row, col), 0-based, of a block at the given level.
+     */
+    static size_t quadrant_offset(int level, int row, int col) {
+        return (2 * row + col) * storage_size(level - 1);
+    }
+
+    /**
+     * Returns part of extent falling into the half number index (0 or 1) of a block.
+     */
+    static int clamp_extent(int extent, int index, int half) {
+        return std::max(0, std::min(half, extent - index * half));
+    }
+
+    T* tile_at(int tile_row, int tile_col) const {
+        return _data + morton_encode(tile_row, tile_col) * MORTON_TILE * MORTON_TILE;
+    }
+
+    /**
+     * Runs body(row, col) for the four quadrants of a block, in parallel when quadrants are at least
+     * two tiles wide.
+     */
+    template<class F>
+    static void for_each_quadrant(int level, F body) {
+        int grain = level > 1 ? 1 : 4;
+        parallel_for(0, 4, grain, [&](int from, int to) {
+            for (int q = from; q < to; ++q) {
+                body(q / 2, q % 2);
+            }
+        });
+    }
+
+    static void transpose_block(const T* source, T* target, int level, int rows, int cols) {
+        if (rows <= 0 || cols <= 0) {
+            return;
+        }
+
+        if (level == 0) {
+            for (int i = 0; i < rows; ++i) {
+                for (int j = 0; j < cols; ++j) {
+                    target[j * MORTON_TILE + i] = source[i * MORTON_TILE + j];
+                }
+            }
+            return;
+        }
+
+        int half = MORTON_TILE << (level - 1);
+        for_each_quadrant(level, [&](int row, int col) {
+            transpose_block(source + quadrant_offset(level, row, col), target + quadrant_offset(level, col, row),
+                            level - 1, clamp_extent(rows, row, half), clamp_extent(cols, col, half));
+        });
+    }
+
+    /**
+     * Computes c += a * b for blocks at the given level, a is rows x inner, b is inner x cols.
+     */
+    static void multiply_block(const T* a, const T* b, T* c, int level, int rows, int inner, int cols) {
+        if (rows <= 0 || inner <= 0 || cols <= 0) {
+            return;
+        }
+
+        if (level == 0) {
+            for (int i = 0; i < rows; ++i) {
+                T* target = c + i * MORTON_TILE;
+                for (int k = 0; k < inner; ++k) {
+                    T factor = a[i * MORTON_TILE + k];
+                    const T* source = b + k * MORTON_TILE;
+                    for (int j = 0; j < cols; ++j) {
+                        target[j] += factor * source[j];
+                    }
+                }
+            }
+            return;
+        }
+
+        int half = MORTON_TILE << (level - 1);
+        for_each_quadrant(level, [&](int row, int col) {
+            for (int k = 0; k < 2; ++k) {
+                multiply_block(a + quadrant_offset(level, row, k), b + quadrant_offset(level, k, col),
+                               c + quadrant_offset(level, row, col), level - 1, clamp_extent(rows, row, half),
+                               clamp_extent(inner, k, half), clamp_extent(cols, col, half));
+            }
+        });
+    }
+};
+
+#endif
@@ -0,0 +1,666 @@
+#ifndef _NPY_H
+#define _NPY_H
+
+#include <stdexcept>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include "Matrix.h"
+#include "DType.h"
+#include "Checksum.h"
+#include "FileMapping.h"
+
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <climits>
+
+// NumPy .npy files and uncompressed .npz archives. Elements are little-endian, so the files are read and
+// written without conversion on little-endian hosts only. Row-major matrices are stored in C order and
+// column-major ones in Fortran order; other layouts are converted to row-major when saved.
+
+/**
+ * Contents of a .npy header: element type, order and dimensions; one-dimensional arrays are single rows.
+ * data is the offset of elements from the start of the file.
+ */
+struct NpyHeader {
+    DType::Code dtype;
+    bool fortran_order;
+    int rows;
+    int cols;
+    size_t data;
+};
+
+const char NPY_MAGIC[6] = {'\x93', 'N', 'U', 'M', 'P', 'Y'};
+
+/**
+ * Returns descr of NumPy for elements of given type, for example "<f8".
+ */
+inline std::string npy_descr(DType::Code dtype) {
+    switch (dtype) {
+        case DType::INT8:
+            return "|i1";
+        case DType::UINT8:
+            return "|u1";
+        case DType::INT16:
+            return "<i2";
+        case DType::UINT16:
+            return "<u2";
+        case DType::INT32:
+            return "<i4";
+        case DType::UINT32:
+            return "<u4";
+        case DType::INT64:
+            return "<i8";
+        case DType::UINT64:
+            return "<u8";
+        case DType::FLOAT32:
+            return "<f4";
+        case DType::FLOAT64:
+            return "<f8";
+        default:
+            throw std::runtime_error("Cannot store unknown element type in npy");
+    }
+}
+
+/**
+ * Returns header of a .npy file of version 1.0, padded so the elements start at a multiple of 64 bytes.
+ */
+inline std::string npy_header(DType::Code dtype, bool fortran_order, int rows, int cols) {
+    std::string dictionary = "{'descr': '" + npy_descr(dtype) + "', 'fortran_order': " +
+                             (fortran_order ? "True" : "False") + ", 'shape': (" + std::to_string(rows) + ", " +
+                             std::to_string(cols) + "), }";
+    size_t length = sizeof(NPY_MAGIC) + 4 + dictionary.size() + 1;
+    dictionary.append((64 - length % 64) % 64, ' ');
+    dictionary += '\n';
+
+    std::string header(NPY_MAGIC, sizeof(NPY_MAGIC));
+    header += '\x01';
+    header += '\x00';
+    header += static_cast<char>(dictionary.size() & 0xFF);
+    header += static_cast<char>(dictionary.size() >> 8);
+    return header + dictionary;
+}
+
+/**
+ * Returns value of key in the header dictionary, up to the next comma outside parentheses or the closing brace.
+ */
+inline std::string npy_value(const std::string& dictionary, const std::string& key) {
+    size_t start = dictionary.find("'" + key + "'");
+    if (start == std::string::npos) {
+        start = dictionary.find("\"" + key + "\"");
+    }
+    if (start == std::string::npos || (start = dictionary.find(':', start)) == std::string::npos) {
+        throw std::runtime_error("Cannot load npy: header has no " + key);
+    }
+
+    size_t end = start + 1;
+    int depth = 0;
+    while (end < dictionary.size() && !(depth == 0 && (dictionary[end] == ',' || dictionary[end] == '}'))) {
+        depth += dictionary[end] == '(' ? 1 : dictionary[end] == ')' ? -1 : 0;
+        ++end;
+    }
+
+    std::string value = dictionary.substr(start + 1, end - start - 1);
+    size_t first = value.find_first_not_of(" \t'\""), last = value.find_last_not_of(" \t'\"");
+    return first == std::string::npos ? std::string() : value.substr(first, last - first + 1);
+}
+
+/**
+ * Parses .npy header at the start of size bytes, throws if it is not one or describes unsupported array.
+ */
+inline NpyHeader npy_parse(const char* bytes, size_t size) {
+    if (size < 10 || std::memcmp(bytes, NPY_MAGIC, sizeof(NPY_MAGIC)) != 0) {
+        throw std::runtime_error("Cannot load npy: not a npy file");
+    }
+
+    const unsigned char* fields = reinterpret_cast<const unsigned char*>(bytes);
+    size_t start, length;
+    if (fields[6] == 1) {
+        start = 10;
+        length = fields[8] | (fields[9] << 8);
+    } else if ((fields[6] == 2 || fields[6] == 3) && size >= 12) {
+        start = 12;
+        length = fields[8] | (fields[9] << 8) | (fields[10] << 16) | (static_cast<size_t>(fields[11]) << 24);
+    } else {
+        throw std::runtime_error("Cannot load npy: unsupported version");
+    }
+    if (start + length > size) {
+        throw std::runtime_error("Cannot load npy: file is truncated");
+    }
+    std::string dictionary(bytes + start, length);
+
+    NpyHeader header;
+    header.data = start + length;
+    header.dtype = DType::UNKNOWN;
+    std::string descr = npy_value(dictionary, "descr");
+    for (int code = DType::INT8; code <= DType::FLOAT64; ++code) {
+        std::string known = npy_descr(static_cast<DType::Code>(code));
+        if (descr == known || (descr.size() == 3 && descr[0] == '=' && descr.substr(1) == known.substr(1))) {
+            header.dtype = static_cast<DType::Code>(code);
+        }
+    }
+    if (header.dtype == DType::UNKNOWN) {
+        throw std::runtime_error("Cannot load npy: unsupported element type " + descr);
+    }
+
+    std::string order = npy_value(dictionary, "fortran_order");
+    if (order != "True" && order != "False") {
+        throw std::runtime_error("Cannot load npy: invalid fortran_order");
+    }
+    header.fortran_order = order == "True";
+
+    std::string shape = npy_value(dictionary, "shape");
+    std::vector<long long> dimensions;
+    const char* position = shape.c_str();
+    while (*position != '\0') {
+        if (*position >= '0' && *position <= '9') {
+            char* end;
+            dimensions.push_back(std::strtoll(position, &end, 10));
+            position = end;
+        } else {
+            ++position;
+        }
+    }
+    if (dimensions.size() == 1) {
+        dimensions.insert(dimensions.begin(), 1);
+        header.fortran_order = false;
+    }
+    if (dimensions.size() != 2) {
+        throw std::runtime_error("Cannot load npy: only one or two dimensional arrays are supported");
+    }
+    if (dimensions[0] <= 0 || dimensions[1] <= 0 || dimensions[0] > INT32_MAX || dimensions[1] > INT32_MAX) {
+        throw std::runtime_error("Cannot load npy: invalid dimensions");
+    }
+    header.rows = static_cast<int>(dimensions[0]);
+    header.cols = static_cast<int>(dimensions[1]);
+
+    if (static_cast<uint64_t>(header.rows) * header.cols > (size - header.data) / DType::size(header.dtype)) {
+        throw std::runtime_error("Cannot load npy: file is truncated");
+    }
+    return header;
+}
+
+/**
+ * Moves matrix loaded in the layout of the file to the requested layout: as it is when they are the same,
+ * converting otherwise.
+ */
+template<class T, class Stored, class Layout>
+struct NpyRelayout {
+    static Matrix<T, Layout> apply(Matrix<T, Stored>& m) {
+        return m.template to_layout<Layout>();
+    }
+};
+
+template<class T, class Layout>
+struct NpyRelayout<T, Layout, Layout> {
+    static Matrix<T, Layout> apply(Matrix<T, Layout>& m) {
+        return std::move(m);
+    }
+};
+
+/**
+ * Returns matrix over elements of the mapping stored in Stored layout, without copying when Layout is the
+ * same and elements are aligned. Matrices keep the mapping alive as long as they use it.
+ */
+template<class T, class Stored, class Layout>
+Matrix<T, Layout> npy_matrix(const std::shared_ptr<FileMapping>& mapping, const char* data, int rows, int cols) {
+    int stride = Stored::min_stride(rows, cols);
+    if (reinterpret_cast<uintptr_t>(data) % alignof(T) != 0) {
+        Matrix<T, Stored> copy = Matrix<T, Stored>::with_stride(rows, cols, stride);
+        std::memcpy(&copy.at(1, 1), data, static_cast<size_t>(rows) * cols * sizeof(T));
+        return NpyRelayout<T, Stored, Layout>::apply(copy);
+    }
+
+    std::shared_ptr<FileMapping> keep = mapping;
+    Matrix<T, Stored> mapped = Matrix<T, Stored>::adopt(reinterpret_cast<T*>(const_cast<char*>(data)), rows, cols,
+                                                        stride, [keep](T*) {});
+    return NpyRelayout<T, Stored, Layout>::apply(mapped);
+}
+
+/**
+ * Returns matrix of the .npy file held in size bytes at offset of the mapping.
+ */
+template<class T, class Layout>
+Matrix<T, Layout> npy_load(const std::shared_ptr<FileMapping>& mapping, size_t offset, size_t size) {
+    static_assert(dtype_of<T>::code != DType::UNKNOWN, "npy requires arithmetic element type");
+
+    NpyHeader header = npy_parse(mapping->bytes() + offset, size);
+    if (header.dtype != dtype_of<T>::code) {
+        throw std::runtime_error(std::string("Cannot load npy: stored elements are ") + DType::name(header.dtype));
+    }
+
+    const char* data = mapping->bytes() + offset + header.data;
+    if (header.fortran_order) {
+        return npy_matrix<T, ColumnMajor, Layout>(mapping, data, header.rows, header.cols);
+    }
+    return npy_matrix<T, RowMajor, Layout>(mapping, data, header.rows, header.cols);
+}
+
+/**
+ * Loads matrix from .npy file. The file is mapped into memory, elements are paged in lazily when touched
+ * and are used without copying when the order of the file matches Layout (C order for row-major, Fortran
+ * order for column-major), so even huge arrays load instantly. Otherwise they are converted.
+ */
+template<class T, class Layout = RowMajor>
+Matrix<T, Layout> load_npy(const std::string& path) {
+    std::shared_ptr<FileMapping> mapping = std::make_shared<FileMapping>(path);
+    return npy_load<T, Layout>(mapping, 0, mapping->length);
+}
+
+/**
+ * Returns blocks of storage holding elements of the matrix in the order of a .npy file: rows of a row-major
+ * matrix or columns of a column-major one, adjacent ones merged.
+ */
+template<class T, class Layout>
+std::vector<iovec> npy_blocks(const Matrix<T, Layout>& m) {
+    static_assert(dtype_of<T>::code != DType::UNKNOWN, "npy requires arithmetic element type");
+
+    int lines = Layout::ROWS_CONTIGUOUS ? m.rows() : m.cols();
+    size_t length = (Layout::ROWS_CONTIGUOUS ? m.cols() : m.rows()) * sizeof(T);
+    std::vector<iovec> blocks;
+    for (int line = 1; line <= lines; ++line) {
+        char* start = reinterpret_cast<char*>(Layout::ROWS_CONTIGUOUS ? &m.at(line, 1) : &m.at(1, line));
+        if (!blocks.empty() && static_cast<char*>(blocks.back().iov_base) + blocks.back().iov_len == start) {
+            blocks.back().iov_len += length;
+        } else {
+            iovec block;
+            block.iov_base = start;
+            block.iov_len = length;
+            blocks.push_back(block);
+        }
+    }
+    return blocks;
+}
+
+/**
+ * Writes all blocks to the file with as few writev calls as possible.
+ */
+inline void npy_write(int fd, std::vector<iovec> blocks, const std::string& path) {
+    size_t next = 0;
+    while (next < blocks.size()) {
+        int count = static_cast<int>(std::min<size_t>(blocks.size() - next, IOV_MAX));
+        ssize_t written = writev(fd, &blocks[next], count);
+        if (written < 0) {
+            throw std::runtime_error("Cannot write file " + path);
+        }
+
+        // writev may stop early, the rest is written with the following calls
+        size_t done = static_cast<size_t>(written);
+        while (next < blocks.size() && done >= blocks[next].iov_len) {
+            done -= blocks[next].iov_len;
+            ++next;
+        }
+        if (next < blocks.size()) {
+            blocks[next].iov_base = static_cast<char*>(blocks[next].iov_base) + done;
+            blocks[next].iov_len -= done;
+        }
+    }
+}
+
+/**
+ * Returns blocks of a whole .npy file: the header followed by the elements.
+ */
+template<class T, class Layout>
+std::vector<iovec> npy_file(const Matrix<T, Layout>& m, const std::string& header) {
+    std::vector<iovec> blocks = npy_blocks(m);
+    iovec first;
+    first.iov_base = const_cast<char*>(header.data());
+    first.iov_len = header.size();
+    blocks.insert(blocks.begin(), first);
+    return blocks;
+}
+
+/**
+ * Saves row-major (C order) or column-major (Fortran order) matrix to .npy file, writing storage directly.
+ */
+template<class T, class Layout>
+void save_npy(const Matrix<T, Layout>& m, const std::string& path) {
+    std::string header = npy_header(dtype_of<T>::code, !Layout::ROWS_CONTIGUOUS, m.rows(), m.cols());
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create file " + path);
+    }
+    try {
+        npy_write(fd, npy_file(m, header), path);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    if (::close(fd) != 0) {
+        throw std::runtime_error("Cannot write file " + path);
+    }
+}
+
+/**
+ * Saves tiled matrix to .npy file in C order.
+ */
+template<class T, int SIZE>
+void save_npy(const Matrix<T, Tiled<SIZE>>& m, const std::string& path) {
+    save_npy(m.template to_layout<RowMajor>(), path);
+}
+
+/**
+ * Appends little-endian integer of given number of bytes.
+ */
+inline void npz_put(std::string& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+inline uint64_t npz_get(const char* in, int bytes) {
+    uint64_t value = 0;
+    for (int i = bytes - 1; i >= 0; --i) {
+        value = (value << 8) | static_cast<unsigned char>(in[i]);
+    }
+    return value;
+}
+
+const uint32_t NPZ_LOCAL = 0x04034b50;
+const uint32_t NPZ_CENTRAL = 0x02014b50;
+const uint32_t NPZ_END = 0x06054b50;
+// extra field used to pad local headers so the arrays start aligned, as zipalign does
+const uint16_t NPZ_ALIGNMENT = 0xD935;
+
+/**
+ * Writes uncompressed .npz archive (a zip of .npy files), readable by numpy.load. Every array is written
+ * straight from storage of its matrix and starts at a multiple of 64 bytes in the archive, so NpzArchive
+ * loads it without copying. Archives are limited to 4 GiB (no zip64).
+ */
+class NpzWriter {
+
+public:
+
+    static NpzWriter create(const std::string& path) {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot create file " + path);
+        }
+        return NpzWriter(path, fd);
+    }
+
+    /**
+     * Adds matrix as array called name, stored in the archive as name.npy.
+     */
+    template<class T, class Layout>
+    void add(const std::string& name, const Matrix<T, Layout>& m) {
+        if (fd < 0) {
+            throw std::runtime_error("Cannot add array to closed archive " + _path);
+        }
+
+        std::string header = npy_header(dtype_of<T>::code, !Layout::ROWS_CONTIGUOUS, m.rows(), m.cols());
+        std::vector<iovec> blocks = npy_file(m, header);
+        Entry entry;
+        entry.name = name + ".npy";
+        entry.offset = offset;
+        entry.size = 0;
+        entry.crc = 0;
+        for (const iovec& block : blocks) {
+            if (block.iov_len > CRC32_CHUNK) {
+                entry.crc = crc32_combine(entry.crc, crc32_parallel(block.iov_base, block.iov_len), block.iov_len);
+            } else {
+                entry.crc = crc32(block.iov_base, block.iov_len, entry.crc);
+            }
+            entry.size += block.iov_len;
+        }
+        if (offset + entry.size + 30 + entry.name.size() + 128 > UINT32_MAX) {
+            throw std::runtime_error("Cannot add array " + name + ": npz archives are limited to 4 GiB");
+        }
+
+        size_t padding = (64 - (offset + 30 + entry.name.size()) % 64) % 64;
+        if (padding > 0 && padding < 4) {
+            padding += 64;
+        }
+        std::string local;
+        npz_put(local, NPZ_LOCAL, 4);
+        npz_put(local, 20, 2); // version needed to extract
+        npz_put(local, 0, 2); // flags
+        npz_put(local, 0, 2); // stored, no compression
+        npz_put(local, 0, 2); // time
+        npz_put(local, 0x21, 2); // date, 1980-01-01
+        npz_put(local, entry.crc, 4);
+        npz_put(local, entry.size, 4);
+        npz_put(local, entry.size, 4);
+        npz_put(local, entry.name.size(), 2);
+        npz_put(local, padding, 2);
+        local += entry.name;
+        if (padding > 0) {
+            npz_put(local, NPZ_ALIGNMENT, 2);
+            npz_put(local, padding - 4, 2);
+            local.append(padding - 4, '\0');
+        }
+
+        iovec first;
+        first.iov_base = const_cast<char*>(local.data());
+        first.iov_len = local.size();
+        blocks.insert(blocks.begin(), first);
+        npy_write(fd, blocks, _path);
+        offset += local.size() + entry.size;
+        entries.push_back(entry);
+    }
+
+    /**
+     * Adds tiled matrix, stored in C order.
+     */
+    template<class T, int SIZE>
+    void add(const std::string& name, const Matrix<T, Tiled<SIZE>>& m) {
+        add(name, m.template to_layout<RowMajor>());
+    }
+
+    /**
+     * Writes the central directory and closes the archive. Called by the destructor if not called before,
+     * which ignores errors.
+     */
+    void close() {
+        if (fd < 0) {
+            return;
+        }
+
+        std::string directory;
+        for (const Entry& entry : entries) {
+            npz_put(directory, NPZ_CENTRAL, 4);
+            npz_put(directory, 20, 2); // version made by
+            npz_put(directory, 20, 2); // version needed to extract
+            npz_put(directory, 0, 2); // flags
+            npz_put(directory, 0, 2); // stored
+            npz_put(directory, 0, 2); // time
+            npz_put(directory, 0x21, 2); // date
+            npz_put(directory, entry.crc, 4);
+            npz_put(directory, entry.size, 4);
+            npz_put(directory, entry.size, 4);
+            npz_put(directory, entry.name.size(), 2);
+            npz_put(directory, 0, 2); // extra field
+            npz_put(directory, 0, 2); // comment
+            npz_put(directory, 0, 2); // disk
+            npz_put(directory, 0, 2); // internal attributes
+            npz_put(directory, 0, 4); // external attributes
+            npz_put(directory, entry.offset, 4);
+            directory += entry.name;
+        }
+        size_t size = directory.size();
+        npz_put(directory, NPZ_END, 4);
+        npz_put(directory, 0, 2); // this disk
+        npz_put(directory, 0, 2); // disk with the directory
+        npz_put(directory, entries.size(), 2);
+        npz_put(directory, entries.size(), 2);
+        npz_put(directory, size, 4);
+        npz_put(directory, offset, 4);
+        npz_put(directory, 0, 2); // comment
+
+        int file = fd;
+        fd = -1;
+        try {
+            iovec block;
+            block.iov_base = const_cast<char*>(directory.data());
+            block.iov_len = directory.size();
+            npy_write(file, std::vector<iovec>(1, block), _path);
+        } catch (...) {
+            ::close(file);
+            throw;
+        }
+        if (::close(file) != 0) {
+            throw std::runtime_error("Cannot write file " + _path);
+        }
+    }
+
+    NpzWriter(NpzWriter&& rvalue) : _path(std::move(rvalue._path)), fd(rvalue.fd), offset(rvalue.offset),
+                                    entries(std::move(rvalue.entries)) {
+        rvalue.fd = -1;
+    }
+
+    NpzWriter(const NpzWriter&) = delete;
+
+    ~NpzWriter() {
+        try {
+            close();
+        } catch (...) {
+        }
+    }
+
+private:
+    struct Entry {
+        std::string name;
+        size_t offset;
+        size_t size;
+        uint32_t crc;
+    };
+
+    std::string _path;
+    int fd;
+    size_t offset;
+    std::vector<Entry> entries;
+
+    NpzWriter(const std::string& path, int fd) : _path(path), fd(fd), offset(0) {}
+};
+
+/**
+ * Uncompressed .npz archive mapped into memory. Arrays are loaded without copying like with load_npy and
+ * keep the mapping alive, so they can outlive the archive. Checksums are not verified, which would read
+ * every array. Compressed archives (numpy.savez_compressed) are not supported.
+ */
+class NpzArchive {
+
+public:
+
+    static NpzArchive open(const std::string& path) {
+        return NpzArchive(path, std::make_shared<FileMapping>(path));
+    }
+
+    /**
+     * Returns names of the arrays, in the order they are stored.
+     */
+    std::vector<std::string> names() const {
+        std::vector<std::string> result;
+        for (const Entry& entry : entries) {
+            result.push_back(entry.name);
+        }
+        return result;
+    }
+
+    bool contains(const std::string& name) const {
+        return find(name) != nullptr;
+    }
+
+    /**
+     * Loads array called name, see load_npy.
+     */
+    template<class T, class Layout = RowMajor>
+    Matrix<T, Layout> load(const std::string& name) const {
+        const Entry* entry = find(name);
+        if (entry == nullptr) {
+            throw std::runtime_error("Cannot load array " + name + " from " + _path + ": no such array");
+        }
+        if (entry->compressed) {
+            throw std::runtime_error("Cannot load array " + name + " from " + _path + ": archive is compressed");
+        }
+        return npy_load<T, Layout>(mapping, entry->offset, entry->size);
+    }
+
+private:
+    struct Entry {
+        std::string name;
+        size_t offset;
+        size_t size;
+        bool compressed;
+    };
+
+    std::string _path;
+    std::shared_ptr<FileMapping> mapping;
+    std::vector<Entry> entries;
+
+    NpzArchive(const std::string& path, const std::shared_ptr<FileMapping>& mapping) : _path(path), mapping(mapping) {
+        const char* bytes = mapping->bytes();
+        size_t length = mapping->length;
+
+        // end of central directory record is followed only by a comment of up to 64 KiB
+        if (length < 22) {
+            throw std::runtime_error("Cannot open npz archive " + path + ": not a zip file");
+        }
+        size_t end = length - 22;
+        size_t last = end > 65535 ? end - 65535 : 0;
+        while (npz_get(bytes + end, 4) != NPZ_END) {
+            if (end == last) {
+                throw std::runtime_error("Cannot open npz archive " + path + ": not a zip file");
+            }
+            --end;
+        }
+
+        size_t count = npz_get(bytes + end + 10, 2);
+        size_t position = npz_get(bytes + end + 16, 4);
+        for (size_t i = 0; i < count; ++i) {
+            if (position + 46 > end || npz_get(bytes + position, 4) != NPZ_CENTRAL) {
+                throw std::runtime_error("Cannot open npz archive " + path + ": damaged directory");
+            }
+            size_t method = npz_get(bytes + position + 10, 2);
+            size_t size = npz_get(bytes + position + 20, 4);
+            size_t name_length = npz_get(bytes + position + 28, 2);
+            size_t extra_length = npz_get(bytes + position + 30, 2);
+            size_t comment_length = npz_get(bytes + position + 32, 2);
+            size_t local = npz_get(bytes + position + 42, 4);
+            if (size == UINT32_MAX || local == UINT32_MAX) {
+                throw std::runtime_error("Cannot open npz archive " + path + ": zip64 is not supported");
+            }
+
+            Entry entry;
+            entry.name = std::string(bytes + position + 46, std::min(name_length, end - position - 46));
+            if (entry.name.size() > 4 && entry.name.compare(entry.name.size() - 4, 4, ".npy") == 0) {
+                entry.name.resize(entry.name.size() - 4);
+            }
+            entry.compressed = method != 0;
+            entry.size = size;
+            if (local + 30 > length || npz_get(bytes + local, 4) != NPZ_LOCAL) {
+                throw std::runtime_error("Cannot open npz archive " + path + ": damaged entry " + entry.name);
+            }
+            entry.offset = local + 30 + npz_get(bytes + local + 26, 2) + npz_get(bytes + local + 28, 2);
+            if (entry.offset + entry.size > length) {
+                throw std::runtime_error("Cannot open npz archive " + path + ": damaged entry " + entry.name);
+            }
+            entries.push_back(entry);
+            position += 46 + name_length + extra_length + comment_length;
+        }
+    }
+
+    const Entry* find(const std::string& name) const {
+        for (const Entry& entry : entries) {
+            if (entry.name == name) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+};
+
+/**
+ * Loads single array called name from .npz archive.
+ */
+template<class T, class Layout = RowMajor>
+Matrix<T, Layout> load_npz(const std::string& path, const std::string& name) {
+    return NpzArchive::open(path).load<T, Layout>(name);
+}
+
+#endif
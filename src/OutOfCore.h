@@ -0,0 +1,521 @@
+#ifndef _OUT_OF_CORE_H
+#define _OUT_OF_CORE_H
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include "Matrix.h"
+#include "MappedMatrix.h"
+#include "Async.h"
+
+/**
+ * Row-major matrix file (the format of MappedMatrix) accessed with explicit reads and writes of rectangular
+ * blocks instead of mapping, so that streaming through it does not fill the page cache.
+ */
+template<class T>
+class TileFile {
+public:
+
+    /**
+     * Creates (or truncates) file holding MxN matrix filled with zeros.
+     */
+    static TileFile create(const std::string& path, int rows, int cols) {
+        MappedMatrix<T>::create(path, rows, cols);
+        return open(path, true);
+    }
+
+    static TileFile open(const std::string& path, bool writable = false) {
+        int fd = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open file " + path);
+        }
+
+        try {
+            return TileFile(path, fd, MappedMatrix<T>::read_header(fd, path));
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+    }
+
+    int rows() const {
+        return _rows;
+    }
+
+    int cols() const {
+        return _cols;
+    }
+
+    const std::string& path() const {
+        return _path;
+    }
+
+    /**
+     * Reads block of given size with top left corner at (row, col) into buffer with rows buffer_stride
+     * elements apart. Safe to call concurrently for different blocks.
+     */
+    void read(int row, int col, int rows, int cols, T* buffer, int buffer_stride) const {
+        check_block(row, col, rows, cols);
+        if (cols == _stride && buffer_stride == _stride) {
+            transfer(false, buffer, static_cast<size_t>(rows) * cols, offset(row, col));
+            return;
+        }
+        for (int i = 0; i < rows; ++i) {
+            transfer(false, buffer + static_cast<size_t>(i) * buffer_stride, cols, offset(row + i, col));
+        }
+    }
+
+    /**
+     * Writes block of given size from buffer to the file at (row, col), see read.
+     */
+    void write(int row, int col, int rows, int cols, const T* buffer, int buffer_stride) const {
+        check_block(row, col, rows, cols);
+        for (int i = 0; i < rows; ++i) {
+            transfer(true, const_cast<T*>(buffer) + static_cast<size_t>(i) * buffer_stride, cols,
+                     offset(row + i, col));
+        }
+    }
+
+    TileFile(TileFile&& rvalue) : _path(std::move(rvalue._path)), fd(rvalue.fd), _rows(rvalue._rows),
+                                  _cols(rvalue._cols), _stride(rvalue._stride), data_offset(rvalue.data_offset) {
+        rvalue.fd = -1;
+    }
+
+    TileFile(const TileFile&) = delete;
+
+    ~TileFile() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+private:
+    std::string _path;
+    int fd;
+    int _rows, _cols, _stride;
+    uint64_t data_offset;
+
+    TileFile(const std::string& path, int fd, const MappedHeader& header)
+            : _path(path), fd(fd), _rows(static_cast<int>(header.rows)), _cols(static_cast<int>(header.cols)),
+              _stride(static_cast<int>(header.stride)), data_offset(header.data_offset) {}
+
+    void check_block(int row, int col, int rows, int cols) const {
+        if (row <= 0 || col <= 0 || rows < 0 || cols < 0 || row + rows - 1 > _rows || col + cols - 1 > _cols) {
+            throw std::runtime_error("Invalid block access");
+        }
+    }
+
+    off_t offset(int row, int col) const {
+        return static_cast<off_t>(data_offset + (static_cast<uint64_t>(row - 1) * _stride + (col - 1)) * sizeof(T));
+    }
+
+    /**
+     * Reads or writes count elements at the offset, retrying partial transfers.
+     */
+    void transfer(bool writing, T* buffer, size_t count, off_t position) const {
+        char* bytes = reinterpret_cast<char*>(buffer);
+        size_t remaining = count * sizeof(T);
+        while (remaining > 0) {
+            ssize_t done = writing ? pwrite(fd, bytes, remaining, position) : pread(fd, bytes, remaining, position);
+            if (done <= 0) {
+                throw std::runtime_error(std::string(writing ? "Cannot write file " : "Cannot read file ") + _path);
+            }
+            bytes += done;
+            remaining -= static_cast<size_t>(done);
+            position += done;
+        }
+    }
+};
+
+/**
+ * Algorithms on matrix files larger than memory, keeping at most memory_budget bytes of elements
+ * in memory. Blocks are streamed from disk in a pipeline: the next block is read on the thread pool
+ * while the current one is being computed on, in the other of two buffers.
+ */
+template<class T>
+class OutOfCore {
+public:
+
+    explicit OutOfCore(size_t memory_budget) : budget(memory_budget) {}
+
+    size_t memory_budget() const {
+        return budget;
+    }
+
+    /**
+     * Returns side of square tiles used by multiply: two buffers for tiles of each operand and of the result.
+     */
+    int tile_size() const {
+        return static_cast<int>(std::sqrt(static_cast<double>(budget / (6 * sizeof(T)))));
+    }
+
+    /**
+     * Returns number of columns of panels used by lu for NxN matrix: panel being factorized and two
+     * buffers for previous panels.
+     */
+    int panel_width(int size) const {
+        return static_cast<int>(std::min<size_t>(size, budget / (3 * sizeof(T) * size)));
+    }
+
+    /**
+     * Multiplies matrices stored in files a and b, writing the product to a new file c. The result is
+     * computed tile by tile, every tile of c accumulates products of a row of tiles of a and a column
+     * of tiles of b streamed from disk; finished tiles are written back while the next one is computed.
+     */
+    void multiply(const std::string& a, const std::string& b, const std::string& c) const {
+        TileFile<T> left = TileFile<T>::open(a);
+        TileFile<T> right = TileFile<T>::open(b);
+        if (left.cols() != right.rows()) {
+            throw std::runtime_error("Cannot multiply matrices with mismatching dimensions");
+        }
+        int tile = tile_size();
+        if (tile < 1) {
+            throw std::runtime_error("Cannot fit tiles in memory budget");
+        }
+        tile = std::min(tile, std::max(left.rows(), std::max(left.cols(), right.cols())));
+        TileFile<T> result = TileFile<T>::create(c, left.rows(), right.cols());
+
+        int tile_rows = blocks(left.rows(), tile), tile_cols = blocks(right.cols(), tile);
+        int inner = blocks(left.cols(), tile);
+        std::vector<Matrix<T> > as, bs, cs;
+        as.reserve(2);
+        bs.reserve(2);
+        cs.reserve(2);
+        for (int i = 0; i < 2; ++i) {
+            as.push_back(Matrix<T>::zeros(tile, tile));
+            bs.push_back(Matrix<T>::zeros(tile, tile));
+            cs.push_back(Matrix<T>::zeros(tile, tile));
+        }
+
+        // step s multiplies tile (i, k) of a by tile (k, j) of b, into tile s / inner of c
+        auto extent = [tile](int index, int size) {
+            return std::min(tile, size - index * tile);
+        };
+        auto write_tile = [&](int step) {
+            int number = step / inner, i = number / tile_cols, j = number % tile_cols;
+            const Matrix<T>& source = cs[number % 2];
+            result.write(i * tile + 1, j * tile + 1, extent(i, left.rows()), extent(j, right.cols()),
+                         source.row_data(1), source.stride());
+        };
+        auto last_of_tile = [inner](int step) {
+            return step % inner == inner - 1;
+        };
+
+        int steps = tile_rows * tile_cols * inner;
+        pipeline(steps, [&](int step) {
+            // tile finished two steps ago is complete and its buffer is not used by the running step
+            if (step >= 2 && last_of_tile(step - 2)) {
+                write_tile(step - 2);
+            }
+            int number = step / inner, i = number / tile_cols, j = number % tile_cols, k = step % inner;
+            Matrix<T>& ta = as[step % 2];
+            Matrix<T>& tb = bs[step % 2];
+            left.read(i * tile + 1, k * tile + 1, extent(i, left.rows()), extent(k, left.cols()),
+                      ta.row_data(1), ta.stride());
+            right.read(k * tile + 1, j * tile + 1, extent(k, left.cols()), extent(j, right.cols()),
+                       tb.row_data(1), tb.stride());
+        }, [&](int step) {
+            int number = step / inner, i = number / tile_cols, j = number % tile_cols, k = step % inner;
+            Matrix<T>& tc = cs[number % 2];
+            if (k == 0) {
+                // not multiplied by zero, which would keep NaN and inf of the previous tile
+                for (int r = 1; r <= tile; ++r) {
+                    std::fill(tc.row_data(r), tc.row_data(r) + tile, T(0));
+                }
+            }
+            multiply_add(as[step % 2], bs[step % 2], tc, extent(i, left.rows()), extent(k, left.cols()),
+                         extent(j, right.cols()));
+        });
+
+        for (int step = std::max(0, steps - 2); step < steps; ++step) {
+            if (last_of_tile(step)) {
+                write_tile(step);
+            }
+        }
+    }
+
+    /**
+     * Factorizes square matrix stored in file in place with partial pivoting, PA = LU, and returns pivots:
+     * row i was interchanged with row pivots[i - 1]. Left-looking: panels of columns are factorized one by one,
+     * each first updated with all previous panels streamed from disk. Columns of L in a panel are stored
+     * in the row order from the time the panel was factorized, later interchanges are not applied to them;
+     * lu_solve accounts for that. Throws on singular matrix.
+     */
+    std::vector<int> lu(const std::string& path) const {
+        TileFile<T> file = TileFile<T>::open(path, true);
+        int n = file.rows();
+        if (n != file.cols()) {
+            throw std::runtime_error("Cannot factorize non-square matrix");
+        }
+        int width = panel_width(n);
+        if (width < 1) {
+            throw std::runtime_error("Cannot fit panels in memory budget");
+        }
+
+        std::vector<int> pivots(n);
+        Matrix<T> panel = Matrix<T>::zeros(n, width);
+        std::vector<Matrix<T> > streams;
+        streams.reserve(2);
+        streams.push_back(Matrix<T>::zeros(n, width));
+        streams.push_back(Matrix<T>::zeros(n, width));
+
+        int panels = blocks(n, width);
+        for (int p = 0; p < panels; ++p) {
+            int first = p * width, columns = std::min(width, n - first);
+            file.read(1, first + 1, n, columns, panel.row_data(1), panel.stride());
+
+            pipeline(p, [&](int q) {
+                read_panel(file, q, width, q * width, streams[q % 2]);
+            }, [&](int q) {
+                int start = q * width, count = std::min(width, n - start);
+                apply_interchanges(panel, pivots, start, count, columns);
+                update_panel(streams[q % 2], panel, start, count, columns, n);
+            });
+
+            factorize_panel(panel, pivots, first, columns, n);
+            file.write(1, first + 1, n, columns, panel.row_data(1), panel.stride());
+        }
+
+        for (int& pivot : pivots) {
+            ++pivot;
+        }
+        return pivots;
+    }
+
+    /**
+     * Solves AX = B using factorization of A computed by lu in the file.
+     */
+    Matrix<T> lu_solve(const std::string& path, const std::vector<int>& pivots, const Matrix<T>& b) const {
+        TileFile<T> file = TileFile<T>::open(path);
+        int n = file.rows();
+        if (b.rows() != n || static_cast<int>(pivots.size()) != n) {
+            throw std::runtime_error("Cannot solve system with mismatching dimensions");
+        }
+        int width = panel_width(n);
+        if (width < 1) {
+            throw std::runtime_error("Cannot fit panels in memory budget");
+        }
+
+        std::vector<int> rows(pivots);
+        for (int& row : rows) {
+            --row;
+        }
+        Matrix<T> x = b.clone();
+        std::vector<Matrix<T> > streams;
+        streams.reserve(2);
+        streams.push_back(Matrix<T>::zeros(n, width));
+        streams.push_back(Matrix<T>::zeros(n, width));
+        int panels = blocks(n, width), columns = x.cols();
+
+        // forward substitution with L, applying interchanges panel by panel like lu did
+        pipeline(panels, [&](int q) {
+            read_panel(file, q, width, q * width, streams[q % 2]);
+        }, [&](int q) {
+            int start = q * width, count = std::min(width, n - start);
+            apply_interchanges(x, rows, start, count, columns);
+            update_panel(streams[q % 2], x, start, count, columns, n);
+        });
+
+        // backward substitution with U, panels from the last one, rows from the top to the diagonal block
+        pipeline(panels, [&](int s) {
+            read_panel(file, panels - 1 - s, width, 0, streams[s % 2]);
+        }, [&](int s) {
+            int start = (panels - 1 - s) * width, count = std::min(width, n - start);
+            const Matrix<T>& u = streams[s % 2];
+            for (int j = count - 1; j >= 0; --j) {
+                T* target = x.row_data(start + j + 1);
+                T diagonal = u.row_data(start + j + 1)[j];
+                for (int c = 0; c < columns; ++c) {
+                    target[c] /= diagonal;
+                }
+                for (int i = 0; i < j; ++i) {
+                    T factor = u.row_data(start + i + 1)[j];
+                    T* row = x.row_data(start + i + 1);
+                    for (int c = 0; c < columns; ++c) {
+                        row[c] -= factor * target[c];
+                    }
+                }
+            }
+            subtract_products(u, x, start, count, 0, start, columns);
+        });
+        return x;
+    }
+
+    /**
+     * Solves AX = B for A stored in file, which is overwritten by its LU factorization.
+     */
+    Matrix<T> solve(const std::string& path, const Matrix<T>& b) const {
+        std::vector<int> pivots = lu(path);
+        return lu_solve(path, pivots, b);
+    }
+
+private:
+    size_t budget;
+
+    static const int PARALLEL_THRESHOLD = 1 << 15;
+
+    static int blocks(int size, int block) {
+        return (size + block - 1) / block;
+    }
+
+    /**
+     * Runs load(step) for steps 0..count-1 on the thread pool one step ahead of compute(step) on the calling
+     * thread, so loads overlap computation. Loads and computations using the same buffers must use
+     * different ones for consecutive steps.
+     */
+    template<class Load, class Compute>
+    static void pipeline(int count, Load load, Compute compute) {
+        if (count <= 0) {
+            return;
+        }
+
+        Future<int> loaded = async_call([&load]() {
+            load(0);
+            return 0;
+        });
+        for (int step = 0; step < count; ++step) {
+            loaded.get();
+            bool more = step + 1 < count;
+            if (more) {
+                int next = step + 1;
+                loaded = async_call([&load, next]() {
+                    load(next);
+                    return 0;
+                });
+            }
+            try {
+                compute(step);
+            } catch (...) {
+                // the running load writes to a buffer that is about to be destroyed
+                if (more) {
+                    loaded.wait();
+                }
+                throw;
+            }
+        }
+    }
+
+    /**
+     * Reads rows from first_row (0-based) to the end of panel number q into buffer.
+     */
+    static void read_panel(const TileFile<T>& file, int q, int width, int first_row, Matrix<T>& buffer) {
+        int n = file.rows(), start = q * width;
+        file.read(first_row + 1, start + 1, n - first_row, std::min(width, n - start),
+                  buffer.row_data(first_row + 1), buffer.stride());
+    }
+
+    /**
+     * Applies interchanges of rows start..start+count-1 (0-based pivots) to the first columns of target.
+     */
+    static void apply_interchanges(Matrix<T>& target, const std::vector<int>& pivots, int start, int count,
+                                   int columns) {
+        for (int j = start; j < start + count; ++j) {
+            if (pivots[j] != j) {
+                T* row = target.row_data(j + 1);
+                std::swap_ranges(row, row + columns, target.row_data(pivots[j] + 1));
+            }
+        }
+    }
+
+    /**
+     * Updates target with the panel of L in columns start..start+count-1 of source (stored from row start):
+     * solves rows of the diagonal block with unit lower triangular L and subtracts their products with L
+     * from the rows below.
+     */
+    static void update_panel(const Matrix<T>& source, Matrix<T>& target, int start, int count, int columns,
+                             int n) {
+        for (int j = 0; j < count; ++j) {
+            const T* pivot = target.row_data(start + j + 1);
+            for (int i = j + 1; i < count; ++i) {
+                T factor = source.row_data(start + i + 1)[j];
+                T* row = target.row_data(start + i + 1);
+                for (int c = 0; c < columns; ++c) {
+                    row[c] -= factor * pivot[c];
+                }
+            }
+        }
+        subtract_products(source, target, start, count, start + count, n, columns);
+    }
+
+    /**
+     * For rows from..to-1 (0-based) computes target[r] -= sum of source[r][j] * target[start + j] over
+     * j < count, source holding a panel with rows at their places in the matrix. Rows are processed
+     * in parallel.
+     */
+    static void subtract_products(const Matrix<T>& source, Matrix<T>& target, int start, int count,
+                                  int from, int to, int columns) {
+        int grain = std::max(1, PARALLEL_THRESHOLD / std::max(1, count * columns));
+        parallel_for(from, to, grain, [&](int begin, int end) {
+            for (int r = begin; r < end; ++r) {
+                const T* factors = source.row_data(r + 1);
+                T* row = target.row_data(r + 1);
+                for (int j = 0; j < count; ++j) {
+                    T factor = factors[j];
+                    const T* pivot = target.row_data(start + j + 1);
+                    for (int c = 0; c < columns; ++c) {
+                        row[c] -= factor * pivot[c];
+                    }
+                }
+            }
+        });
+    }
+
+    /**
+     * Factorizes rows first..n-1 of the panel with partial pivoting, recording pivots of its columns.
+     */
+    static void factorize_panel(Matrix<T>& panel, std::vector<int>& pivots, int first, int columns, int n) {
+        for (int j = 0; j < columns; ++j) {
+            int diagonal = first + j, best = diagonal;
+            for (int r = diagonal + 1; r < n; ++r) {
+                if (std::abs(panel.row_data(r + 1)[j]) > std::abs(panel.row_data(best + 1)[j])) {
+                    best = r;
+                }
+            }
+            if (panel.row_data(best + 1)[j] == T(0)) {
+                throw std::runtime_error("Cannot factorize singular matrix");
+            }
+            pivots[diagonal] = best;
+            if (best != diagonal) {
+                T* row = panel.row_data(diagonal + 1);
+                std::swap_ranges(row, row + columns, panel.row_data(best + 1));
+            }
+
+            const T* pivot = panel.row_data(diagonal + 1);
+            int grain = std::max(1, PARALLEL_THRESHOLD / columns);
+            parallel_for(diagonal + 1, n, grain, [&](int begin, int end) {
+                for (int r = begin; r < end; ++r) {
+                    T* row = panel.row_data(r + 1);
+                    row[j] /= pivot[j];
+                    for (int c = j + 1; c < columns; ++c) {
+                        row[c] -= row[j] * pivot[c];
+                    }
+                }
+            });
+        }
+    }
+
+    /**
+     * Computes c += a * b for the leading rows x inner and inner x cols blocks of tiles, rows of c
+     * in parallel.
+     */
+    static void multiply_add(const Matrix<T>& a, const Matrix<T>& b, Matrix<T>& c, int rows, int inner, int cols) {
+        int grain = std::max(1, PARALLEL_THRESHOLD / std::max(1, inner * cols));
+        parallel_for(1, rows + 1, grain, [&](int begin, int end) {
+            for (int i = begin; i < end; ++i) {
+                const T* factors = a.row_data(i);
+                T* target = c.row_data(i);
+                for (int k = 0; k < inner; ++k) {
+                    T factor = factors[k];
+                    const T* source = b.row_data(k + 1);
+                    for (int j = 0; j < cols; ++j) {
+                        target[j] += factor * source[j];
+                    }
+                }
+            }
+        });
+    }
+};
+
+#endif
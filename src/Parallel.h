@@ -0,0 +1,563 @@
+#ifndef _PARALLEL_H
+#define _PARALLEL_H
+
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+
+/**
+ * Unit of work executed by the scheduler. Tasks are owned by the scheduler once submitted
+ * and deleted after they run.
+ */
+class ParallelTask {
+public:
+    virtual ~ParallelTask() {}
+
+    virtual void run() = 0;
+};
+
+/**
+ * Chase-Lev work-stealing deque. The owning thread pushes and takes tasks at the bottom, any other thread
+ * may steal from the top. Memory orderings follow "Correct and Efficient Work-Stealing for Weak Memory
+ * Models" (Le et al., 2013). Buffers replaced by growth are kept until the deque is destroyed, because
+ * a thief may still be reading them.
+ */
+class WorkStealingDeque {
+public:
+
+    WorkStealingDeque() : top(0), bottom(0), buffer(new Buffer(64)) {
+        retired.push_back(std::unique_ptr<Buffer>(buffer.load(std::memory_order_relaxed)));
+    }
+
+    /**
+     * Pushes a task, owner only.
+     */
+    void push(ParallelTask* task) {
+        long b = bottom.load(std::memory_order_relaxed);
+        long t = top.load(std::memory_order_acquire);
+        Buffer* current = buffer.load(std::memory_order_relaxed);
+        if (b - t > static_cast<long>(current->capacity) - 1) {
+            current = grow(current, t, b);
+        }
+        current->put(b, task);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Takes the most recently pushed task, owner only. Returns nullptr if empty.
+     */
+    ParallelTask* take() {
+        long b = bottom.load(std::memory_order_relaxed) - 1;
+        Buffer* current = buffer.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long t = top.load(std::memory_order_relaxed);
+
+        ParallelTask* task = nullptr;
+        if (t <= b) {
+            task = current->get(b);
+            if (t == b) {
+                // last element, race against thieves
+                if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    task = nullptr;
+                }
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+        } else {
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return task;
+    }
+
+    /**
+     * Steals the oldest task, any thread. Returns nullptr if empty or if another thread won the race.
+     */
+    ParallelTask* steal() {
+        long t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long b = bottom.load(std::memory_order_acquire);
+
+        if (t < b) {
+            Buffer* current = buffer.load(std::memory_order_acquire);
+            ParallelTask* task = current->get(t);
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                return nullptr;
+            }
+            return task;
+        }
+        return nullptr;
+    }
+
+private:
+
+    struct Buffer {
+        size_t capacity;
+        std::unique_ptr<std::atomic<ParallelTask*>[]> slots;
+
+        explicit Buffer(size_t capacity) : capacity(capacity), slots(new std::atomic<ParallelTask*>[capacity]) {}
+
+        ParallelTask* get(long index) const {
+            return slots[static_cast<size_t>(index) & (capacity - 1)].load(std::memory_order_relaxed);
+        }
+
+        void put(long index, ParallelTask* task) {
+            slots[static_cast<size_t>(index) & (capacity - 1)].store(task, std::memory_order_relaxed);
+        }
+    };
+
+    std::atomic<long> top, bottom;
+    std::atomic<Buffer*> buffer;
+    std::vector<std::unique_ptr<Buffer> > retired;
+
+    Buffer* grow(Buffer* current, long t, long b) {
+        Buffer* bigger = new Buffer(current->capacity * 2);
+        for (long i = t; i < b; ++i) {
+            bigger->put(i, current->get(i));
+        }
+        retired.push_back(std::unique_ptr<Buffer>(bigger));
+        buffer.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+};
+
+/**
+ * Process-wide work-stealing scheduler. Every worker owns a deque; tasks spawned by a worker go to its own
+ * deque, tasks submitted from other threads go to a shared injection queue. Idle workers steal from random
+ * victims and sleep when there is nothing to do. Threads waiting for their tasks help executing work
+ * instead of blocking, so nested parallel sections do not deadlock.
+ */
+class ParallelScheduler {
+public:
+
+    /**
+     * Returns the global scheduler, created on first use. Only creation takes a lock, afterwards the
+     * scheduler is read from an atomic pointer.
+     */
+    static ParallelScheduler& instance() {
+        ParallelScheduler* current = published().load(std::memory_order_acquire);
+        if (current != nullptr) {
+            return *current;
+        }
+
+        std::lock_guard<std::mutex> lock(instance_mutex());
+        std::unique_ptr<ParallelScheduler>& scheduler = instance_pointer();
+        if (!scheduler) {
+            scheduler.reset(new ParallelScheduler(default_threads()));
+            published().store(scheduler.get(), std::memory_order_release);
+        }
+        return *scheduler;
+    }
+
+    /**
+     * Replaces the global scheduler with one running the given number of threads (including the calling
+     * thread). Tasks already submitted to the old scheduler, including background jobs behind futures, are
+     * finished first; work started afterwards goes to the new one. The old scheduler is stopped but kept,
+     * as threads may still hold references to it. Cannot be called from a parallel task.
+     */
+    static void reset(int threads) {
+        std::unique_ptr<ParallelScheduler> previous;
+        {
+            std::lock_guard<std::mutex> lock(instance_mutex());
+            std::unique_ptr<ParallelScheduler>& scheduler = instance_pointer();
+            if (scheduler && scheduler->on_worker_thread()) {
+                throw std::runtime_error("Cannot change number of threads from a parallel task");
+            }
+            previous = std::move(scheduler);
+            scheduler.reset(new ParallelScheduler(std::max(1, threads)));
+            published().store(scheduler.get(), std::memory_order_release);
+        }
+        if (!previous) {
+            return;
+        }
+
+        // without the lock, as tasks may look up the scheduler themselves
+        ParallelScheduler* old = previous.get();
+        old->help_until([old]() {
+            return old->unfinished.load(std::memory_order_acquire) == 0;
+        });
+        old->stop();
+        std::lock_guard<std::mutex> lock(instance_mutex());
+        retired_schedulers().push_back(std::move(previous));
+    }
+
+    ~ParallelScheduler() {
+        stop();
+        for (std::unique_ptr<WorkStealingDeque>& deque : deques) {
+            while (ParallelTask* task = deque->take()) {
+                delete task;
+            }
+        }
+        for (ParallelTask* task : injected) {
+            delete task;
+        }
+    }
+
+    /**
+     * Returns number of threads taking part in parallel loops, including the calling thread.
+     */
+    int threads() const {
+        return _threads;
+    }
+
+    /**
+     * Checks if the calling thread is one of the workers of this scheduler.
+     */
+    bool on_worker_thread() const {
+        return current_worker(this) >= 0;
+    }
+
+    /**
+     * Schedules a task. Ownership passes to the scheduler.
+     */
+    void submit(ParallelTask* task) {
+        int index = current_worker(this);
+        if (index >= 0) {
+            deques[index]->push(task);
+        } else {
+            std::lock_guard<std::mutex> lock(injected_mutex);
+            injected.push_back(task);
+        }
+        unfinished.fetch_add(1, std::memory_order_release);
+        // sequentially consistent with going to sleep in work: either the worker sees the task,
+        // or this thread sees the worker sleeping and wakes it
+        pending.fetch_add(1, std::memory_order_seq_cst);
+        if (sleeping.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            wakeup.notify_one();
+        }
+    }
+
+    /**
+     * Executes available tasks on the calling thread until done() returns true.
+     */
+    template<class Predicate>
+    void help_until(Predicate done) {
+        int spins = 0;
+        while (!done()) {
+            if (run_one(current_worker(this))) {
+                spins = 0;
+            } else if (++spins > 64) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+
+    int _threads;
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<WorkStealingDeque> > deques;
+    std::deque<ParallelTask*> injected;
+    std::mutex injected_mutex;
+    std::mutex sleep_mutex;
+    std::condition_variable wakeup;
+    // tasks waiting in queues, and tasks submitted but not finished yet
+    std::atomic<long> pending;
+    std::atomic<long> unfinished;
+    std::atomic<int> sleeping;
+    bool stopping;
+
+    // one worker is always started, so that submitted tasks run in background even when loops are serial
+    explicit ParallelScheduler(int threads)
+            : _threads(threads), pending(0), unfinished(0), sleeping(0), stopping(false) {
+        int count = std::max(1, threads - 1);
+        for (int i = 0; i < count; ++i) {
+            deques.push_back(std::unique_ptr<WorkStealingDeque>(new WorkStealingDeque()));
+        }
+        for (int i = 0; i < count; ++i) {
+            workers.push_back(std::thread([this, i]() { work(i); }));
+        }
+    }
+
+    static std::mutex& instance_mutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    // owner of the global scheduler, changed only under instance_mutex
+    static std::unique_ptr<ParallelScheduler>& instance_pointer() {
+        static std::unique_ptr<ParallelScheduler> scheduler;
+        return scheduler;
+    }
+
+    // the global scheduler as seen by instance() without locking
+    static std::atomic<ParallelScheduler*>& published() {
+        static std::atomic<ParallelScheduler*> scheduler(nullptr);
+        return scheduler;
+    }
+
+    static std::vector<std::unique_ptr<ParallelScheduler> >& retired_schedulers() {
+        static std::vector<std::unique_ptr<ParallelScheduler> > retired;
+        return retired;
+    }
+
+    /**
+     * Stops and joins the workers, tasks left in queues are not run.
+     */
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            stopping = true;
+        }
+        wakeup.notify_all();
+        for (std::thread& worker : workers) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    }
+
+    static int default_threads() {
+        unsigned hardware = std::thread::hardware_concurrency();
+        return hardware == 0 ? 1 : static_cast<int>(hardware);
+    }
+
+    /**
+     * Index of the worker running on this thread in the given scheduler, -1 for other threads.
+     */
+    static int& worker_slot() {
+        static thread_local int index = -1;
+        return index;
+    }
+
+    static ParallelScheduler*& worker_owner() {
+        static thread_local ParallelScheduler* owner = nullptr;
+        return owner;
+    }
+
+    static int current_worker(const ParallelScheduler* scheduler) {
+        return worker_owner() == scheduler ? worker_slot() : -1;
+    }
+
+    ParallelTask* find_task(int self) {
+        if (self >= 0) {
+            if (ParallelTask* task = deques[self]->take()) {
+                return task;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(injected_mutex);
+            if (!injected.empty()) {
+                ParallelTask* task = injected.front();
+                injected.pop_front();
+                return task;
+            }
+        }
+
+        int count = static_cast<int>(deques.size());
+        if (count == 0) {
+            return nullptr;
+        }
+        static thread_local unsigned seed = static_cast<unsigned>(
+                std::hash<std::thread::id>()(std::this_thread::get_id()));
+        seed = seed * 1103515245u + 12345u;
+        int start = static_cast<int>((seed >> 8) % count);
+        for (int k = 0; k < count; ++k) {
+            int victim = (start + k) % count;
+            if (victim != self) {
+                if (ParallelTask* task = deques[victim]->steal()) {
+                    return task;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    bool run_one(int self) {
+        ParallelTask* task = find_task(self);
+        if (task == nullptr) {
+            return false;
+        }
+        pending.fetch_sub(1, std::memory_order_acq_rel);
+        task->run();
+        delete task;
+        unfinished.fetch_sub(1, std::memory_order_acq_rel);
+        return true;
+    }
+
+    void work(int index) {
+        worker_slot() = index;
+        worker_owner() = this;
+
+        while (true) {
+            int spins = 0;
+            while (spins < 256) {
+                if (run_one(index)) {
+                    spins = 0;
+                } else {
+                    ++spins;
+                    std::this_thread::yield();
+                }
+            }
+
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            if (stopping) {
+                return;
+            }
+            sleeping.fetch_add(1, std::memory_order_seq_cst);
+            wakeup.wait(lock, [this]() {
+                return stopping || pending.load(std::memory_order_seq_cst) > 0;
+            });
+            sleeping.fetch_sub(1, std::memory_order_acq_rel);
+            if (stopping) {
+                return;
+            }
+        }
+    }
+};
+
+/**
+ * Returns number of threads used by parallel operations.
+ */
+inline int parallel_threads() {
+    return ParallelScheduler::instance().threads();
+}
+
+/**
+ * Sets number of threads used by parallel operations, 1 makes every operation serial. Waits for tasks
+ * already submitted to finish, see ParallelScheduler::reset.
+ */
+inline void set_parallel_threads(int threads) {
+    ParallelScheduler::reset(threads);
+}
+
+template<class F>
+class ParallelFunctionTask : public ParallelTask {
+public:
+
+    explicit ParallelFunctionTask(F job) : job(std::move(job)) {}
+
+    void run() override {
+        job();
+    }
+
+private:
+    F job;
+};
+
+/**
+ * Runs job() on the scheduler in background and returns immediately. The job must not throw,
+ * use the functions from Async.h to get results and exceptions back.
+ */
+template<class F>
+void parallel_submit(F job) {
+    ParallelScheduler::instance().submit(new ParallelFunctionTask<F>(std::move(job)));
+}
+
+/**
+ * Shared state of one parallel_for call: elements left to process and the first exception thrown.
+ */
+struct ParallelGroup {
+    std::atomic<long> remaining;
+    std::atomic<bool> failed;
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    explicit ParallelGroup(long elements) : remaining(elements), failed(false) {}
+
+    void fail(std::exception_ptr exception) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!failed) {
+            error = exception;
+            failed = true;
+        }
+    }
+};
+
+/**
+ * Processes a range by splitting it lazily: the upper half is offered to thieves, the lower half
+ * is processed further on the current thread, until the range is not larger than grain.
+ */
+template<class F>
+void parallel_range(ParallelScheduler& scheduler, ParallelGroup& group, int begin, int end, int grain, F& body);
+
+template<class F>
+class ParallelRangeTask : public ParallelTask {
+public:
+
+    ParallelRangeTask(ParallelScheduler& scheduler, ParallelGroup& group, int begin, int end, int grain, F& body)
+            : scheduler(scheduler), group(group), begin(begin), end(end), grain(grain), body(body) {}
+
+    void run() override {
+        parallel_range(scheduler, group, begin, end, grain, body);
+    }
+
+private:
+    ParallelScheduler& scheduler;
+    ParallelGroup& group;
+    int begin, end, grain;
+    F& body;
+};
+
+template<class F>
+void parallel_range(ParallelScheduler& scheduler, ParallelGroup& group, int begin, int end, int grain, F& body) {
+    while (end - begin > grain) {
+        int middle = begin + (end - begin) / 2;
+        scheduler.submit(new ParallelRangeTask<F>(scheduler, group, middle, end, grain, body));
+        end = middle;
+    }
+
+    if (!group.failed.load(std::memory_order_relaxed)) {
+        try {
+            body(begin, end);
+        } catch (...) {
+            group.fail(std::current_exception());
+        }
+    }
+    group.remaining.fetch_sub(end - begin, std::memory_order_acq_rel);
+}
+
+/**
+ * Splits the range [begin, end) into contiguous chunks and calls body(from, to) for each of them. Chunks
+ * are distributed between threads of the work-stealing scheduler. Ranges not larger than grain are always
+ * processed serially on the calling thread; larger ones are cut into at most a few chunks per thread.
+ * The first exception thrown by body is rethrown to the caller after all chunks finish.
+ * Optional threads limits the number of chunks, and therefore threads, used by this call.
+ */
+template<class F>
+void parallel_for(int begin, int end, int grain, F body, int threads = 0) {
+    int length = end - begin;
+    if (length <= 0) {
+        return;
+    }
+
+    grain = std::max(grain, 1);
+    if (length <= grain) {
+        body(begin, end);
+        return;
+    }
+
+    ParallelScheduler& scheduler = ParallelScheduler::instance();
+    int available = scheduler.threads();
+    if (threads > 0) {
+        available = std::min(available, threads);
+    }
+    if (available <= 1) {
+        body(begin, end);
+        return;
+    }
+
+    // a few chunks per thread leave room for balancing without drowning in tiny tasks
+    int chunks = threads > 0 ? available : available * 4;
+    grain = std::max(grain, (length + chunks - 1) / chunks);
+
+    ParallelGroup group(length);
+    parallel_range(scheduler, group, begin, end, grain, body);
+    scheduler.help_until([&group]() {
+        return group.remaining.load(std::memory_order_acquire) == 0;
+    });
+
+    if (group.failed) {
+        std::rethrow_exception(group.error);
+    }
+}
+
+#endif
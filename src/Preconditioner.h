@@ -0,0 +1,441 @@
+#ifndef _PRECONDITIONER_H
+#define _PRECONDITIONER_H
+
+#include <stdexcept>
+#include <vector>
+#include <cmath>
+#include "Matrix.h"
+#include "Vector.h"
+#include "SparseMatrix.h"
+
+/**
+ * Base class of all preconditioners. A preconditioner approximates the operator A with some M that is cheap
+ * to invert. The expensive part (factorization, extraction of the diagonal etc.) happens once in setup(),
+ * then apply() can be called any number of times for the same operator.
+ * All preconditioners work on the sparse (CSR) representation internally, dense operators are compressed
+ * during setup, so zero elements of the dense matrix are not part of the pattern.
+ */
+template<class T>
+class Preconditioner {
+public:
+
+    virtual ~Preconditioner() {}
+
+    /**
+     * Prepares the preconditioner for the given square operator. Results are cached until next setup().
+     */
+    void setup(const Matrix<T>& a) {
+        setup(SparseMatrix<T>::from_dense(a));
+    }
+
+    /**
+     * Prepares the preconditioner for the given square sparse operator. Results are cached until next setup().
+     */
+    void setup(const SparseMatrix<T>& a) {
+        if (a.rows() != a.cols()) {
+            throw std::runtime_error("Cannot precondition non-square matrix");
+        }
+
+        _ready = false;
+        _size = a.rows();
+        factorize(a);
+        _ready = true;
+    }
+
+    /**
+     * Returns z = M^-1 r for a Nx1 residual r.
+     */
+    Matrix<T> apply(const Matrix<T>& r) const {
+        Vector<T> z = Vector<T>::from_matrix(r);
+        apply_in_place(z);
+        return z.to_matrix();
+    }
+
+    /**
+     * Returns z = M^-1 r.
+     */
+    Vector<T> apply(const Vector<T>& r) const {
+        Vector<T> z = r;
+        apply_in_place(z);
+        return z;
+    }
+
+    /**
+     * Overwrites r with M^-1 r.
+     */
+    void apply_in_place(Vector<T>& r) const {
+        if (!_ready) {
+            throw std::runtime_error("Preconditioner used before setup");
+        }
+        if (r.size() != _size) {
+            throw std::runtime_error("Incompatible dimensions");
+        }
+
+        solve_in_place(r.data());
+    }
+
+    /**
+     * Tells whether setup() was already called.
+     */
+    bool ready() const {
+        return _ready;
+    }
+
+    /**
+     * Returns the dimension of the operator this preconditioner was set up for.
+     */
+    int size() const {
+        return _size;
+    }
+
+protected:
+
+    Preconditioner() : _size(0), _ready(false) {}
+
+    /**
+     * Builds cached data from the operator.
+     */
+    virtual void factorize(const SparseMatrix<T>& a) = 0;
+
+    /**
+     * Overwrites the array of size() elements with M^-1 applied to it.
+     */
+    virtual void solve_in_place(T* z) const = 0;
+
+    /**
+     * Returns positions of diagonal elements in a.values(), throws if any of them is missing or zero.
+     */
+    static std::vector<int> diagonal_positions(const SparseMatrix<T>& a, const char* message) {
+        std::vector<int> positions(a.rows());
+        for (int i = 0; i < a.rows(); ++i) {
+            positions[i] = a.find(i, i);
+            if (positions[i] < 0 || a.values()[positions[i]] == 0) {
+                throw std::runtime_error(message);
+            }
+        }
+        return positions;
+    }
+
+    int _size;
+
+private:
+    bool _ready;
+};
+
+/**
+ * Jacobi (diagonal) preconditioner, M = diag(A).
+ */
+template<class T>
+class JacobiPreconditioner : public Preconditioner<T> {
+protected:
+
+    void factorize(const SparseMatrix<T>& a) override {
+        std::vector<int> diagonal = this->diagonal_positions(a, "Cannot use Jacobi preconditioner, zero on diagonal");
+        inverse_diagonal.resize(a.rows());
+        for (int i = 0; i < a.rows(); ++i) {
+            inverse_diagonal[i] = 1 / a.values()[diagonal[i]];
+        }
+    }
+
+    void solve_in_place(T* z) const override {
+        for (int i = 0; i < this->_size; ++i) {
+            z[i] *= inverse_diagonal[i];
+        }
+    }
+
+private:
+    std::vector<T> inverse_diagonal;
+};
+
+/**
+ * Symmetric successive over-relaxation preconditioner with relaxation factor 0 < omega < 2,
+ * M = omega / (2 - omega) * (D / omega + L) * (D / omega)^-1 * (D / omega + U).
+ */
+template<class T>
+class SSORPreconditioner : public Preconditioner<T> {
+public:
+
+    SSORPreconditioner(T omega = 1) : omega(omega), cached(SparseMatrix<T>::zeros(1, 1)) {
+        if (!(omega > 0 && omega < 2)) {
+            throw std::runtime_error("SSOR relaxation factor must be in (0, 2)");
+        }
+    }
+
+protected:
+
+    void factorize(const SparseMatrix<T>& a) override {
+        diagonal = this->diagonal_positions(a, "Cannot use SSOR preconditioner, zero on diagonal");
+        cached = a;
+    }
+
+    void solve_in_place(T* z) const override {
+        const std::vector<int>& offsets = cached.row_offsets();
+        const std::vector<int>& cols = cached.col_indices();
+        const std::vector<T>& values = cached.values();
+        int n = this->_size;
+
+        // (D / omega + L) y = r
+        for (int i = 0; i < n; ++i) {
+            T sum = z[i];
+            for (int k = offsets[i]; k < diagonal[i]; ++k) {
+                sum -= values[k] * z[cols[k]];
+            }
+            z[i] = sum * omega / values[diagonal[i]];
+        }
+
+        // y := (D / omega) y
+        for (int i = 0; i < n; ++i) {
+            z[i] *= values[diagonal[i]] / omega;
+        }
+
+        // (D / omega + U) z = y
+        for (int i = n - 1; i >= 0; --i) {
+            T sum = z[i];
+            for (int k = diagonal[i] + 1; k < offsets[i + 1]; ++k) {
+                sum -= values[k] * z[cols[k]];
+            }
+            z[i] = sum * omega / values[diagonal[i]];
+        }
+
+        for (int i = 0; i < n; ++i) {
+            z[i] *= (2 - omega) / omega;
+        }
+    }
+
+private:
+    T omega;
+    SparseMatrix<T> cached;
+    std::vector<int> diagonal;
+};
+
+/**
+ * Incomplete LU factorization with zero fill-in. L and U keep the sparsity pattern of A, L has unit diagonal
+ * and both are stored in one CSR matrix.
+ */
+template<class T>
+class ILU0Preconditioner : public Preconditioner<T> {
+public:
+
+    ILU0Preconditioner() : lu(SparseMatrix<T>::zeros(1, 1)) {}
+
+protected:
+
+    void factorize(const SparseMatrix<T>& a) override {
+        diagonal = this->diagonal_positions(a, "Cannot compute ILU(0), zero pivot");
+        lu = a;
+
+        const std::vector<int>& offsets = lu.row_offsets();
+        const std::vector<int>& cols = lu.col_indices();
+        std::vector<T>& values = lu.values();
+        std::vector<int> position(this->_size, -1);
+
+        for (int i = 0; i < this->_size; ++i) {
+            for (int k = offsets[i]; k < offsets[i + 1]; ++k) {
+                position[cols[k]] = k;
+            }
+
+            for (int k = offsets[i]; k < diagonal[i]; ++k) {
+                int row = cols[k];
+                values[k] /= values[diagonal[row]];
+                for (int m = diagonal[row] + 1; m < offsets[row + 1]; ++m) {
+                    if (position[cols[m]] >= 0) {
+                        values[position[cols[m]]] -= values[k] * values[m];
+                    }
+                }
+            }
+
+            if (values[diagonal[i]] == 0) {
+                throw std::runtime_error("Cannot compute ILU(0), zero pivot");
+            }
+            for (int k = offsets[i]; k < offsets[i + 1]; ++k) {
+                position[cols[k]] = -1;
+            }
+        }
+    }
+
+    void solve_in_place(T* z) const override {
+        const std::vector<int>& offsets = lu.row_offsets();
+        const std::vector<int>& cols = lu.col_indices();
+        const std::vector<T>& values = lu.values();
+
+        for (int i = 0; i < this->_size; ++i) {
+            T sum = z[i];
+            for (int k = offsets[i]; k < diagonal[i]; ++k) {
+                sum -= values[k] * z[cols[k]];
+            }
+            z[i] = sum;
+        }
+
+        for (int i = this->_size - 1; i >= 0; --i) {
+            T sum = z[i];
+            for (int k = diagonal[i] + 1; k < offsets[i + 1]; ++k) {
+                sum -= values[k] * z[cols[k]];
+            }
+            z[i] = sum / values[diagonal[i]];
+        }
+    }
+
+private:
+    SparseMatrix<T> lu;
+    std::vector<int> diagonal;
+};
+
+/**
+ * Incomplete Cholesky factorization with zero fill-in, M = L * L^T where L keeps the pattern
+ * of the lower triangle of A. Operator must be symmetric positive definite.
+ */
+template<class T>
+class IC0Preconditioner : public Preconditioner<T> {
+protected:
+
+    void factorize(const SparseMatrix<T>& a) override {
+        this->diagonal_positions(a, "Cannot compute IC(0), matrix is not positive definite");
+        int n = this->_size;
+
+        // lower triangle of A, row by row, diagonal is the last element of every row
+        offsets.assign(n + 1, 0);
+        cols.clear();
+        values.clear();
+        for (int i = 0; i < n; ++i) {
+            for (int k = a.row_offsets()[i]; k < a.row_offsets()[i + 1] && a.col_indices()[k] <= i; ++k) {
+                cols.push_back(a.col_indices()[k]);
+                values.push_back(a.values()[k]);
+            }
+            offsets[i + 1] = static_cast<int>(values.size());
+        }
+
+        for (int i = 0; i < n; ++i) {
+            for (int k = offsets[i]; k < offsets[i + 1]; ++k) {
+                int j = cols[k];
+
+                // sparse dot product of already computed parts of rows i and j (columns < j)
+                T sum = values[k];
+                int p = offsets[i], q = offsets[j];
+                while (p < k && q < offsets[j + 1] - 1) {
+                    if (cols[p] < cols[q]) {
+                        ++p;
+                    } else if (cols[p] > cols[q]) {
+                        ++q;
+                    } else {
+                        sum -= values[p++] * values[q++];
+                    }
+                }
+
+                if (j < i) {
+                    values[k] = sum / values[offsets[j + 1] - 1];
+                } else {
+                    if (!(sum > 0)) {
+                        throw std::runtime_error("Cannot compute IC(0), matrix is not positive definite");
+                    }
+                    values[k] = std::sqrt(sum);
+                }
+            }
+        }
+    }
+
+    void solve_in_place(T* z) const override {
+        int n = this->_size;
+
+        for (int i = 0; i < n; ++i) {
+            T sum = z[i];
+            for (int k = offsets[i]; k < offsets[i + 1] - 1; ++k) {
+                sum -= values[k] * z[cols[k]];
+            }
+            z[i] = sum / values[offsets[i + 1] - 1];
+        }
+
+        // L^T is traversed by columns of L, that is rows of CSR storage
+        for (int i = n - 1; i >= 0; --i) {
+            z[i] /= values[offsets[i + 1] - 1];
+            for (int k = offsets[i]; k < offsets[i + 1] - 1; ++k) {
+                z[cols[k]] -= values[k] * z[i];
+            }
+        }
+    }
+
+private:
+    std::vector<int> offsets;
+    std::vector<int> cols;
+    std::vector<T> values;
+};
+
+/**
+ * Preconditioned conjugate gradient iteration shared by dense and sparse solvers. multiply(p, q) must
+ * compute q = A * p.
+ */
+template<class T, class Multiply>
+Vector<T> preconditioned_cg(const Vector<T>& b, const Preconditioner<T>& m, Multiply multiply,
+                            T tolerance, int max_iterations, int* iterations) {
+    int n = b.size();
+    if (m.size() != n) {
+        throw std::runtime_error("Incompatible dimensions");
+    }
+
+    Vector<T> x = Vector<T>::zeros(n);
+    Vector<T> r = b;
+    Vector<T> q = Vector<T>::zeros(n);
+    T b_norm = std::sqrt(b.dot(b));
+
+    Vector<T> z = m.apply(r);
+    Vector<T> p = z;
+    T rz = r.dot(z);
+
+    int iteration = 0;
+    while (iteration < max_iterations && std::sqrt(r.dot(r)) > tolerance * b_norm) {
+        multiply(p, q);
+        T alpha = rz / p.dot(q);
+        for (int i = 0; i < n; ++i) {
+            x.data()[i] += alpha * p.data()[i];
+            r.data()[i] -= alpha * q.data()[i];
+        }
+
+        z = r;
+        m.apply_in_place(z);
+        T rz_next = r.dot(z);
+        T beta = rz_next / rz;
+        rz = rz_next;
+        for (int i = 0; i < n; ++i) {
+            p.data()[i] = z.data()[i] + beta * p.data()[i];
+        }
+        ++iteration;
+    }
+
+    if (iterations != nullptr) {
+        *iterations = iteration;
+    }
+    return x;
+}
+
+/**
+ * Solves Ax=b for symmetric positive definite A with the preconditioned conjugate gradient method.
+ * Stops when the residual norm drops below tolerance * |b| or after max_iterations. The number of
+ * iterations performed is stored in iterations, if provided.
+ */
+template<class T>
+Matrix<T> conjugate_gradient(const Matrix<T>& a, const Matrix<T>& b, const Preconditioner<T>& m,
+                             T tolerance = 1e-10, int max_iterations = 1000, int* iterations = nullptr) {
+    if (a.rows() != a.cols() || b.rows() != a.rows() || b.cols() != 1) {
+        throw std::runtime_error("Incompatible dimensions");
+    }
+
+    return preconditioned_cg(Vector<T>::from_matrix(b), m, [&](const Vector<T>& p, Vector<T>& q) {
+        gemv(a, p, q);
+    }, tolerance, max_iterations, iterations).to_matrix();
+}
+
+/**
+ * Sparse variant of the preconditioned conjugate gradient method.
+ */
+template<class T>
+Vector<T> conjugate_gradient(const SparseMatrix<T>& a, const Vector<T>& b, const Preconditioner<T>& m,
+                             T tolerance = 1e-10, int max_iterations = 1000, int* iterations = nullptr) {
+    if (a.rows() != a.cols() || b.size() != a.rows()) {
+        throw std::runtime_error("Incompatible dimensions");
+    }
+
+    return preconditioned_cg(b, m, [&](const Vector<T>& p, Vector<T>& q) {
+        a.multiply(p, q);
+    }, tolerance, max_iterations, iterations);
+}
+
+#endif
@@ -0,0 +1,279 @@
+#ifndef _SERIALIZATION_H
+#define _SERIALIZATION_H
+
+#include <stdexcept>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include "Matrix.h"
+#include "DType.h"
+#include "Checksum.h"
+
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * Header of the binary matrix format, followed by payload_bytes of elements: the storage of the matrix
+ * exactly as in memory (native byte order, layout and stride as recorded), so it is written and read
+ * back without any conversion. checksum is CRC-32 of the payload.
+ */
+struct SerializedHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t dtype;
+    uint32_t layout;
+    uint32_t checksum;
+    int64_t rows;
+    int64_t cols;
+    int64_t stride;
+    uint64_t payload_bytes;
+};
+
+const char SERIALIZED_MAGIC[8] = {'Z', 'B', 'P', 'M', 'A', 'T', '\0', '\0'};
+const uint32_t SERIALIZED_VERSION = 1;
+
+template<class T, class Layout>
+size_t serialized_payload(int rows, int cols, int stride) {
+    return static_cast<size_t>(Layout::lines(rows, cols)) * Layout::line_length(rows, cols, stride) * sizeof(T);
+}
+
+/**
+ * Fills header describing storage of matrix, which must not be a view.
+ */
+template<class T, class Layout>
+SerializedHeader serialized_header(const Matrix<T, Layout>& m) {
+    static_assert(dtype_of<T>::code != DType::UNKNOWN, "Serialization requires arithmetic element type");
+
+    SerializedHeader header;
+    std::memcpy(header.magic, SERIALIZED_MAGIC, sizeof(header.magic));
+    header.version = SERIALIZED_VERSION;
+    header.dtype = dtype_of<T>::code;
+    header.layout = Layout::CODE;
+    header.rows = m.rows();
+    header.cols = m.cols();
+    header.stride = m.stride();
+    header.payload_bytes = serialized_payload<T, Layout>(m.rows(), m.cols(), m.stride());
+    header.checksum = crc32_parallel(&m.at(1, 1), header.payload_bytes);
+    return header;
+}
+
+/**
+ * Checks header read from a file or stream, throws describing the problem.
+ */
+template<class T>
+void serialized_check(const SerializedHeader& header) {
+    if (std::memcmp(header.magic, SERIALIZED_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Cannot load matrix: not a matrix file");
+    }
+    if (header.version != SERIALIZED_VERSION) {
+        throw std::runtime_error("Cannot load matrix: unsupported version");
+    }
+    if (header.dtype != static_cast<uint32_t>(dtype_of<T>::code)) {
+        throw std::runtime_error(std::string("Cannot load matrix: stored elements are ") +
+                                 DType::name(static_cast<DType::Code>(header.dtype)));
+    }
+    if (header.rows <= 0 || header.cols <= 0 || header.rows > INT32_MAX || header.cols > INT32_MAX ||
+        header.stride <= 0 || header.stride > INT32_MAX) {
+        throw std::runtime_error("Cannot load matrix: invalid dimensions");
+    }
+}
+
+/**
+ * Allocates matrix for the payload described by header in Layout, which must be the layout of the payload.
+ */
+template<class T, class Layout>
+Matrix<T, Layout> serialized_allocate(const SerializedHeader& header) {
+    int rows = static_cast<int>(header.rows), cols = static_cast<int>(header.cols);
+    int stride = static_cast<int>(header.stride);
+    if (stride < Layout::min_stride(rows, cols) ||
+        serialized_payload<T, Layout>(rows, cols, stride) != header.payload_bytes) {
+        throw std::runtime_error("Cannot load matrix: invalid dimensions");
+    }
+    return Matrix<T, Layout>::with_stride(rows, cols, stride);
+}
+
+inline void serialized_verify(const SerializedHeader& header, const void* payload) {
+    if (crc32_parallel(payload, header.payload_bytes) != header.checksum) {
+        throw std::runtime_error("Cannot load matrix: checksum mismatch");
+    }
+}
+
+/**
+ * Saves matrix to the file in the binary format, with a single writev of header and storage.
+ * Views are copied first, only whole storage can be written directly.
+ */
+template<class T, class Layout>
+void save_matrix(const Matrix<T, Layout>& m, const std::string& path) {
+    if (m.is_view()) {
+        save_matrix(m.clone(), path);
+        return;
+    }
+
+    SerializedHeader header = serialized_header(m);
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create file " + path);
+    }
+
+    iovec parts[2];
+    parts[0].iov_base = &header;
+    parts[0].iov_len = sizeof(header);
+    parts[1].iov_base = &m.at(1, 1);
+    parts[1].iov_len = header.payload_bytes;
+
+    // writev may stop early for large payloads, the rest is written with the following calls
+    iovec* part = parts;
+    int count = 2;
+    while (count > 0) {
+        ssize_t written = writev(fd, part, count);
+        if (written < 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot write file " + path);
+        }
+        size_t done = static_cast<size_t>(written);
+        while (count > 0 && done >= part->iov_len) {
+            done -= part->iov_len;
+            ++part;
+            --count;
+        }
+        if (count > 0) {
+            part->iov_base = static_cast<char*>(part->iov_base) + done;
+            part->iov_len -= done;
+        }
+    }
+    if (::close(fd) != 0) {
+        throw std::runtime_error("Cannot write file " + path);
+    }
+}
+
+/**
+ * Saves matrix to the stream in the binary format.
+ */
+template<class T, class Layout>
+void save_matrix(const Matrix<T, Layout>& m, std::ostream& out) {
+    if (m.is_view()) {
+        save_matrix(m.clone(), out);
+        return;
+    }
+
+    SerializedHeader header = serialized_header(m);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(&m.at(1, 1)), static_cast<std::streamsize>(header.payload_bytes));
+    if (!out) {
+        throw std::runtime_error("Cannot write matrix to stream");
+    }
+}
+
+/**
+ * Reads exactly length bytes from the file, in a single read unless the kernel splits it.
+ */
+inline void serialized_read(int fd, void* buffer, size_t length, off_t position) {
+    char* bytes = static_cast<char*>(buffer);
+    while (length > 0) {
+        ssize_t done = pread(fd, bytes, length, position);
+        if (done <= 0) {
+            throw std::runtime_error("Cannot load matrix: file is truncated");
+        }
+        bytes += done;
+        length -= static_cast<size_t>(done);
+        position += done;
+    }
+}
+
+/**
+ * Closes file descriptor when leaving scope.
+ */
+struct SerializedFile {
+    int fd;
+
+    explicit SerializedFile(int fd) : fd(fd) {}
+
+    ~SerializedFile() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+};
+
+template<class T, class Stored, class Layout>
+struct SerializedRelayout {
+    static Matrix<T, Layout> apply(Matrix<T, Stored>& m) {
+        return m.template to_layout<Layout>();
+    }
+};
+
+template<class T, class Layout>
+struct SerializedRelayout<T, Layout, Layout> {
+    static Matrix<T, Layout> apply(Matrix<T, Layout>& m) {
+        return std::move(m);
+    }
+};
+
+/**
+ * Reads payload stored in Stored layout with read(buffer, length) straight into storage of a matrix,
+ * converted to Layout afterwards if it differs.
+ */
+template<class T, class Stored, class Layout, class Read>
+Matrix<T, Layout> serialized_payload_read(const SerializedHeader& header, Read read) {
+    Matrix<T, Stored> m = serialized_allocate<T, Stored>(header);
+    read(&m.at(1, 1), header.payload_bytes);
+    serialized_verify(header, &m.at(1, 1));
+    return SerializedRelayout<T, Stored, Layout>::apply(m);
+}
+
+/**
+ * Reads payload described by a checked header in the layout it was saved in, which must be Layout,
+ * row-major or column-major.
+ */
+template<class T, class Layout, class Read>
+Matrix<T, Layout> serialized_load(const SerializedHeader& header, Read read) {
+    if (header.layout == static_cast<uint32_t>(Layout::CODE)) {
+        return serialized_payload_read<T, Layout, Layout>(header, read);
+    } else if (header.layout == static_cast<uint32_t>(RowMajor::CODE)) {
+        return serialized_payload_read<T, RowMajor, Layout>(header, read);
+    } else if (header.layout == static_cast<uint32_t>(ColumnMajor::CODE)) {
+        return serialized_payload_read<T, ColumnMajor, Layout>(header, read);
+    }
+    throw std::runtime_error("Cannot load matrix: unsupported layout");
+}
+
+/**
+ * Loads matrix saved by save_matrix from the file. The payload is read straight into storage of the
+ * result. A payload in another layout (row-major or column-major) is converted after loading.
+ */
+template<class T, class Layout = RowMajor>
+Matrix<T, Layout> load_matrix(const std::string& path) {
+    SerializedFile file(::open(path.c_str(), O_RDONLY));
+    if (file.fd < 0) {
+        throw std::runtime_error("Cannot open file " + path);
+    }
+
+    SerializedHeader header;
+    serialized_read(file.fd, &header, sizeof(header), 0);
+    serialized_check<T>(header);
+    return serialized_load<T, Layout>(header, [&file](void* buffer, size_t length) {
+        serialized_read(file.fd, buffer, length, sizeof(SerializedHeader));
+    });
+}
+
+/**
+ * Loads matrix saved by save_matrix from the stream, see load_matrix above.
+ */
+template<class T, class Layout = RowMajor>
+Matrix<T, Layout> load_matrix(std::istream& in) {
+    SerializedHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        throw std::runtime_error("Cannot load matrix: stream is truncated");
+    }
+    serialized_check<T>(header);
+    return serialized_load<T, Layout>(header, [&in](void* buffer, size_t length) {
+        if (!in.read(static_cast<char*>(buffer), static_cast<std::streamsize>(length))) {
+            throw std::runtime_error("Cannot load matrix: stream is truncated");
+        }
+    });
+}
+
+#endif
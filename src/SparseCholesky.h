@@ -0,0 +1,448 @@
+#ifndef _SPARSE_CHOLESKY_H
+#define _SPARSE_CHOLESKY_H
+
+#include <stdexcept>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <cmath>
+#include "Vector.h"
+#include "SparseMatrix.h"
+
+/**
+ * Computes a fill-reducing ordering of a square sparse matrix with the minimum degree heuristic. Elimination
+ * is simulated on the quotient graph (eliminated nodes become elements that are absorbed, not cliques), so
+ * memory stays proportional to the pattern of A. Degrees are exact external degrees. Only the pattern of
+ * A + A^T is used. Returns permutation p where p[k] is the 0-based original index of k-th pivot.
+ */
+template<class T>
+std::vector<int> minimum_degree_ordering(const SparseMatrix<T>& a) {
+    if (a.rows() != a.cols()) {
+        throw std::runtime_error("Cannot order non-square matrix");
+    }
+
+    int n = a.rows();
+    std::vector<std::vector<int> > variables(n), elements(n), members(n);
+    SparseMatrix<T> transposed = a.transpose();
+    const SparseMatrix<T>* patterns[] = {&a, &transposed};
+    for (const SparseMatrix<T>* pattern : patterns) {
+        for (int i = 0; i < n; ++i) {
+            for (int k = pattern->row_offsets()[i]; k < pattern->row_offsets()[i + 1]; ++k) {
+                if (pattern->col_indices()[k] != i) {
+                    variables[i].push_back(pattern->col_indices()[k]);
+                }
+            }
+        }
+    }
+
+    std::vector<bool> eliminated(n, false), absorbed(n, false);
+    std::vector<int> marker(n, -1), degree(n);
+    std::set<std::pair<int, int> > queue;
+    for (int i = 0; i < n; ++i) {
+        std::sort(variables[i].begin(), variables[i].end());
+        variables[i].erase(std::unique(variables[i].begin(), variables[i].end()), variables[i].end());
+        degree[i] = static_cast<int>(variables[i].size());
+        queue.insert(std::make_pair(degree[i], i));
+    }
+
+    std::vector<int> order;
+    order.reserve(n);
+    int stamp = 0;
+    while (!queue.empty()) {
+        int pivot = queue.begin()->second;
+        queue.erase(queue.begin());
+        eliminated[pivot] = true;
+        order.push_back(pivot);
+
+        // pivot becomes a new element whose members are its variable neighbours and members of its elements
+        ++stamp;
+        marker[pivot] = stamp;
+        std::vector<int>& reach = members[pivot];
+        for (int v : variables[pivot]) {
+            if (!eliminated[v] && marker[v] != stamp) {
+                marker[v] = stamp;
+                reach.push_back(v);
+            }
+        }
+        for (int e : elements[pivot]) {
+            if (absorbed[e]) {
+                continue;
+            }
+            for (int v : members[e]) {
+                if (!eliminated[v] && marker[v] != stamp) {
+                    marker[v] = stamp;
+                    reach.push_back(v);
+                }
+            }
+            absorbed[e] = true;
+            std::vector<int>().swap(members[e]);
+        }
+        std::vector<int>().swap(variables[pivot]);
+        std::vector<int>().swap(elements[pivot]);
+
+        for (int v : reach) {
+            // edges to other members are now represented by the new element
+            std::vector<int> kept;
+            for (int u : variables[v]) {
+                if (!eliminated[u] && marker[u] != stamp) {
+                    kept.push_back(u);
+                }
+            }
+            variables[v].swap(kept);
+
+            std::vector<int> alive;
+            for (int e : elements[v]) {
+                if (!absorbed[e]) {
+                    alive.push_back(e);
+                }
+            }
+            alive.push_back(pivot);
+            elements[v].swap(alive);
+        }
+
+        for (int v : reach) {
+            ++stamp;
+            marker[v] = stamp;
+            int count = 0;
+            for (int u : variables[v]) {
+                if (marker[u] != stamp) {
+                    marker[u] = stamp;
+                    ++count;
+                }
+            }
+            for (int e : elements[v]) {
+                for (int u : members[e]) {
+                    if (!eliminated[u] && marker[u] != stamp) {
+                        marker[u] = stamp;
+                        ++count;
+                    }
+                }
+            }
+            queue.erase(std::make_pair(degree[v], v));
+            degree[v] = count;
+            queue.insert(std::make_pair(degree[v], v));
+        }
+    }
+
+    return order;
+}
+
+/**
+ * Sparse Cholesky factorization P A P^T = L L^T of a symmetric positive definite matrix.
+ * Work is split into two phases. analyze() depends only on the sparsity pattern: it computes the fill-reducing
+ * ordering, elimination tree, structure of L and its supernodes (groups of adjacent columns with identical
+ * structure). factorize() computes numeric values and can be called again for every matrix with the same
+ * pattern, without repeating the symbolic work. Every supernode is stored as a dense row-major panel and
+ * numeric factorization works on whole panels with dense kernels.
+ */
+template<class T>
+class SparseCholesky {
+public:
+
+    SparseCholesky() : n(0), analyzed(false), factorized(false) {}
+
+    /**
+     * Creates solver and runs both phases.
+     */
+    explicit SparseCholesky(const SparseMatrix<T>& a) : SparseCholesky() {
+        analyze(a);
+        factorize(a);
+    }
+
+    /**
+     * Symbolic phase, results are reused by all following calls to factorize() for the same pattern.
+     */
+    void analyze(const SparseMatrix<T>& a) {
+        if (a.rows() != a.cols()) {
+            throw std::runtime_error("Cannot factorize non-square matrix");
+        }
+
+        analyzed = factorized = false;
+        n = a.rows();
+        pattern_offsets = a.row_offsets();
+        pattern_cols = a.col_indices();
+
+        perm = minimum_degree_ordering(a);
+        inverse_perm.assign(n, 0);
+        for (int k = 0; k < n; ++k) {
+            inverse_perm[perm[k]] = k;
+        }
+
+        // lower triangle of permuted matrix by columns, only row indices
+        std::vector<std::vector<int> > lower(n);
+        for (int i = 0; i < n; ++i) {
+            for (int k = a.row_offsets()[i]; k < a.row_offsets()[i + 1]; ++k) {
+                int row = inverse_perm[i], col = inverse_perm[a.col_indices()[k]];
+                if (row > col) {
+                    lower[col].push_back(row);
+                } else if (col > row) {
+                    lower[row].push_back(col);
+                }
+            }
+        }
+
+        // structure of every column of L, struct(j) = pattern of A(:, j) + structures of children in etree
+        std::vector<int> parent(n, -1);
+        std::vector<std::vector<int> > structure(n);
+        std::vector<std::vector<int> > children(n);
+        std::vector<int> marker(n, -1);
+        for (int j = 0; j < n; ++j) {
+            std::vector<int>& column = structure[j];
+            marker[j] = j;
+            column.push_back(j);
+            for (int row : lower[j]) {
+                if (marker[row] != j) {
+                    marker[row] = j;
+                    column.push_back(row);
+                }
+            }
+            for (int child : children[j]) {
+                for (int row : structure[child]) {
+                    if (row > j && marker[row] != j) {
+                        marker[row] = j;
+                        column.push_back(row);
+                    }
+                }
+            }
+            std::sort(column.begin(), column.end());
+            if (column.size() > 1) {
+                parent[j] = column[1];
+                children[parent[j]].push_back(j);
+            }
+        }
+
+        // fundamental supernodes: column j + 1 joins j when struct(j) = {j} + struct(j + 1)
+        supernode_start.clear();
+        supernode_of.assign(n, 0);
+        for (int j = 0; j < n; ++j) {
+            bool merge = j > 0 && parent[j - 1] == j && children[j].size() == 1
+                         && structure[j - 1].size() == structure[j].size() + 1
+                         && j - supernode_start.back() < MAX_SUPERNODE_WIDTH;
+            if (!merge) {
+                supernode_start.push_back(j);
+            }
+            supernode_of[j] = static_cast<int>(supernode_start.size()) - 1;
+        }
+        int supernode_count = static_cast<int>(supernode_start.size());
+        supernode_start.push_back(n);
+
+        supernode_rows.assign(supernode_count, std::vector<int>());
+        panel_offset.assign(supernode_count + 1, 0);
+        for (int s = 0; s < supernode_count; ++s) {
+            supernode_rows[s] = structure[supernode_start[s]];
+            panel_offset[s + 1] = panel_offset[s] + supernode_rows[s].size() * width(s);
+        }
+
+        // every supernode is updated by descendants that have rows in its columns
+        updated_by.assign(supernode_count, std::vector<int>());
+        for (int d = 0; d < supernode_count; ++d) {
+            int last = -1;
+            for (int row : supernode_rows[d]) {
+                int s = supernode_of[row];
+                if (s != d && s != last) {
+                    updated_by[s].push_back(d);
+                    last = s;
+                }
+            }
+        }
+
+        // where every value of A lands in the panels, -1 for the upper triangle
+        value_target.assign(pattern_cols.size(), -1);
+        std::vector<int> position(n, -1);
+        for (int s = 0; s < supernode_count; ++s) {
+            for (size_t r = 0; r < supernode_rows[s].size(); ++r) {
+                position[supernode_rows[s][r]] = static_cast<int>(r);
+            }
+            for (int j = supernode_start[s]; j < supernode_start[s + 1]; ++j) {
+                int original = perm[j];
+                for (int k = a.row_offsets()[original]; k < a.row_offsets()[original + 1]; ++k) {
+                    int row = inverse_perm[a.col_indices()[k]];
+                    if (row >= j) {
+                        value_target[k] = panel_offset[s] + static_cast<long>(position[row]) * width(s)
+                                          + (j - supernode_start[s]);
+                    }
+                }
+            }
+        }
+
+        analyzed = true;
+    }
+
+    /**
+     * Numeric phase. The matrix must have exactly the pattern passed to analyze().
+     */
+    void factorize(const SparseMatrix<T>& a) {
+        if (!analyzed) {
+            throw std::runtime_error("Cannot factorize before symbolic analysis");
+        }
+        if (a.rows() != n || a.row_offsets() != pattern_offsets || a.col_indices() != pattern_cols) {
+            throw std::runtime_error("Sparsity pattern differs from the analyzed one");
+        }
+
+        factorized = false;
+        panels.assign(panel_offset.back(), 0);
+        for (size_t k = 0; k < value_target.size(); ++k) {
+            if (value_target[k] >= 0) {
+                panels[value_target[k]] = a.values()[k];
+            }
+        }
+
+        std::vector<int> position(n, -1);
+        int supernode_count = static_cast<int>(supernode_rows.size());
+        for (int s = 0; s < supernode_count; ++s) {
+            const std::vector<int>& rows = supernode_rows[s];
+            for (size_t r = 0; r < rows.size(); ++r) {
+                position[rows[r]] = static_cast<int>(r);
+            }
+            for (int d : updated_by[s]) {
+                update(s, d, position);
+            }
+            factorize_panel(s);
+        }
+
+        factorized = true;
+    }
+
+    /**
+     * Solves Ax=b using the computed factorization.
+     */
+    Vector<T> solve(const Vector<T>& b) const {
+        if (!factorized) {
+            throw std::runtime_error("Cannot solve before numeric factorization");
+        }
+        if (b.size() != n) {
+            throw std::runtime_error("Incompatible dimensions");
+        }
+
+        std::vector<T> y(n);
+        for (int k = 0; k < n; ++k) {
+            y[k] = b.data()[perm[k]];
+        }
+
+        int supernode_count = static_cast<int>(supernode_rows.size());
+        for (int s = 0; s < supernode_count; ++s) {
+            const std::vector<int>& rows = supernode_rows[s];
+            const T* panel = &panels[panel_offset[s]];
+            int w = width(s), first = supernode_start[s];
+            for (int j = 0; j < w; ++j) {
+                y[first + j] /= panel[j * w + j];
+                for (size_t i = j + 1; i < rows.size(); ++i) {
+                    y[rows[i]] -= panel[i * w + j] * y[first + j];
+                }
+            }
+        }
+
+        for (int s = supernode_count - 1; s >= 0; --s) {
+            const std::vector<int>& rows = supernode_rows[s];
+            const T* panel = &panels[panel_offset[s]];
+            int w = width(s), first = supernode_start[s];
+            for (int j = w - 1; j >= 0; --j) {
+                T sum = y[first + j];
+                for (size_t i = j + 1; i < rows.size(); ++i) {
+                    sum -= panel[i * w + j] * y[rows[i]];
+                }
+                y[first + j] = sum / panel[j * w + j];
+            }
+        }
+
+        Vector<T> x = Vector<T>::zeros(n);
+        for (int k = 0; k < n; ++k) {
+            x.data()[perm[k]] = y[k];
+        }
+        return x;
+    }
+
+    /**
+     * Returns fill-reducing permutation, p[k] is the 0-based original index of k-th pivot.
+     */
+    const std::vector<int>& permutation() const {
+        return perm;
+    }
+
+    /**
+     * Returns number of supernodes found by symbolic analysis.
+     */
+    int supernodes() const {
+        return static_cast<int>(supernode_rows.size());
+    }
+
+    /**
+     * Returns number of nonzero elements of L (lower triangle including diagonal).
+     */
+    long factor_nonzeros() const {
+        long count = 0;
+        for (size_t s = 0; s < supernode_rows.size(); ++s) {
+            int w = width(static_cast<int>(s));
+            count += static_cast<long>(supernode_rows[s].size()) * w - static_cast<long>(w) * (w - 1) / 2;
+        }
+        return count;
+    }
+
+private:
+
+    static const int MAX_SUPERNODE_WIDTH = 64;
+
+    int n;
+    bool analyzed, factorized;
+    std::vector<int> pattern_offsets, pattern_cols;
+    std::vector<int> perm, inverse_perm;
+    std::vector<int> supernode_start, supernode_of;
+    std::vector<std::vector<int> > supernode_rows;
+    std::vector<std::vector<int> > updated_by;
+    std::vector<long> panel_offset;
+    std::vector<long> value_target;
+    std::vector<T> panels;
+
+    int width(int s) const {
+        return supernode_start[s + 1] - supernode_start[s];
+    }
+
+    /**
+     * Subtracts contribution of descendant supernode d from panel s: L_s -= L_d[r2, :] * L_d[r1, :]^T,
+     * where r1 are rows of d inside the columns of s and r2 all rows of d from there on.
+     */
+    void update(int s, int d, const std::vector<int>& position) {
+        const std::vector<int>& rows = supernode_rows[d];
+        const T* source = &panels[panel_offset[d]];
+        T* target = &panels[panel_offset[s]];
+        int wd = width(d), ws = width(s);
+        int first = supernode_start[s], last = supernode_start[s + 1];
+
+        size_t begin = std::lower_bound(rows.begin(), rows.end(), first) - rows.begin();
+        size_t end = begin;
+        while (end < rows.size() && rows[end] < last) {
+            ++end;
+        }
+
+        for (size_t i = begin; i < rows.size(); ++i) {
+            T* out = target + static_cast<long>(position[rows[i]]) * ws;
+            for (size_t j = begin; j < end && j <= i; ++j) {
+                out[rows[j] - first] -= Vector<T>::dot_kernel(source + i * wd, source + j * wd, wd);
+            }
+        }
+    }
+
+    /**
+     * Dense Cholesky of the diagonal block of panel s followed by triangular solve of the rows below it.
+     */
+    void factorize_panel(int s) {
+        T* panel = &panels[panel_offset[s]];
+        int w = width(s);
+        int m = static_cast<int>(supernode_rows[s].size());
+
+        for (int j = 0; j < w; ++j) {
+            T diagonal = panel[j * w + j] - Vector<T>::dot_kernel(panel + j * w, panel + j * w, j);
+            if (!(diagonal > 0)) {
+                throw std::runtime_error("Cannot factorize, matrix is not positive definite");
+            }
+            panel[j * w + j] = std::sqrt(diagonal);
+
+            for (int i = j + 1; i < m; ++i) {
+                panel[i * w + j] = (panel[i * w + j] - Vector<T>::dot_kernel(panel + i * w, panel + j * w, j))
+                                   / panel[j * w + j];
+            }
+        }
+    }
+};
+
+#endif
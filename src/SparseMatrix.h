@@ -0,0 +1,369 @@
+#ifndef _SPARSE_MATRIX_H
+#define _SPARSE_MATRIX_H
+
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+#include "Matrix.h"
+#include "Vector.h"
+#include "Parallel.h"
+
+/**
+ * Single (row, col, value) entry used to assemble sparse matrices. Indices start at 1.
+ */
+template<class T>
+struct Triplet {
+    int row, col;
+    T value;
+};
+
+/**
+ * Sparse matrix in compressed sparse row (CSR) format. Only nonzero elements are stored, row by row,
+ * with column indices sorted inside every row. Like Matrix, elements are indexed from 1 in the public
+ * interface, but the raw arrays (row_offsets, col_indices, values) are 0-based.
+ */
+template<class T>
+class SparseMatrix {
+public:
+
+    /**
+     * Creates MxN sparse matrix from a list of entries. Entries with the same coordinates are summed.
+     */
+    static SparseMatrix<T> from_triplets(int rows, int cols, const std::vector<Triplet<T> >& triplets) {
+        SparseMatrix<T> result(rows, cols);
+
+        for (const Triplet<T>& triplet : triplets) {
+            if (triplet.row <= 0 || triplet.col <= 0 || triplet.row > rows || triplet.col > cols) {
+                throw std::runtime_error("Invalid triplet coordinates");
+            }
+            result._row_offsets[triplet.row]++;
+        }
+        for (int i = 0; i < rows; ++i) {
+            result._row_offsets[i + 1] += result._row_offsets[i];
+        }
+
+        // counting sort by row, then sort every row by column and merge duplicates
+        std::vector<int> next(result._row_offsets.begin(), result._row_offsets.end() - 1);
+        std::vector<std::pair<int, T> > entries(triplets.size());
+        for (const Triplet<T>& triplet : triplets) {
+            entries[next[triplet.row - 1]++] = std::make_pair(triplet.col - 1, triplet.value);
+        }
+
+        std::vector<int> offsets(rows + 1, 0);
+        for (int i = 0; i < rows; ++i) {
+            auto first = entries.begin() + result._row_offsets[i];
+            auto last = entries.begin() + result._row_offsets[i + 1];
+            std::sort(first, last, [](const std::pair<int, T>& a, const std::pair<int, T>& b) {
+                return a.first < b.first;
+            });
+            for (auto it = first; it != last; ++it) {
+                if (it != first && it->first == result._col_indices.back()) {
+                    result._values.back() += it->second;
+                } else {
+                    result._col_indices.push_back(it->first);
+                    result._values.push_back(it->second);
+                }
+            }
+            offsets[i + 1] = static_cast<int>(result._values.size());
+        }
+        result._row_offsets = offsets;
+
+        return result;
+    }
+
+    /**
+     * Creates sparse matrix holding all nonzero elements of a dense matrix.
+     */
+    static SparseMatrix<T> from_dense(const Matrix<T>& dense) {
+        SparseMatrix<T> result(dense.rows(), dense.cols());
+        for (int i = 1; i <= dense.rows(); ++i) {
+            const T* row = dense.row_data(i);
+            for (int j = 0; j < dense.cols(); ++j) {
+                if (row[j] != 0) {
+                    result._col_indices.push_back(j);
+                    result._values.push_back(row[j]);
+                }
+            }
+            result._row_offsets[i] = static_cast<int>(result._values.size());
+        }
+        return result;
+    }
+
+    /**
+     * Creates MxN sparse matrix without any nonzero elements.
+     */
+    static SparseMatrix<T> zeros(int rows, int cols) {
+        return SparseMatrix<T>(rows, cols);
+    }
+
+    /**
+     * Converts to a dense matrix.
+     */
+    Matrix<T> to_dense() const {
+        Matrix<T> result = Matrix<T>::zeros(_rows, _cols);
+        for (int i = 0; i < _rows; ++i) {
+            T* row = result.row_data(i + 1);
+            for (int k = _row_offsets[i]; k < _row_offsets[i + 1]; ++k) {
+                row[_col_indices[k]] = _values[k];
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Returns number of rows.
+     */
+    int rows() const {
+        return _rows;
+    }
+
+    /**
+     * Returns number of columns.
+     */
+    int cols() const {
+        return _cols;
+    }
+
+    /**
+     * Returns number of stored elements.
+     */
+    int nonzeros() const {
+        return static_cast<int>(_values.size());
+    }
+
+    /**
+     * Gets value of element at the specific coordinates, zero if it is not stored. Read-only,
+     * because writing to an element outside of the pattern would require rebuilding the matrix.
+     */
+    T at(int row, int col) const {
+        if (row <= 0 || col <= 0 || row > _rows || col > _cols) {
+            throw std::runtime_error("Invalid element access");
+        }
+
+        int position = find(row - 1, col - 1);
+        return position < 0 ? T(0) : _values[position];
+    }
+
+    const std::vector<int>& row_offsets() const {
+        return _row_offsets;
+    }
+
+    const std::vector<int>& col_indices() const {
+        return _col_indices;
+    }
+
+    const std::vector<T>& values() const {
+        return _values;
+    }
+
+    /**
+     * Mutable access to stored values, the pattern stays fixed.
+     */
+    std::vector<T>& values() {
+        return _values;
+    }
+
+    /**
+     * Returns 0-based position of element (row, col) in values(), or -1 if it is not stored.
+     * Coordinates are 0-based.
+     */
+    int find(int row, int col) const {
+        auto first = _col_indices.begin() + _row_offsets[row];
+        auto last = _col_indices.begin() + _row_offsets[row + 1];
+        auto it = std::lower_bound(first, last, col);
+        return (it != last && *it == col) ? static_cast<int>(it - _col_indices.begin()) : -1;
+    }
+
+    /**
+     * Returns transposed matrix.
+     */
+    SparseMatrix<T> transpose() const {
+        SparseMatrix<T> result(_cols, _rows);
+        result._col_indices.resize(_values.size());
+        result._values.resize(_values.size());
+
+        for (int col : _col_indices) {
+            result._row_offsets[col + 1]++;
+        }
+        for (int j = 0; j < _cols; ++j) {
+            result._row_offsets[j + 1] += result._row_offsets[j];
+        }
+
+        std::vector<int> next(result._row_offsets.begin(), result._row_offsets.end() - 1);
+        for (int i = 0; i < _rows; ++i) {
+            for (int k = _row_offsets[i]; k < _row_offsets[i + 1]; ++k) {
+                int position = next[_col_indices[k]]++;
+                result._col_indices[position] = i;
+                result._values[position] = _values[k];
+            }
+        }
+
+        return result;
+    }
+
+    /**
+     * Sparse matrix-vector product y = A * x, written into existing vector y.
+     */
+    void multiply(const Vector<T>& x, Vector<T>& y) const {
+        if (_cols != x.size() || _rows != y.size()) {
+            throw std::runtime_error("Cannot multiply, invalid dimensions");
+        }
+
+        const T* in = x.data();
+        T* out = y.data();
+        parallel_for(0, _rows, row_grain(), [&](int from, int to) {
+            for (int i = from; i < to; ++i) {
+                T sum = 0;
+                for (int k = _row_offsets[i]; k < _row_offsets[i + 1]; ++k) {
+                    sum += _values[k] * in[_col_indices[k]];
+                }
+                out[i] = sum;
+            }
+        });
+    }
+
+    /**
+     * Sparse matrix-vector product.
+     */
+    Vector<T> operator*(const Vector<T>& x) const {
+        Vector<T> y = Vector<T>::zeros(_rows);
+        multiply(x, y);
+        return y;
+    }
+
+    /**
+     * Product of sparse and dense matrix, the result is dense.
+     */
+    Matrix<T> operator*(const Matrix<T>& dense) const {
+        if (_cols != dense.rows()) {
+            throw std::runtime_error("Cannot multiply, invalid dimensions");
+        }
+
+        Matrix<T> result = Matrix<T>::zeros(_rows, dense.cols());
+        int width = dense.cols();
+        parallel_for(0, _rows, std::max(1, row_grain() / width), [&](int from, int to) {
+            for (int i = from; i < to; ++i) {
+                T* out = result.row_data(i + 1);
+                for (int k = _row_offsets[i]; k < _row_offsets[i + 1]; ++k) {
+                    Vector<T>::axpy_kernel(_values[k], dense.row_data(_col_indices[k] + 1), out, width);
+                }
+            }
+        });
+
+        return result;
+    }
+
+    /**
+     * Multiplies by a factor (non-mutating).
+     */
+    SparseMatrix<T> operator*(T factor) const {
+        SparseMatrix<T> result = *this;
+        for (T& value : result._values) {
+            value *= factor;
+        }
+        return result;
+    }
+
+    /**
+     * Adds sparse matrices (non-mutating).
+     */
+    SparseMatrix<T> operator+(const SparseMatrix<T>& other) const {
+        return merge(other, 1);
+    }
+
+    /**
+     * Subtracts sparse matrices (non-mutating).
+     */
+    SparseMatrix<T> operator-(const SparseMatrix<T>& other) const {
+        return merge(other, -1);
+    }
+
+    /**
+     * Multiplies matrices element by element, the result pattern is the intersection of both patterns.
+     */
+    SparseMatrix<T> multiply_elementwise(const SparseMatrix<T>& other) const {
+        check_same_dimensions(other);
+
+        SparseMatrix<T> result(_rows, _cols);
+        for (int i = 0; i < _rows; ++i) {
+            int a = _row_offsets[i], b = other._row_offsets[i];
+            while (a < _row_offsets[i + 1] && b < other._row_offsets[i + 1]) {
+                if (_col_indices[a] < other._col_indices[b]) {
+                    ++a;
+                } else if (_col_indices[a] > other._col_indices[b]) {
+                    ++b;
+                } else {
+                    result._col_indices.push_back(_col_indices[a]);
+                    result._values.push_back(_values[a++] * other._values[b++]);
+                }
+            }
+            result._row_offsets[i + 1] = static_cast<int>(result._values.size());
+        }
+        return result;
+    }
+
+    bool operator==(const SparseMatrix& other) const {
+        return _rows == other._rows && _cols == other._cols && _row_offsets == other._row_offsets
+               && _col_indices == other._col_indices && _values == other._values;
+    }
+
+    bool operator!=(const SparseMatrix& other) const {
+        return !(*this == other);
+    }
+
+private:
+
+    // number of stored elements below which products stay on one thread
+    static const int PARALLEL_THRESHOLD = 1 << 15;
+
+    int _rows, _cols;
+    std::vector<int> _row_offsets;
+    std::vector<int> _col_indices;
+    std::vector<T> _values;
+
+    SparseMatrix(int rows, int cols) : _rows(rows), _cols(cols), _row_offsets(rows > 0 ? rows + 1 : 1, 0) {
+        if (!(rows > 0 && cols > 0)) {
+            throw std::runtime_error("Cannot create matrix with nonpositive dimensions");
+        }
+    }
+
+    int row_grain() const {
+        int per_row = std::max(1, nonzeros() / _rows);
+        return std::max(1, PARALLEL_THRESHOLD / per_row);
+    }
+
+    void check_same_dimensions(const SparseMatrix<T>& other) const {
+        if (!(other._rows == _rows && other._cols == _cols)) {
+            throw std::runtime_error("Incompatible dimensions");
+        }
+    }
+
+    /**
+     * Returns this + sign * other, the result pattern is the union of both patterns.
+     */
+    SparseMatrix<T> merge(const SparseMatrix<T>& other, int sign) const {
+        check_same_dimensions(other);
+
+        SparseMatrix<T> result(_rows, _cols);
+        for (int i = 0; i < _rows; ++i) {
+            int a = _row_offsets[i], b = other._row_offsets[i];
+            int a_end = _row_offsets[i + 1], b_end = other._row_offsets[i + 1];
+            while (a < a_end || b < b_end) {
+                if (b == b_end || (a < a_end && _col_indices[a] < other._col_indices[b])) {
+                    result._col_indices.push_back(_col_indices[a]);
+                    result._values.push_back(_values[a++]);
+                } else if (a == a_end || _col_indices[a] > other._col_indices[b]) {
+                    result._col_indices.push_back(other._col_indices[b]);
+                    result._values.push_back(sign * other._values[b++]);
+                } else {
+                    result._col_indices.push_back(_col_indices[a]);
+                    result._values.push_back(_values[a++] + sign * other._values[b++]);
+                }
+            }
+            result._row_offsets[i + 1] = static_cast<int>(result._values.size());
+        }
+        return result;
+    }
+};
+
+#endif
@@ -0,0 +1,374 @@
+#ifndef _STORAGE_H
+#define _STORAGE_H
+
+#include <stdexcept>
+#include <new>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <type_traits>
+#include <cstdint>
+#include "Parallel.h"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Placement of matrix storage on NUMA nodes.
+ * DEFAULT leaves pages to the kernel, which places them on the node of the thread touching them first.
+ * FIRST_TOUCH zeroes storage in parallel with the same row partitioning as the parallel operations,
+ * so rows land near the threads that process them. INTERLEAVE spreads pages round-robin over all nodes,
+ * BIND puts all of them on one node.
+ */
+struct NumaPolicy {
+
+    enum Placement {
+        DEFAULT, FIRST_TOUCH, INTERLEAVE, BIND
+    };
+
+    Placement placement;
+    int node;
+
+    static NumaPolicy default_placement() {
+        return NumaPolicy(DEFAULT, -1);
+    }
+
+    static NumaPolicy first_touch() {
+        return NumaPolicy(FIRST_TOUCH, -1);
+    }
+
+    static NumaPolicy interleave() {
+        return NumaPolicy(INTERLEAVE, -1);
+    }
+
+    static NumaPolicy bind(int node) {
+        return NumaPolicy(BIND, node);
+    }
+
+private:
+    NumaPolicy(Placement placement, int node) : placement(placement), node(node) {}
+};
+
+// allocations of at least that many bytes are mapped directly from the kernel, so that their pages can be placed
+const size_t STORAGE_MAPPING_THRESHOLD = 1 << 21;
+
+// alignment of every storage, one cache line and the width of the widest vector registers
+const size_t STORAGE_ALIGNMENT = 64;
+
+// mapped storage of at least that many bytes is backed by 2M pages when possible
+const size_t HUGE_PAGE_THRESHOLD = 1 << 22;
+const size_t HUGE_PAGE_SIZE = 1 << 21;
+
+/**
+ * Backing of large storage. TRANSPARENT asks the kernel for transparent huge pages with madvise, EXPLICIT
+ * uses pages reserved in the hugetlbfs pool and falls back to TRANSPARENT when there are not enough of them.
+ * NONE forces 4K pages even if transparent huge pages are enabled system-wide.
+ */
+struct HugePages {
+
+    enum Mode {
+        NONE, TRANSPARENT, EXPLICIT
+    };
+};
+
+inline HugePages::Mode& huge_pages_slot() {
+    static HugePages::Mode mode = HugePages::TRANSPARENT;
+    return mode;
+}
+
+/**
+ * Returns page backing used for new large matrices.
+ */
+inline HugePages::Mode huge_pages() {
+    return huge_pages_slot();
+}
+
+/**
+ * Sets page backing used for new large matrices.
+ */
+inline void set_huge_pages(HugePages::Mode mode) {
+    huge_pages_slot() = mode;
+}
+
+/**
+ * Returns number of elements to allocate for a row of row_length elements, so that every row starts
+ * at a cache line boundary. Pitches which are a multiple of 4K get one more cache line, otherwise walking
+ * down a column hits the same cache set over and over.
+ */
+template<class T>
+int padded_pitch(int row_length) {
+    size_t bytes = static_cast<size_t>(row_length) * sizeof(T);
+    if (STORAGE_ALIGNMENT % sizeof(T) != 0) {
+        return row_length;
+    }
+
+    size_t padded = (bytes + STORAGE_ALIGNMENT - 1) / STORAGE_ALIGNMENT * STORAGE_ALIGNMENT;
+    if (padded % 4096 == 0) {
+        padded += STORAGE_ALIGNMENT;
+    }
+    return static_cast<int>(padded / sizeof(T));
+}
+
+// rows of at least that many bytes are padded by default
+const size_t ROW_PADDING_THRESHOLD = 512;
+
+/**
+ * Returns row pitch used for new matrices: padded for long rows, exact for short ones, where padding
+ * would waste a large part of the memory.
+ */
+template<class T>
+int default_pitch(int row_length) {
+    if (static_cast<size_t>(row_length) * sizeof(T) < ROW_PADDING_THRESHOLD) {
+        return row_length;
+    }
+    return padded_pitch<T>(row_length);
+}
+
+inline int numa_detect_nodes() {
+    std::ifstream online("/sys/devices/system/node/online");
+    std::string ranges;
+    if (!(online >> ranges)) {
+        return 1;
+    }
+
+    // format is a list of ranges, like "0-1,3"
+    int highest = 0;
+    std::stringstream list(ranges);
+    std::string range;
+    while (std::getline(list, range, ',')) {
+        size_t dash = range.find('-');
+        highest = std::max(highest, std::atoi(range.substr(dash == std::string::npos ? 0 : dash + 1).c_str()));
+    }
+    return highest + 1;
+}
+
+/**
+ * Returns number of NUMA nodes of the machine, 1 if it cannot be determined.
+ */
+inline int numa_nodes() {
+    static const int nodes = numa_detect_nodes();
+    return nodes;
+}
+
+inline NumaPolicy& numa_policy_slot() {
+    static NumaPolicy policy = NumaPolicy::default_placement();
+    return policy;
+}
+
+/**
+ * Returns placement used for new matrices.
+ */
+inline NumaPolicy numa_policy() {
+    return numa_policy_slot();
+}
+
+/**
+ * Sets placement used for new matrices. Meant to be called once at startup.
+ */
+inline void set_numa_policy(const NumaPolicy& policy) {
+    if (policy.placement == NumaPolicy::BIND && (policy.node < 0 || policy.node >= numa_nodes())) {
+        throw std::runtime_error("Invalid NUMA node");
+    }
+    numa_policy_slot() = policy;
+}
+
+/**
+ * Checks if storage of given number of elements is mapped directly instead of allocated with new.
+ */
+template<class T>
+bool storage_is_mapped(size_t count) {
+#ifdef __linux__
+    return std::is_trivial<T>::value && count * sizeof(T) >= STORAGE_MAPPING_THRESHOLD;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Applies memory policy to a mapped range. Placement is a hint, failure (a kernel without NUMA support,
+ * a container forbidding it) leaves the default policy.
+ */
+inline bool numa_apply(void* memory, size_t bytes, const NumaPolicy& policy) {
+#if defined(__linux__) && defined(SYS_mbind)
+    const int MPOL_BIND_MODE = 2, MPOL_INTERLEAVE_MODE = 3;
+    const size_t BITS = 8 * sizeof(unsigned long);
+
+    int nodes = numa_nodes();
+    std::vector<unsigned long> mask((nodes + BITS - 1) / BITS, 0);
+    if (policy.placement == NumaPolicy::INTERLEAVE) {
+        for (int node = 0; node < nodes; ++node) {
+            mask[node / BITS] |= 1UL << (node % BITS);
+        }
+    } else {
+        mask[policy.node / BITS] |= 1UL << (policy.node % BITS);
+    }
+    int mode = policy.placement == NumaPolicy::INTERLEAVE ? MPOL_INTERLEAVE_MODE : MPOL_BIND_MODE;
+    // the kernel reads maxnode - 1 bits
+    return syscall(SYS_mbind, memory, bytes, mode, mask.data(), mask.size() * BITS + 1, 0) == 0;
+#else
+    (void) memory;
+    (void) bytes;
+    (void) policy;
+    return false;
+#endif
+}
+
+/**
+ * Returns number of bytes mapped for storage of given number of elements, whole huge pages for storage
+ * eligible for them (no matter the current mode, so that the length can be recomputed on release).
+ */
+template<class T>
+size_t storage_mapped_length(size_t count) {
+    size_t bytes = count * sizeof(T);
+    size_t unit = bytes >= HUGE_PAGE_THRESHOLD ? HUGE_PAGE_SIZE : 4096;
+    return (bytes + unit - 1) / unit * unit;
+}
+
+/**
+ * Maps zeroed memory, backed by huge pages according to the current mode when length is a multiple of their size.
+ */
+inline void* map_storage(size_t length) {
+#ifdef __linux__
+    bool huge = length % HUGE_PAGE_SIZE == 0 && length >= HUGE_PAGE_THRESHOLD;
+#ifdef MAP_HUGETLB
+    if (huge && huge_pages() == HugePages::EXPLICIT) {
+        void* memory = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (memory != MAP_FAILED) {
+            return memory;
+        }
+    }
+#endif
+
+    if (huge && huge_pages() != HugePages::NONE) {
+        // huge pages can only back 2M aligned ranges, so more is mapped and the ends are cut off
+        void* memory = mmap(nullptr, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        char* start = static_cast<char*>(memory);
+        char* aligned = reinterpret_cast<char*>(
+                (reinterpret_cast<uintptr_t>(start) + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE);
+        if (aligned != start) {
+            munmap(start, aligned - start);
+        }
+        if (aligned + length != start + length + HUGE_PAGE_SIZE) {
+            munmap(aligned + length, start + HUGE_PAGE_SIZE - aligned);
+        }
+#ifdef MADV_HUGEPAGE
+        madvise(aligned, length, MADV_HUGEPAGE);
+#endif
+        return aligned;
+    }
+
+    void* memory = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+#ifdef MADV_NOHUGEPAGE
+    if (huge_pages() == HugePages::NONE) {
+        madvise(memory, length, MADV_NOHUGEPAGE);
+    }
+#endif
+    return memory;
+#else
+    (void) length;
+    throw std::bad_alloc();
+#endif
+}
+
+/**
+ * Allocates zeroed (value-initialized) storage aligned to STORAGE_ALIGNMENT from the heap.
+ */
+template<class T>
+T* allocate_aligned(size_t count) {
+    void* memory = nullptr;
+    if (posix_memalign(&memory, STORAGE_ALIGNMENT, std::max<size_t>(count, 1) * sizeof(T)) != 0) {
+        throw std::bad_alloc();
+    }
+
+    T* data = static_cast<T*>(memory);
+    if (std::is_trivial<T>::value) {
+        std::memset(memory, 0, count * sizeof(T));
+        return data;
+    }
+
+    size_t constructed = 0;
+    try {
+        for (; constructed < count; ++constructed) {
+            new(data + constructed) T();
+        }
+    } catch (...) {
+        while (constructed > 0) {
+            data[--constructed].~T();
+        }
+        free(memory);
+        throw;
+    }
+    return data;
+}
+
+/**
+ * Allocates zeroed storage for rows * row_length elements placed according to policy. First touch
+ * initialization splits rows between threads with the given grain, like the operations processing them.
+ * Storage is always aligned to STORAGE_ALIGNMENT. Small or non-trivial storage comes from the heap,
+ * placement and huge pages only apply to large one.
+ */
+template<class T>
+T* allocate_storage(int rows, int row_length, int grain, const NumaPolicy& policy) {
+    if (policy.placement == NumaPolicy::BIND && (policy.node < 0 || policy.node >= numa_nodes())) {
+        throw std::runtime_error("Invalid NUMA node");
+    }
+
+    size_t count = static_cast<size_t>(rows) * row_length;
+    if (!storage_is_mapped<T>(count)) {
+        return allocate_aligned<T>(count);
+    }
+
+    size_t bytes = storage_mapped_length<T>(count);
+    void* memory = map_storage(bytes);
+    T* data = static_cast<T*>(memory);
+
+    // fresh mapped pages read as zeros, they only get a node when written for the first time
+    if (policy.placement == NumaPolicy::INTERLEAVE || policy.placement == NumaPolicy::BIND) {
+        numa_apply(memory, bytes, policy);
+    } else if (policy.placement == NumaPolicy::FIRST_TOUCH) {
+        parallel_for(0, rows, grain, [&](int from, int to) {
+            std::memset(static_cast<char*>(memory) + static_cast<size_t>(from) * row_length * sizeof(T), 0,
+                        static_cast<size_t>(to - from) * row_length * sizeof(T));
+        });
+    }
+    return data;
+}
+
+/**
+ * Releases storage returned by allocate_storage.
+ */
+template<class T>
+void release_storage(T* data, size_t count) {
+    if (data == nullptr) {
+        return;
+    }
+#ifdef __linux__
+    if (storage_is_mapped<T>(count)) {
+        munmap(data, storage_mapped_length<T>(count));
+        return;
+    }
+#endif
+    if (!std::is_trivial<T>::value) {
+        for (size_t i = 0; i < count; ++i) {
+            data[i].~T();
+        }
+    }
+    free(data);
+}
+
+#endif
@@ -0,0 +1,408 @@
+#ifndef _STRUCTURED_MATRIX_H
+#define _STRUCTURED_MATRIX_H
+
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+#include "Matrix.h"
+#include "Vector.h"
+#include "Parallel.h"
+
+namespace structured_detail {
+
+// number of elements below which structured products stay on one thread
+const int PARALLEL_THRESHOLD = 1 << 16;
+
+/**
+ * Applies body(row) to every row of a matrix with given number of columns, in parallel for large matrices.
+ */
+template<class F>
+void product_rows(int rows, int cols, F body) {
+    parallel_for(1, rows + 1, std::max(1, PARALLEL_THRESHOLD / std::max(cols, 1)), [&](int from, int to) {
+        for (int i = from; i < to; ++i) {
+            body(i);
+        }
+    });
+}
+
+}
+
+/**
+ * NxN identity matrix. Nothing but the size is stored, products with it are copies.
+ */
+template<class T>
+class IdentityMatrix {
+public:
+
+    explicit IdentityMatrix(int size) : _size(size) {
+        if (!(size > 0)) {
+            throw std::runtime_error("Cannot create matrix with nonpositive dimensions");
+        }
+    }
+
+    int size() const {
+        return _size;
+    }
+
+    /**
+     * Gets element at the specific coordinates, 1 on diagonal and 0 elsewhere.
+     */
+    T at(int row, int col) const {
+        if (row <= 0 || col <= 0 || row > _size || col > _size) {
+            throw std::runtime_error("Invalid element access");
+        }
+        return row == col ? 1 : 0;
+    }
+
+    Matrix<T> to_dense() const {
+        return Matrix<T>::eye(_size);
+    }
+
+    Matrix<T> operator*(const Matrix<T>& other) const {
+        if (other.rows() != _size) {
+            throw std::runtime_error("Cannot multiply, invalid dimensions");
+        }
+        return other.clone();
+    }
+
+private:
+    int _size;
+};
+
+/**
+ * NxN diagonal matrix, only the diagonal is stored. Multiplying a matrix by it from the left scales rows,
+ * from the right scales columns.
+ */
+template<class T>
+class DiagonalMatrix {
+public:
+
+    /**
+     * Creates diagonal matrix with given elements on the diagonal.
+     */
+    explicit DiagonalMatrix(const Vector<T>& diagonal) : _diagonal(diagonal) {}
+
+    /**
+     * Creates NxN diagonal matrix filled with zeros.
+     */
+    static DiagonalMatrix<T> zeros(int size) {
+        return DiagonalMatrix<T>(Vector<T>::zeros(size));
+    }
+
+    /**
+     * Creates diagonal matrix from the diagonal of a square dense matrix.
+     */
+    static DiagonalMatrix<T> from_dense(const Matrix<T>& dense) {
+        if (dense.rows() != dense.cols()) {
+            throw std::runtime_error("Cannot take diagonal of non-square matrix");
+        }
+
+        DiagonalMatrix<T> result = zeros(dense.rows());
+        for (int i = 1; i <= dense.rows(); ++i) {
+            result.at(i) = dense.at(i, i);
+        }
+        return result;
+    }
+
+    int size() const {
+        return _diagonal.size();
+    }
+
+    /**
+     * Gets i-th element of the diagonal.
+     */
+    T& at(int index) {
+        return _diagonal.at(index);
+    }
+
+    const T& at(int index) const {
+        return _diagonal.at(index);
+    }
+
+    /**
+     * Gets element at the specific coordinates, zero outside of the diagonal.
+     */
+    T at(int row, int col) const {
+        if (row <= 0 || col <= 0 || row > size() || col > size()) {
+            throw std::runtime_error("Invalid element access");
+        }
+        return row == col ? _diagonal.at(row) : 0;
+    }
+
+    Matrix<T> to_dense() const {
+        Matrix<T> result = Matrix<T>::zeros(size(), size());
+        for (int i = 1; i <= size(); ++i) {
+            result.at(i, i) = at(i);
+        }
+        return result;
+    }
+
+    /**
+     * Returns inverse, that is matrix with reciprocals on diagonal.
+     */
+    DiagonalMatrix<T> inverse() const {
+        DiagonalMatrix<T> result = *this;
+        for (int i = 1; i <= size(); ++i) {
+            if (at(i) == 0) {
+                throw std::runtime_error("Cannot invert singular diagonal matrix");
+            }
+            result.at(i) = 1 / at(i);
+        }
+        return result;
+    }
+
+    /**
+     * Scales rows of the matrix, D * A.
+     */
+    Matrix<T> operator*(const Matrix<T>& other) const {
+        if (other.rows() != size()) {
+            throw std::runtime_error("Cannot multiply, invalid dimensions");
+        }
+
+        Matrix<T> result = Matrix<T>::zeros(other.rows(), other.cols());
+        int width = other.cols();
+        structured_detail::product_rows(other.rows(), width, [&](int i) {
+            const T* source = other.row_data(i);
+            T* out = result.row_data(i);
+            T factor = _diagonal.data()[i - 1];
+            for (int j = 0; j < width; ++j) {
+                out[j] = factor * source[j];
+            }
+        });
+        return result;
+    }
+
+    Vector<T> operator*(const Vector<T>& x) const {
+        if (x.size() != size()) {
+            throw std::runtime_error("Cannot multiply, invalid dimensions");
+        }
+
+        Vector<T> result = x;
+        for (int i = 0; i < size(); ++i) {
+            result.data()[i] *= _diagonal.data()[i];
+        }
+        return result;
+    }
+
+    DiagonalMatrix<T> operator*(const DiagonalMatrix<T>& other) const {
+        return DiagonalMatrix<T>(*this * other._diagonal);
+    }
+
+private:
+    Vector<T> _diagonal;
+};
+
+/**
+ * Scales columns of the matrix, A * D.
+ */
+template<class T>
+Matrix<T> operator*(const Matrix<T>& matrix, const DiagonalMatrix<T>& diagonal) {
+    if (matrix.cols() != diagonal.size()) {
+        throw std::runtime_error("Cannot multiply, invalid dimensions");
+    }
+
+    Matrix<T> result = Matrix<T>::zeros(matrix.rows(), matrix.cols());
+    int width = matrix.cols();
+    structured_detail::product_rows(matrix.rows(), width, [&](int i) {
+        const T* source = matrix.row_data(i);
+        T* out = result.row_data(i);
+        const T* factors = &diagonal.at(1);
+        for (int j = 0; j < width; ++j) {
+            out[j] = source[j] * factors[j];
+        }
+    });
+    return result;
+}
+
+/**
+ * NxN permutation matrix, stored as a permutation p of 1..N: row i of P has its only 1 in column p(i).
+ * Multiplying a matrix by it from the left gathers rows (row i of P * A is row p(i) of A), from the right
+ * scatters columns (column p(i) of A * P is column i of A).
+ */
+class PermutationMatrix {
+public:
+
+    /**
+     * Creates permutation from 1-based indices, throws if it is not a permutation.
+     */
+    explicit PermutationMatrix(const std::vector<int>& permutation) : _permutation(permutation) {
+        if (permutation.empty()) {
+            throw std::runtime_error("Cannot create matrix with nonpositive dimensions");
+        }
+
+        std::vector<bool> seen(permutation.size(), false);
+        for (int p : permutation) {
+            if (p <= 0 || p > size() || seen[p - 1]) {
+                throw std::runtime_error("Invalid permutation");
+            }
+            seen[p - 1] = true;
+        }
+    }
+
+    /**
+     * Creates NxN identity permutation.
+     */
+    static PermutationMatrix identity(int size) {
+        if (!(size > 0)) {
+            throw std::runtime_error("Cannot create matrix with nonpositive dimensions");
+        }
+
+        std::vector<int> permutation(size);
+        for (int i = 0; i < size; ++i) {
+            permutation[i] = i + 1;
+        }
+        return PermutationMatrix(permutation);
+    }
+
+    /**
+     * Creates permutation swapping two rows of the identity.
+     */
+    static PermutationMatrix swap(int size, int first, int second) {
+        PermutationMatrix result = identity(size);
+        std::swap(result._permutation.at(first - 1), result._permutation.at(second - 1));
+        return result;
+    }
+
+    int size() const {
+        return static_cast<int>(_permutation.size());
+    }
+
+    /**
+     * Returns p(i), column of the 1 in i-th row.
+     */
+    int operator[](int row) const {
+        if (row <= 0 || row > size()) {
+            throw std::runtime_error("Invalid element access");
+        }
+        return _permutation[row - 1];
+    }
+
+    /**
+     * Gets element at the specific coordinates, 0 or 1.
+     */
+    int at(int row, int col) const {
+        if (col <= 0 || col > size()) {
+            throw std::runtime_error("Invalid element access");
+        }
+        return (*this)[row] == col ? 1 : 0;
+    }
+
+    template<class T>
+    Matrix<T> to_dense() const {
+        Matrix<T> result = Matrix<T>::zeros(size(), size());
+        for (int i = 1; i <= size(); ++i) {
+            result.at(i, (*this)[i]) = 1;
+        }
+        return result;
+    }
+
+    /**
+     * Returns inverse permutation, which is also the transposition.
+     */
+    PermutationMatrix inverse() const {
+        std::vector<int> inverted(size());
+        for (int i = 0; i < size(); ++i) {
+            inverted[_permutation[i] - 1] = i + 1;
+        }
+        return PermutationMatrix(inverted);
+    }
+
+    PermutationMatrix transpose() const {
+        return inverse();
+    }
+
+    /**
+     * Composes permutations, the result is permutation matrix P * Q.
+     */
+    PermutationMatrix operator*(const PermutationMatrix& other) const {
+        if (other.size() != size()) {
+            throw std::runtime_error("Cannot multiply, invalid dimensions");
+        }
+
+        std::vector<int> composed(size());
+        for (int i = 0; i < size(); ++i) {
+            composed[i] = other._permutation[_permutation[i] - 1];
+        }
+        return PermutationMatrix(composed);
+    }
+
+    /**
+     * Gathers rows of the matrix, P * A.
+     */
+    template<class T>
+    Matrix<T> operator*(const Matrix<T>& other) const {
+        if (other.rows() != size()) {
+            throw std::runtime_error("Cannot multiply, invalid dimensions");
+        }
+
+        Matrix<T> result = Matrix<T>::zeros(other.rows(), other.cols());
+        int width = other.cols();
+        structured_detail::product_rows(other.rows(), width, [&](int i) {
+            const T* source = other.row_data(_permutation[i - 1]);
+            std::copy(source, source + width, result.row_data(i));
+        });
+        return result;
+    }
+
+    template<class T>
+    Vector<T> operator*(const Vector<T>& x) const {
+        if (x.size() != size()) {
+            throw std::runtime_error("Cannot multiply, invalid dimensions");
+        }
+
+        Vector<T> result = Vector<T>::zeros(size());
+        for (int i = 0; i < size(); ++i) {
+            result.data()[i] = x.data()[_permutation[i] - 1];
+        }
+        return result;
+    }
+
+    bool operator==(const PermutationMatrix& other) const {
+        return _permutation == other._permutation;
+    }
+
+    bool operator!=(const PermutationMatrix& other) const {
+        return !(*this == other);
+    }
+
+private:
+    std::vector<int> _permutation;
+};
+
+/**
+ * Scatters columns of the matrix, A * P.
+ */
+template<class T>
+Matrix<T> operator*(const Matrix<T>& matrix, const PermutationMatrix& permutation) {
+    if (matrix.cols() != permutation.size()) {
+        throw std::runtime_error("Cannot multiply, invalid dimensions");
+    }
+
+    Matrix<T> result = Matrix<T>::zeros(matrix.rows(), matrix.cols());
+    int width = matrix.cols();
+    std::vector<int> targets(width);
+    for (int j = 0; j < width; ++j) {
+        targets[j] = permutation[j + 1] - 1;
+    }
+    structured_detail::product_rows(matrix.rows(), width, [&](int i) {
+        const T* source = matrix.row_data(i);
+        T* out = result.row_data(i);
+        for (int j = 0; j < width; ++j) {
+            out[targets[j]] = source[j];
+        }
+    });
+    return result;
+}
+
+/**
+ * Product with identity from the right is a copy.
+ */
+template<class T>
+Matrix<T> operator*(const Matrix<T>& matrix, const IdentityMatrix<T>& identity) {
+    if (matrix.cols() != identity.size()) {
+        throw std::runtime_error("Cannot multiply, invalid dimensions");
+    }
+    return matrix.clone();
+}
+
+#endif
@@ -0,0 +1,175 @@
+#ifndef _SYMMETRIC_MATRIX_H
+#define _SYMMETRIC_MATRIX_H
+
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+#include "Matrix.h"
+#include "Vector.h"
+#include "Parallel.h"
+
+/**
+ * Symmetric NxN matrix in packed storage: only the lower triangle is kept, row by row, so row i
+ * (counting from 1) has i contiguous elements. Takes n(n+1)/2 elements instead of n^2.
+ */
+template<class T>
+class SymmetricMatrix {
+public:
+
+    /**
+     * Creates NxN symmetric matrix filled with zeros.
+     */
+    static SymmetricMatrix<T> zeros(int size) {
+        if (!(size > 0)) {
+            throw std::runtime_error("Cannot create matrix with nonpositive dimensions");
+        }
+
+        return SymmetricMatrix<T>(size);
+    }
+
+    /**
+     * Creates symmetric matrix from the lower triangle of a square dense matrix, upper triangle is ignored.
+     */
+    static SymmetricMatrix<T> from_dense(const Matrix<T>& dense) {
+        if (dense.rows() != dense.cols()) {
+            throw std::runtime_error("Cannot create symmetric matrix from non-square matrix");
+        }
+
+        SymmetricMatrix<T> result(dense.rows());
+        for (int i = 1; i <= result._size; ++i) {
+            std::copy(dense.row_data(i), dense.row_data(i) + i, result.row_data(i));
+        }
+        return result;
+    }
+
+    /**
+     * Computes A * A^T. Only the lower half of the result is computed, which takes half of the flops
+     * of a general product.
+     */
+    static SymmetricMatrix<T> syrk(const Matrix<T>& a) {
+        SymmetricMatrix<T> result(a.rows());
+        int cols = a.cols();
+        int grain = std::max(1, PARALLEL_THRESHOLD / std::max(1, cols * a.rows() / 2));
+        parallel_for(1, a.rows() + 1, grain, [&](int from, int to) {
+            for (int i = from; i < to; ++i) {
+                T* out = result.row_data(i);
+                for (int j = 1; j <= i; ++j) {
+                    out[j - 1] = Vector<T>::dot_kernel(a.row_data(i), a.row_data(j), cols);
+                }
+            }
+        });
+        return result;
+    }
+
+    /**
+     * Returns number of rows and columns.
+     */
+    int size() const {
+        return _size;
+    }
+
+    /**
+     * Gets element at the specific coordinates. Elements (i, j) and (j, i) are the same element.
+     */
+    T& at(int row, int col) {
+        return _data[offset(row, col)];
+    }
+
+    const T& at(int row, int col) const {
+        return _data[offset(row, col)];
+    }
+
+    /**
+     * Converts to a dense matrix.
+     */
+    Matrix<T> to_dense() const {
+        Matrix<T> result = Matrix<T>::zeros(_size, _size);
+        for (int i = 1; i <= _size; ++i) {
+            for (int j = 1; j <= _size; ++j) {
+                result.at(i, j) = at(i, j);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Symmetric matrix-vector product.
+     */
+    Vector<T> operator*(const Vector<T>& x) const {
+        if (x.size() != _size) {
+            throw std::runtime_error("Cannot multiply, invalid dimensions");
+        }
+
+        Vector<T> y = Vector<T>::zeros(_size);
+        const T* in = x.data();
+        T* out = y.data();
+        for (int i = 1; i <= _size; ++i) {
+            const T* row = row_data(i);
+            out[i - 1] += Vector<T>::dot_kernel(row, in, i);
+            // strictly lower part of the row is also column i of the upper triangle
+            Vector<T>::axpy_kernel(in[i - 1], row, out, i - 1);
+        }
+        return y;
+    }
+
+    /**
+     * Product of symmetric and dense matrix (symm), the result is dense. Every stored element is read once
+     * and used for both (i, j) and (j, i).
+     */
+    Matrix<T> operator*(const Matrix<T>& b) const {
+        if (b.rows() != _size) {
+            throw std::runtime_error("Cannot multiply, invalid dimensions");
+        }
+
+        Matrix<T> result = Matrix<T>::zeros(_size, b.cols());
+        int width = b.cols();
+        for (int i = 1; i <= _size; ++i) {
+            const T* row = row_data(i);
+            T* out = result.row_data(i);
+            for (int j = 1; j < i; ++j) {
+                Vector<T>::axpy_kernel(row[j - 1], b.row_data(j), out, width);
+                Vector<T>::axpy_kernel(row[j - 1], b.row_data(i), result.row_data(j), width);
+            }
+            Vector<T>::axpy_kernel(row[i - 1], b.row_data(i), out, width);
+        }
+        return result;
+    }
+
+    bool operator==(const SymmetricMatrix& other) const {
+        return _size == other._size && _data == other._data;
+    }
+
+    bool operator!=(const SymmetricMatrix& other) const {
+        return !(*this == other);
+    }
+
+private:
+
+    // number of multiplications below which products stay on one thread
+    static const int PARALLEL_THRESHOLD = 1 << 16;
+
+    int _size;
+    std::vector<T> _data;
+
+    explicit SymmetricMatrix(int size) : _size(size), _data(static_cast<size_t>(size) * (size + 1) / 2) {}
+
+    T* row_data(int row) {
+        return &_data[static_cast<size_t>(row) * (row - 1) / 2];
+    }
+
+    const T* row_data(int row) const {
+        return &_data[static_cast<size_t>(row) * (row - 1) / 2];
+    }
+
+    size_t offset(int row, int col) const {
+        if (row <= 0 || col <= 0 || row > _size || col > _size) {
+            throw std::runtime_error("Invalid element access");
+        }
+        if (col > row) {
+            std::swap(row, col);
+        }
+        return static_cast<size_t>(row) * (row - 1) / 2 + (col - 1);
+    }
+};
+
+#endif
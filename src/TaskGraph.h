@@ -0,0 +1,191 @@
+#ifndef _TASK_GRAPH_H
+#define _TASK_GRAPH_H
+
+#include <stdexcept>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include "Parallel.h"
+
+/**
+ * Dynamic dependency-aware scheduler. Data (typically tiles of a matrix) is represented by handles, tasks
+ * declare which handles they read and write. Dependencies follow the submission order: a task waits for
+ * the last writer of everything it accesses and, when writing, also for all readers since that write.
+ * Tasks become ready as soon as their predecessors finish and run on the work-stealing pool while further
+ * tasks are still being submitted.
+ * Tasks must be submitted from one thread at a time.
+ */
+class TaskGraph {
+public:
+
+    struct Handle {
+        int id;
+    };
+
+    TaskGraph() : outstanding(0), failed(false) {}
+
+    ~TaskGraph() {
+        try {
+            wait();
+        } catch (...) {
+            // exception is only reported by explicit wait
+        }
+    }
+
+    /**
+     * Creates handle for a new piece of data.
+     */
+    Handle handle() {
+        handles.push_back(HandleState());
+        Handle result;
+        result.id = static_cast<int>(handles.size()) - 1;
+        return result;
+    }
+
+    /**
+     * Submits a task that reads handles in reads and reads or writes handles in writes.
+     */
+    void submit(std::function<void()> job, const std::vector<Handle>& reads, const std::vector<Handle>& writes) {
+        for (const Handle& h : reads) {
+            state(h);
+        }
+        for (const Handle& h : writes) {
+            state(h);
+        }
+
+        nodes.push_back(std::unique_ptr<Node>(new Node(std::move(job))));
+        Node* node = nodes.back().get();
+        outstanding.fetch_add(1, std::memory_order_acq_rel);
+
+        for (const Handle& h : reads) {
+            depend(node, state(h).writer);
+        }
+        for (const Handle& h : writes) {
+            depend(node, state(h).writer);
+            for (Node* reader : state(h).readers) {
+                depend(node, reader);
+            }
+        }
+
+        for (const Handle& h : reads) {
+            state(h).readers.push_back(node);
+        }
+        for (const Handle& h : writes) {
+            state(h).writer = node;
+            state(h).readers.clear();
+        }
+
+        // the initial count of one guarded against predecessors finishing while edges were added
+        release(node);
+    }
+
+    /**
+     * Returns number of tasks submitted since the last wait.
+     */
+    int tasks() const {
+        return static_cast<int>(nodes.size());
+    }
+
+    /**
+     * Waits for all submitted tasks, helping to execute them. Rethrows the first exception thrown by a task,
+     * tasks which had not started before the failure are skipped.
+     */
+    void wait() {
+        ParallelScheduler::instance().help_until([this]() {
+            return outstanding.load(std::memory_order_acquire) == 0;
+        });
+
+        nodes.clear();
+        for (HandleState& h : handles) {
+            h.writer = nullptr;
+            h.readers.clear();
+        }
+
+        if (failed) {
+            failed = false;
+            std::exception_ptr exception = error;
+            error = nullptr;
+            std::rethrow_exception(exception);
+        }
+    }
+
+private:
+
+    struct Node {
+        std::function<void()> job;
+        std::atomic<int> dependencies;
+        std::mutex mutex;
+        bool finished;
+        std::vector<Node*> successors;
+
+        explicit Node(std::function<void()> job) : job(std::move(job)), dependencies(1), finished(false) {}
+    };
+
+    struct HandleState {
+        Node* writer;
+        std::vector<Node*> readers;
+
+        HandleState() : writer(nullptr) {}
+    };
+
+    std::vector<std::unique_ptr<Node> > nodes;
+    std::vector<HandleState> handles;
+    std::atomic<int> outstanding;
+    std::atomic<bool> failed;
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    HandleState& state(const Handle& h) {
+        if (h.id < 0 || h.id >= static_cast<int>(handles.size())) {
+            throw std::runtime_error("Invalid data handle");
+        }
+        return handles[h.id];
+    }
+
+    void depend(Node* node, Node* predecessor) {
+        if (predecessor == nullptr || predecessor == node) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(predecessor->mutex);
+        if (!predecessor->finished) {
+            node->dependencies.fetch_add(1, std::memory_order_relaxed);
+            predecessor->successors.push_back(node);
+        }
+    }
+
+    void release(Node* node) {
+        if (node->dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            parallel_submit([this, node]() { execute(node); });
+        }
+    }
+
+    void execute(Node* node) {
+        if (!failed.load(std::memory_order_acquire)) {
+            try {
+                node->job();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!failed) {
+                    error = std::current_exception();
+                    failed = true;
+                }
+            }
+        }
+
+        std::vector<Node*> ready;
+        {
+            std::lock_guard<std::mutex> lock(node->mutex);
+            node->finished = true;
+            ready.swap(node->successors);
+        }
+        for (Node* successor : ready) {
+            release(successor);
+        }
+        outstanding.fetch_sub(1, std::memory_order_acq_rel);
+    }
+};
+
+#endif
@@ -0,0 +1,259 @@
+#ifndef _TEXT_H
+#define _TEXT_H
+
+#include <stdexcept>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cctype>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include "Parallel.h"
+
+#include <unistd.h>
+
+// Numbers in text formats (Matrix Market, CSV). Files are mapped into memory, which is not terminated,
+// so parsing works on ranges [position, end). Large files are split into byte ranges of whole lines,
+// parsed in parallel; memchr does the scanning for line ends and separators, vectorized by the C library.
+
+// bytes of a file parsed by one task
+const size_t TEXT_CHUNK = 1 << 20;
+
+// elements formatted at once when writing
+const int TEXT_BATCH = 1 << 20;
+
+// size of buffer large enough for any number formatted by text_format
+const int TEXT_NUMBER = 48;
+
+inline const char* text_blank(const char* position, const char* end) {
+    while (position < end && (*position == ' ' || *position == '\t' || *position == '\r')) {
+        ++position;
+    }
+    return position;
+}
+
+inline const char* text_line_end(const char* position, const char* end) {
+    const char* newline = static_cast<const char*>(std::memchr(position, '\n', end - position));
+    return newline != nullptr ? newline : end;
+}
+
+/**
+ * Splits bytes from begin to end into ranges of whole lines for parallel parsing, returns their bounds.
+ */
+inline std::vector<size_t> text_chunks(const char* bytes, size_t begin, size_t end) {
+    size_t count = std::max<size_t>(1, std::min<size_t>(parallel_threads() * 4, (end - begin) / TEXT_CHUNK));
+    std::vector<size_t> bounds(1, begin);
+    for (size_t c = 1; c < count; ++c) {
+        size_t split = begin + (end - begin) / count * c;
+        const char* newline = static_cast<const char*>(std::memchr(bytes + split, '\n', end - split));
+        split = newline != nullptr ? newline - bytes + 1 : end;
+        if (split > bounds.back() && split < end) {
+            bounds.push_back(split);
+        }
+    }
+    bounds.push_back(end);
+    return bounds;
+}
+
+/**
+ * Parses decimal integer at position, moving past it. Returns false if there is none.
+ */
+inline bool text_integer(const char*& position, const char* end, long long& value) {
+    const char* p = position;
+    bool negative = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+')) {
+        ++p;
+    }
+    if (p == end || *p < '0' || *p > '9') {
+        return false;
+    }
+
+    unsigned long long magnitude = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+        if (magnitude > (std::numeric_limits<unsigned long long>::max() - 9) / 10) {
+            return false;
+        }
+        magnitude = magnitude * 10 + (*p - '0');
+    }
+    if (magnitude > static_cast<unsigned long long>(std::numeric_limits<long long>::max())) {
+        return false;
+    }
+    value = negative ? -static_cast<long long>(magnitude) : static_cast<long long>(magnitude);
+    position = p;
+    return true;
+}
+
+/**
+ * Parses real number at position, moving past it. Returns false if there is none.
+ *
+ * Numbers with at most 19 significant digits whose mantissa is exact as double and with a small exponent
+ * are computed directly with a single rounding, which is exact (Clinger's fast path). Others (long mantissas,
+ * large exponents, inf, nan) go to strtod.
+ */
+inline bool text_real(const char*& position, const char* end, double& value) {
+    static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    const char* start = position;
+    const char* p = start;
+    bool negative = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+')) {
+        ++p;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0, exponent = 0;
+    bool any = false;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p, any = true) {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits += mantissa != 0;
+        } else {
+            ++digits;
+            ++exponent;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p, any = true) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits += mantissa != 0;
+                --exponent;
+            } else {
+                ++digits;
+            }
+        }
+    }
+    if (any && p + 1 < end && (*p == 'e' || *p == 'E') &&
+        (p[1] == '-' || p[1] == '+' || (p[1] >= '0' && p[1] <= '9'))) {
+        const char* power = p + 1;
+        long long shift;
+        if (!text_integer(power, end, shift) || power - p - 1 > 8) {
+            return false;
+        }
+        exponent += static_cast<int>(shift);
+        p = power;
+    }
+
+    if (any && digits <= 19 && mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+        double result = static_cast<double>(mantissa);
+        result = exponent < 0 ? result / powers[-exponent] : result * powers[exponent];
+        value = negative ? -result : result;
+        position = p;
+        return true;
+    }
+
+    // slow path on a terminated copy of the token, the mapping itself is not terminated; long tokens
+    // (many digits) are copied to the heap
+    const char* token = start;
+    while (token < end && !std::isspace(static_cast<unsigned char>(*token))) {
+        ++token;
+    }
+    if (token == start) {
+        return false;
+    }
+    size_t length = static_cast<size_t>(token - start);
+    char buffer[128];
+    std::string long_token;
+    const char* text = buffer;
+    if (length < sizeof(buffer)) {
+        std::memcpy(buffer, start, length);
+        buffer[length] = '\0';
+    } else {
+        long_token.assign(start, token);
+        text = long_token.c_str();
+    }
+    char* parsed;
+    value = std::strtod(text, &parsed);
+    if (parsed == text) {
+        return false;
+    }
+    position = start + (parsed - text);
+    return true;
+}
+
+inline bool text_round_trips(const char* text, float value) {
+    return std::strtof(text, nullptr) == value;
+}
+
+inline bool text_round_trips(const char* text, double value) {
+    return std::strtod(text, nullptr) == value;
+}
+
+inline bool text_round_trips(const char* text, long double value) {
+    return std::strtold(text, nullptr) == value;
+}
+
+/**
+ * Formats floating point value with the fewest significant digits that read back exactly, trying from
+ * digits10 up to max_digits10.
+ */
+template<class T>
+int text_format(char* buffer, T value, std::true_type) {
+    if (!std::isfinite(value)) {
+        return std::snprintf(buffer, TEXT_NUMBER, "%g", static_cast<double>(value));
+    }
+    for (int precision = std::numeric_limits<T>::digits10; ; ++precision) {
+        int length = std::snprintf(buffer, TEXT_NUMBER, "%.*Lg", precision, static_cast<long double>(value));
+        if (precision >= std::numeric_limits<T>::max_digits10 || text_round_trips(buffer, value)) {
+            return length;
+        }
+    }
+}
+
+/**
+ * Formats integer value, digits are produced from the end.
+ */
+template<class T>
+int text_format(char* buffer, T value, std::false_type) {
+    bool negative = value < T(0);
+    unsigned long long magnitude = negative ? 0ULL - static_cast<unsigned long long>(value) :
+                                   static_cast<unsigned long long>(value);
+    char digits[24];
+    int count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+
+    int length = 0;
+    if (negative) {
+        buffer[length++] = '-';
+    }
+    while (count > 0) {
+        buffer[length++] = digits[--count];
+    }
+    return length;
+}
+
+/**
+ * Formats value into buffer of TEXT_NUMBER characters (not terminated), returns number of characters.
+ * Floating point values are formatted with the shortest text read back exactly.
+ */
+template<class T>
+int text_format(char* buffer, T value) {
+    return text_format(buffer, value, std::is_floating_point<T>());
+}
+
+/**
+ * Writes whole text to the file.
+ */
+inline void text_write(int fd, const std::string& text, const std::string& path) {
+    const char* data = text.data();
+    size_t length = text.size();
+    while (length > 0) {
+        ssize_t written = ::write(fd, data, length);
+        if (written < 0) {
+            throw std::runtime_error("Cannot write file " + path);
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+    }
+}
+
+#endif
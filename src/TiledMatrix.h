@@ -0,0 +1,336 @@
+#ifndef _TILED_MATRIX_H
+#define _TILED_MATRIX_H
+
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include "Matrix.h"
+#include "Vector.h"
+#include "TaskGraph.h"
+
+/**
+ * Matrix split into a grid of separately stored tiles of size NBxNB (tiles in the last row and column
+ * may be smaller). Tiles are units of work for algorithms expressed as task graphs, such as the tiled
+ * LU and Cholesky factorizations below.
+ */
+template<class T>
+class TiledMatrix {
+public:
+
+    /**
+     * Splits dense matrix into tiles of given size.
+     */
+    static TiledMatrix<T> from_dense(const Matrix<T>& dense, int tile_size) {
+        if (!(tile_size > 0)) {
+            throw std::runtime_error("Cannot create tiled matrix with nonpositive tile size");
+        }
+
+        TiledMatrix<T> result(dense.rows(), dense.cols(), tile_size);
+        for (int i = 1; i <= result._tile_rows; ++i) {
+            for (int j = 1; j <= result._tile_cols; ++j) {
+                Matrix<T>& t = result.tile(i, j);
+                for (int r = 1; r <= t.rows(); ++r) {
+                    const T* row = dense.row_data((i - 1) * tile_size + r) + (j - 1) * tile_size;
+                    std::copy(row, row + t.cols(), t.row_data(r));
+                }
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Joins tiles back into a dense matrix.
+     */
+    Matrix<T> to_dense() const {
+        Matrix<T> result = Matrix<T>::zeros(_rows, _cols);
+        for (int i = 1; i <= _tile_rows; ++i) {
+            for (int j = 1; j <= _tile_cols; ++j) {
+                result.put(tile(i, j), (i - 1) * _tile_size + 1, (j - 1) * _tile_size + 1);
+            }
+        }
+        return result;
+    }
+
+    int rows() const {
+        return _rows;
+    }
+
+    int cols() const {
+        return _cols;
+    }
+
+    int tile_size() const {
+        return _tile_size;
+    }
+
+    /**
+     * Returns number of tiles vertically.
+     */
+    int tile_rows() const {
+        return _tile_rows;
+    }
+
+    /**
+     * Returns number of tiles horizontally.
+     */
+    int tile_cols() const {
+        return _tile_cols;
+    }
+
+    /**
+     * Gets tile at the specific tile coordinates.
+     */
+    Matrix<T>& tile(int row, int col) {
+        return _tiles[index(row, col)];
+    }
+
+    const Matrix<T>& tile(int row, int col) const {
+        return _tiles[index(row, col)];
+    }
+
+    /**
+     * Factorizes square matrix in place into unit lower triangular L and upper triangular U, A = LU,
+     * without pivoting, so the matrix should be diagonally dominant or positive definite. The steps run
+     * as a task graph over tiles; throws on zero pivot.
+     */
+    void lu() {
+        if (_rows != _cols) {
+            throw std::runtime_error("Cannot factorize non-square matrix");
+        }
+
+        TaskGraph graph;
+        std::vector<TaskGraph::Handle> handles = register_tiles(graph);
+        int n = _tile_rows;
+        for (int k = 1; k <= n; ++k) {
+            Matrix<T>* diagonal = &tile(k, k);
+            TaskGraph::Handle kk = handles[index(k, k)];
+            graph.submit([diagonal]() { getrf(*diagonal); }, {}, {kk});
+
+            for (int j = k + 1; j <= n; ++j) {
+                Matrix<T>* right = &tile(k, j);
+                graph.submit([diagonal, right]() { trsm_lower_unit(*diagonal, *right); },
+                             {kk}, {handles[index(k, j)]});
+            }
+            for (int i = k + 1; i <= n; ++i) {
+                Matrix<T>* below = &tile(i, k);
+                graph.submit([diagonal, below]() { trsm_upper_right(*diagonal, *below); },
+                             {kk}, {handles[index(i, k)]});
+            }
+            for (int i = k + 1; i <= n; ++i) {
+                for (int j = k + 1; j <= n; ++j) {
+                    Matrix<T>* left = &tile(i, k);
+                    Matrix<T>* top = &tile(k, j);
+                    Matrix<T>* target = &tile(i, j);
+                    graph.submit([left, top, target]() { gemm_subtract(*left, *top, *target); },
+                                 {handles[index(i, k)], handles[index(k, j)]}, {handles[index(i, j)]});
+                }
+            }
+        }
+        graph.wait();
+    }
+
+    /**
+     * Factorizes symmetric positive definite matrix in place into lower triangular L, A = LL^T.
+     * Only the lower triangle of the input is read, the upper one is zeroed. The steps run as a task graph
+     * over tiles; throws if the matrix is not positive definite.
+     */
+    void cholesky() {
+        if (_rows != _cols) {
+            throw std::runtime_error("Cannot factorize non-square matrix");
+        }
+
+        int n = _tile_rows;
+        for (int i = 1; i <= n; ++i) {
+            for (int j = i + 1; j <= n; ++j) {
+                Matrix<T>& upper = tile(i, j);
+                for (int r = 1; r <= upper.rows(); ++r) {
+                    std::fill(upper.row_data(r), upper.row_data(r) + upper.cols(), T(0));
+                }
+            }
+        }
+
+        TaskGraph graph;
+        std::vector<TaskGraph::Handle> handles = register_tiles(graph);
+        for (int k = 1; k <= n; ++k) {
+            Matrix<T>* diagonal = &tile(k, k);
+            TaskGraph::Handle kk = handles[index(k, k)];
+            graph.submit([diagonal]() { potrf(*diagonal); }, {}, {kk});
+
+            for (int i = k + 1; i <= n; ++i) {
+                Matrix<T>* below = &tile(i, k);
+                graph.submit([diagonal, below]() { trsm_lower_transposed(*diagonal, *below); },
+                             {kk}, {handles[index(i, k)]});
+            }
+            for (int i = k + 1; i <= n; ++i) {
+                Matrix<T>* left = &tile(i, k);
+                Matrix<T>* target = &tile(i, i);
+                graph.submit([left, target]() { syrk_subtract(*left, *target); },
+                             {handles[index(i, k)]}, {handles[index(i, i)]});
+                for (int j = k + 1; j < i; ++j) {
+                    Matrix<T>* top = &tile(j, k);
+                    Matrix<T>* off = &tile(i, j);
+                    graph.submit([left, top, off]() { gemm_transposed_subtract(*left, *top, *off); },
+                                 {handles[index(i, k)], handles[index(j, k)]}, {handles[index(i, j)]});
+                }
+            }
+        }
+        graph.wait();
+    }
+
+private:
+
+    int _rows, _cols, _tile_size, _tile_rows, _tile_cols;
+    std::vector<Matrix<T> > _tiles;
+
+    TiledMatrix(int rows, int cols, int tile_size)
+            : _rows(rows), _cols(cols), _tile_size(tile_size),
+              _tile_rows((rows + tile_size - 1) / tile_size), _tile_cols((cols + tile_size - 1) / tile_size) {
+        _tiles.reserve(static_cast<size_t>(_tile_rows) * _tile_cols);
+        for (int i = 1; i <= _tile_rows; ++i) {
+            for (int j = 1; j <= _tile_cols; ++j) {
+                _tiles.push_back(Matrix<T>::zeros(std::min(tile_size, rows - (i - 1) * tile_size),
+                                                  std::min(tile_size, cols - (j - 1) * tile_size)));
+            }
+        }
+    }
+
+    size_t index(int row, int col) const {
+        if (row <= 0 || col <= 0 || row > _tile_rows || col > _tile_cols) {
+            throw std::runtime_error("Invalid tile access");
+        }
+        return static_cast<size_t>(row - 1) * _tile_cols + (col - 1);
+    }
+
+    std::vector<TaskGraph::Handle> register_tiles(TaskGraph& graph) const {
+        std::vector<TaskGraph::Handle> handles;
+        for (size_t i = 0; i < _tiles.size(); ++i) {
+            handles.push_back(graph.handle());
+        }
+        return handles;
+    }
+
+    /**
+     * LU without pivoting of a single tile.
+     */
+    static void getrf(Matrix<T>& a) {
+        int n = a.rows();
+        for (int k = 1; k <= n; ++k) {
+            const T* pivot_row = a.row_data(k);
+            T pivot = pivot_row[k - 1];
+            if (pivot == 0) {
+                throw std::runtime_error("Cannot factorize, zero pivot");
+            }
+            for (int i = k + 1; i <= n; ++i) {
+                T* row = a.row_data(i);
+                row[k - 1] /= pivot;
+                Vector<T>::axpy_kernel(-row[k - 1], pivot_row + k, row + k, n - k);
+            }
+        }
+    }
+
+    /**
+     * B = L^-1 B, with L the unit lower triangle of a.
+     */
+    static void trsm_lower_unit(const Matrix<T>& a, Matrix<T>& b) {
+        int width = b.cols();
+        for (int i = 2; i <= b.rows(); ++i) {
+            const T* l = a.row_data(i);
+            T* out = b.row_data(i);
+            for (int k = 1; k < i; ++k) {
+                Vector<T>::axpy_kernel(-l[k - 1], b.row_data(k), out, width);
+            }
+        }
+    }
+
+    /**
+     * B = B U^-1, with U the upper triangle of a.
+     */
+    static void trsm_upper_right(const Matrix<T>& a, Matrix<T>& b) {
+        int n = a.rows();
+        for (int i = 1; i <= b.rows(); ++i) {
+            T* x = b.row_data(i);
+            for (int j = 1; j <= n; ++j) {
+                const T* u = a.row_data(j);
+                x[j - 1] /= u[j - 1];
+                Vector<T>::axpy_kernel(-x[j - 1], u + j, x + j, n - j);
+            }
+        }
+    }
+
+    /**
+     * C = C - AB.
+     */
+    static void gemm_subtract(const Matrix<T>& a, const Matrix<T>& b, Matrix<T>& c) {
+        int width = c.cols();
+        for (int i = 1; i <= c.rows(); ++i) {
+            const T* left = a.row_data(i);
+            T* out = c.row_data(i);
+            for (int k = 1; k <= a.cols(); ++k) {
+                Vector<T>::axpy_kernel(-left[k - 1], b.row_data(k), out, width);
+            }
+        }
+    }
+
+    /**
+     * Cholesky factorization of a single tile, upper triangle is zeroed.
+     */
+    static void potrf(Matrix<T>& a) {
+        int n = a.rows();
+        for (int j = 1; j <= n; ++j) {
+            T* diagonal_row = a.row_data(j);
+            T d = diagonal_row[j - 1] - Vector<T>::dot_kernel(diagonal_row, diagonal_row, j - 1);
+            if (!(d > 0)) {
+                throw std::runtime_error("Cannot factorize, matrix is not positive definite");
+            }
+            diagonal_row[j - 1] = std::sqrt(d);
+            std::fill(diagonal_row + j, diagonal_row + n, T(0));
+            for (int i = j + 1; i <= n; ++i) {
+                T* row = a.row_data(i);
+                row[j - 1] = (row[j - 1] - Vector<T>::dot_kernel(row, diagonal_row, j - 1)) / diagonal_row[j - 1];
+            }
+        }
+    }
+
+    /**
+     * B = B L^-T, with L the lower triangle of a.
+     */
+    static void trsm_lower_transposed(const Matrix<T>& a, Matrix<T>& b) {
+        int n = a.rows();
+        for (int i = 1; i <= b.rows(); ++i) {
+            T* x = b.row_data(i);
+            for (int j = 1; j <= n; ++j) {
+                const T* l = a.row_data(j);
+                x[j - 1] = (x[j - 1] - Vector<T>::dot_kernel(x, l, j - 1)) / l[j - 1];
+            }
+        }
+    }
+
+    /**
+     * C = C - AA^T, only the lower triangle of C is updated.
+     */
+    static void syrk_subtract(const Matrix<T>& a, Matrix<T>& c) {
+        int depth = a.cols();
+        for (int i = 1; i <= c.rows(); ++i) {
+            T* out = c.row_data(i);
+            for (int j = 1; j <= i; ++j) {
+                out[j - 1] -= Vector<T>::dot_kernel(a.row_data(i), a.row_data(j), depth);
+            }
+        }
+    }
+
+    /**
+     * C = C - AB^T.
+     */
+    static void gemm_transposed_subtract(const Matrix<T>& a, const Matrix<T>& b, Matrix<T>& c) {
+        int depth = a.cols();
+        for (int i = 1; i <= c.rows(); ++i) {
+            T* out = c.row_data(i);
+            for (int j = 1; j <= c.cols(); ++j) {
+                out[j - 1] -= Vector<T>::dot_kernel(a.row_data(i), b.row_data(j), depth);
+            }
+        }
+    }
+};
+
+#endif
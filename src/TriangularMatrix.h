@@ -0,0 +1,220 @@
+#ifndef _TRIANGULAR_MATRIX_H
+#define _TRIANGULAR_MATRIX_H
+
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+#include "Matrix.h"
+#include "Vector.h"
+#include "Parallel.h"
+
+/**
+ * Square lower or upper triangular matrix in packed storage. Only the triangle is kept, row by row,
+ * so every row is contiguous: row i (counting from 1) holds columns 1..i for lower and i..n for upper
+ * matrices. Takes n(n+1)/2 elements instead of n^2.
+ */
+template<class T>
+class TriangularMatrix {
+public:
+
+    enum Part {
+        LOWER, UPPER
+    };
+
+    /**
+     * Creates NxN triangular matrix filled with zeros.
+     */
+    static TriangularMatrix<T> zeros(int size, Part part) {
+        if (!(size > 0)) {
+            throw std::runtime_error("Cannot create matrix with nonpositive dimensions");
+        }
+
+        return TriangularMatrix<T>(size, part);
+    }
+
+    /**
+     * Creates triangular matrix from the selected triangle of a square dense matrix, the rest is ignored.
+     */
+    static TriangularMatrix<T> from_dense(const Matrix<T>& dense, Part part) {
+        if (dense.rows() != dense.cols()) {
+            throw std::runtime_error("Cannot create triangular matrix from non-square matrix");
+        }
+
+        TriangularMatrix<T> result(dense.rows(), part);
+        for (int i = 1; i <= result._size; ++i) {
+            const T* row = dense.row_data(i) + result.first_col(i) - 1;
+            std::copy(row, row + result.row_length(i), result.row_data(i));
+        }
+        return result;
+    }
+
+    /**
+     * Returns number of rows and columns.
+     */
+    int size() const {
+        return _size;
+    }
+
+    /**
+     * Returns which triangle is stored.
+     */
+    Part part() const {
+        return _part;
+    }
+
+    /**
+     * Gets element at the specific coordinates. Only elements inside of the triangle can be accessed.
+     */
+    T& at(int row, int col) {
+        return _data[offset(row, col)];
+    }
+
+    const T& at(int row, int col) const {
+        return _data[offset(row, col)];
+    }
+
+    /**
+     * Converts to a dense matrix.
+     */
+    Matrix<T> to_dense() const {
+        Matrix<T> result = Matrix<T>::zeros(_size, _size);
+        for (int i = 1; i <= _size; ++i) {
+            std::copy(row_data(i), row_data(i) + row_length(i), result.row_data(i) + first_col(i) - 1);
+        }
+        return result;
+    }
+
+    /**
+     * Triangular matrix-vector product.
+     */
+    Vector<T> operator*(const Vector<T>& x) const {
+        if (x.size() != _size) {
+            throw std::runtime_error("Cannot multiply, invalid dimensions");
+        }
+
+        Vector<T> y = Vector<T>::zeros(_size);
+        for (int i = 1; i <= _size; ++i) {
+            y.data()[i - 1] = Vector<T>::dot_kernel(row_data(i), x.data() + first_col(i) - 1, row_length(i));
+        }
+        return y;
+    }
+
+    /**
+     * Product of triangular and dense matrix (trmm), the result is dense. Zero triangle is skipped,
+     * which halves the flops of a general product.
+     */
+    Matrix<T> operator*(const Matrix<T>& b) const {
+        if (b.rows() != _size) {
+            throw std::runtime_error("Cannot multiply, invalid dimensions");
+        }
+
+        Matrix<T> result = Matrix<T>::zeros(_size, b.cols());
+        int width = b.cols();
+        parallel_for(1, _size + 1, row_grain(width), [&](int from, int to) {
+            for (int i = from; i < to; ++i) {
+                const T* row = row_data(i);
+                T* out = result.row_data(i);
+                for (int k = 0; k < row_length(i); ++k) {
+                    Vector<T>::axpy_kernel(row[k], b.row_data(first_col(i) + k), out, width);
+                }
+            }
+        });
+        return result;
+    }
+
+    /**
+     * Solves triangular system AX=B (trsm) by forward or back substitution. Columns of B are independent
+     * and are split between threads.
+     */
+    Matrix<T> solve(const Matrix<T>& b) const {
+        if (b.rows() != _size) {
+            throw std::runtime_error("Cannot solve, invalid dimensions");
+        }
+        for (int i = 1; i <= _size; ++i) {
+            if (at(i, i) == 0) {
+                throw std::runtime_error("Cannot solve, singular triangular matrix");
+            }
+        }
+
+        Matrix<T> x = b.clone();
+        parallel_for(0, b.cols(), std::max(1, row_grain(1) / std::max(1, _size)), [&](int from, int to) {
+            int width = to - from;
+            for (int step = 0; step < _size; ++step) {
+                int i = _part == LOWER ? step + 1 : _size - step;
+                const T* row = row_data(i);
+                T* out = x.row_data(i) + from;
+                for (int k = 0; k < row_length(i); ++k) {
+                    int j = first_col(i) + k;
+                    if (j != i) {
+                        Vector<T>::axpy_kernel(-row[k], x.row_data(j) + from, out, width);
+                    }
+                }
+                T diagonal = row[i - first_col(i)];
+                for (int j = 0; j < width; ++j) {
+                    out[j] /= diagonal;
+                }
+            }
+        });
+        return x;
+    }
+
+    bool operator==(const TriangularMatrix& other) const {
+        return _size == other._size && _part == other._part && _data == other._data;
+    }
+
+    bool operator!=(const TriangularMatrix& other) const {
+        return !(*this == other);
+    }
+
+private:
+
+    // number of multiplications below which products stay on one thread
+    static const int PARALLEL_THRESHOLD = 1 << 16;
+
+    int _size;
+    Part _part;
+    std::vector<T> _data;
+
+    TriangularMatrix(int size, Part part) : _size(size), _part(part),
+                                            _data(static_cast<size_t>(size) * (size + 1) / 2) {}
+
+    int first_col(int row) const {
+        return _part == LOWER ? 1 : row;
+    }
+
+    int row_length(int row) const {
+        return _part == LOWER ? row : _size - row + 1;
+    }
+
+    size_t row_start(int row) const {
+        if (_part == LOWER) {
+            return static_cast<size_t>(row) * (row - 1) / 2;
+        }
+        // rows above have n, n - 1, ..., n - row + 2 elements
+        return static_cast<size_t>(row - 1) * (2 * _size - row + 2) / 2;
+    }
+
+    T* row_data(int row) {
+        return &_data[row_start(row)];
+    }
+
+    const T* row_data(int row) const {
+        return &_data[row_start(row)];
+    }
+
+    int row_grain(int width) const {
+        return std::max(1, PARALLEL_THRESHOLD / std::max(1, _size * width / 2));
+    }
+
+    size_t offset(int row, int col) const {
+        if (row <= 0 || col <= 0 || row > _size || col > _size) {
+            throw std::runtime_error("Invalid element access");
+        }
+        if ((_part == LOWER && col > row) || (_part == UPPER && col < row)) {
+            throw std::runtime_error("Invalid element access, element is outside of the triangle");
+        }
+        return row_start(row) + (col - first_col(row));
+    }
+};
+
+#endif
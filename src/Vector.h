@@ -0,0 +1,212 @@
+#ifndef _VECTOR_H
+#define _VECTOR_H
+
+#include <stdexcept>
+#include <vector>
+#include "Matrix.h"
+#include "Parallel.h"
+
+/**
+ * Dense column vector with contiguous storage. Elements are indexed from 1, like in Matrix.
+ */
+template<class T>
+class Vector {
+public:
+
+    /**
+     * Creates vector of N zeros.
+     */
+    static Vector<T> zeros(int size) {
+        if (!(size > 0)) {
+            throw std::runtime_error("Cannot create vector with nonpositive size");
+        }
+
+        return Vector<T>(size);
+    }
+
+    /**
+     * Copies Nx1 or 1xN matrix into a vector.
+     */
+    static Vector<T> from_matrix(const Matrix<T>& matrix) {
+        if (matrix.rows() != 1 && matrix.cols() != 1) {
+            throw std::runtime_error("Cannot convert matrix to vector, it is not Nx1 nor 1xN");
+        }
+
+        Vector<T> result(matrix.rows() * matrix.cols());
+        int k = 0;
+        for (auto& element: matrix) {
+            result._data[k++] = element;
+        }
+        return result;
+    }
+
+    /**
+     * Copies vector into a new Nx1 matrix.
+     */
+    Matrix<T> to_matrix() const {
+        Matrix<T> result = Matrix<T>::zeros(size(), 1);
+        for (int i = 1; i <= size(); ++i) {
+            result.at(i, 1) = at(i);
+        }
+        return result;
+    }
+
+    /**
+     * Returns number of elements.
+     */
+    int size() const {
+        return static_cast<int>(_data.size());
+    }
+
+    /**
+     * Gets element at the specified position.
+     */
+    T& at(int index) {
+        if (index <= 0 || index > size()) {
+            throw std::runtime_error("Invalid element access");
+        }
+        return _data[index - 1];
+    }
+
+    const T& at(int index) const {
+        if (index <= 0 || index > size()) {
+            throw std::runtime_error("Invalid element access");
+        }
+        return _data[index - 1];
+    }
+
+    /**
+     * Raw contiguous storage (0-based).
+     */
+    T* data() {
+        return _data.data();
+    }
+
+    const T* data() const {
+        return _data.data();
+    }
+
+    /**
+     * Calculates dot product of two vectors.
+     */
+    T dot(const Vector<T>& other) const {
+        if (size() != other.size()) {
+            throw std::runtime_error("Incompatible dimensions");
+        }
+        return dot_kernel(data(), other.data(), size());
+    }
+
+    bool operator==(const Vector& other) const {
+        return _data == other._data;
+    }
+
+    bool operator!=(const Vector& other) const {
+        return !(*this == other);
+    }
+
+    /**
+     * Dot product of two contiguous arrays. Four independent accumulators let the compiler keep
+     * several SIMD lanes busy without reassociating floating point sums by itself.
+     */
+    static T dot_kernel(const T* a, const T* b, int n) {
+        T s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        int i = 0;
+        for (; i + 4 <= n; i += 4) {
+            s0 += a[i] * b[i];
+            s1 += a[i + 1] * b[i + 1];
+            s2 += a[i + 2] * b[i + 2];
+            s3 += a[i + 3] * b[i + 3];
+        }
+        for (; i < n; ++i) {
+            s0 += a[i] * b[i];
+        }
+        return (s0 + s1) + (s2 + s3);
+    }
+
+    /**
+     * y += alpha * x for contiguous arrays.
+     */
+    static void axpy_kernel(T alpha, const T* x, T* y, int n) {
+        for (int i = 0; i < n; ++i) {
+            y[i] += alpha * x[i];
+        }
+    }
+
+private:
+
+    std::vector<T> _data;
+
+    explicit Vector(int size) : _data(size) {}
+};
+
+// number of matrix elements below which matrix-vector products stay on one thread
+const int GEMV_PARALLEL_THRESHOLD = 1 << 16;
+
+/**
+ * Matrix-vector product y = A * x, written into existing vector y.
+ */
+template<class T>
+void gemv(const Matrix<T>& a, const Vector<T>& x, Vector<T>& y) {
+    if (a.cols() != x.size() || a.rows() != y.size()) {
+        throw std::runtime_error("Cannot multiply, invalid dimensions");
+    }
+
+    int cols = a.cols();
+    const T* in = x.data();
+    T* out = y.data();
+    int grain = std::max(1, GEMV_PARALLEL_THRESHOLD / cols);
+
+    parallel_for(1, a.rows() + 1, grain, [&](int from, int to) {
+        for (int i = from; i < to; ++i) {
+            out[i - 1] = Vector<T>::dot_kernel(a.row_data(i), in, cols);
+        }
+    });
+}
+
+/**
+ * Matrix-vector product y = A * x.
+ */
+template<class T>
+Vector<T> gemv(const Matrix<T>& a, const Vector<T>& x) {
+    Vector<T> y = Vector<T>::zeros(a.rows());
+    gemv(a, x, y);
+    return y;
+}
+
+/**
+ * Transposed matrix-vector product y = A^T * x, written into existing vector y. Walks A row by row,
+ * so the matrix is never traversed along a column.
+ */
+template<class T>
+void gemv_transposed(const Matrix<T>& a, const Vector<T>& x, Vector<T>& y) {
+    if (a.rows() != x.size() || a.cols() != y.size()) {
+        throw std::runtime_error("Cannot multiply, invalid dimensions");
+    }
+
+    int rows = a.rows();
+    const T* in = x.data();
+    T* out = y.data();
+    int grain = std::max(1, GEMV_PARALLEL_THRESHOLD / rows);
+
+    // every thread owns a band of output columns, so no reduction is needed
+    parallel_for(0, a.cols(), grain, [&](int from, int to) {
+        for (int j = from; j < to; ++j) {
+            out[j] = 0;
+        }
+        for (int i = 1; i <= rows; ++i) {
+            Vector<T>::axpy_kernel(in[i - 1], a.row_data(i) + from, out + from, to - from);
+        }
+    });
+}
+
+/**
+ * Transposed matrix-vector product y = A^T * x.
+ */
+template<class T>
+Vector<T> gemv_transposed(const Matrix<T>& a, const Vector<T>& x) {
+    Vector<T> y = Vector<T>::zeros(a.cols());
+    gemv_transposed(a, x, y);
+    return y;
+}
+
+#endif
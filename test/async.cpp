@@ -0,0 +1,126 @@
+#include "catch.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <chrono>
+#include "../src/Async.h"
+
+TEST_CASE("Async: multiply") {
+    Matrix<int> a = Matrix<int>::natural(3, 2);
+    Matrix<int> b = Matrix<int>::natural(2, 4);
+    Matrix<int> expected = a * b;
+
+    Future<Matrix<int> > product = async_multiply(a, b);
+    // operands were copied, changing them does not affect the result
+    a.at(1, 1) = 100;
+    REQUIRE(product.get() == expected);
+    REQUIRE(product.ready());
+}
+
+TEST_CASE("Async: inverse, det and solve") {
+    Matrix<double> a = Matrix<double>::zeros(2);
+    a.at(1, 1) = 4;
+    a.at(1, 2) = 7;
+    a.at(2, 1) = 2;
+    a.at(2, 2) = 6;
+    Matrix<double> b = Matrix<double>::zeros(2, 1);
+    b.at(1, 1) = 1;
+    b.at(2, 1) = 2;
+
+    Future<Matrix<double> > inverse = async_inverse(a);
+    Future<double> det = async_det(a);
+    Future<Matrix<double> > x = async_solve(a, b);
+
+    REQUIRE(det.get() == Approx(10));
+    REQUIRE(inverse.get().at(1, 1) == Approx(0.6));
+    REQUIRE(inverse.get().at(1, 2) == Approx(-0.7));
+    REQUIRE(inverse.get().at(2, 1) == Approx(-0.2));
+    REQUIRE(inverse.get().at(2, 2) == Approx(0.4));
+    REQUIRE(x.get().at(1, 1) == Approx(-0.8));
+    REQUIRE(x.get().at(2, 1) == Approx(0.6));
+}
+
+TEST_CASE("Async: exception is delivered by get") {
+    Matrix<double> singular = Matrix<double>::zeros(2);
+    Future<Matrix<double> > inverse = async_inverse(singular);
+    REQUIRE_THROWS(inverse.get());
+
+    Future<Matrix<int> > product = async_multiply(Matrix<int>::zeros(2, 3), Matrix<int>::zeros(2, 3));
+    REQUIRE_THROWS(product.get());
+}
+
+TEST_CASE("Async: continuations are chained") {
+    Future<Matrix<int> > product = async_multiply(Matrix<int>::eye(3), Matrix<int>::natural(3, 3));
+    Future<int> trace = product.then([](const Matrix<int>& m) {
+        return m.at(1, 1) + m.at(2, 2) + m.at(3, 3);
+    });
+    Future<std::string> text = trace.then([](int value) {
+        return std::to_string(value);
+    });
+
+    REQUIRE(text.get() == "15");
+    REQUIRE(trace.get() == 15);
+}
+
+TEST_CASE("Async: continuation attached to finished future still runs") {
+    Future<int> value = async_call([]() { return 20; });
+    value.wait();
+    REQUIRE(value.ready());
+    REQUIRE(value.then([](int v) { return v + 1; }).get() == 21);
+}
+
+TEST_CASE("Async: failure skips continuations") {
+    std::atomic<bool> called(false);
+    Future<int> failing = async_call([]() -> int {
+        throw std::runtime_error("failure");
+    });
+    Future<int> next = failing.then([&called](int v) {
+        called = true;
+        return v;
+    });
+    REQUIRE_THROWS_WITH(next.get(), "failure");
+    REQUIRE(!called);
+}
+
+TEST_CASE("Async: waiting inside a pool task does not deadlock") {
+    Future<int> outer = async_call([]() {
+        Future<int> inner = async_call([]() { return 2; });
+        return inner.get() * 3;
+    });
+    REQUIRE(outer.get() == 6);
+}
+
+TEST_CASE("Async: many operations in flight") {
+    std::vector<Future<Matrix<int> > > futures;
+    for (int i = 1; i <= 50; ++i) {
+        futures.push_back(async_multiply(Matrix<int>::eye(4) * i, Matrix<int>::natural(4, 4)));
+    }
+    for (int i = 1; i <= 50; ++i) {
+        REQUIRE(futures[i - 1].get() == Matrix<int>::natural(4, 4) * i);
+    }
+}
+
+TEST_CASE("Async: changing number of threads finishes futures in flight") {
+    int previous = parallel_threads();
+    set_parallel_threads(2);
+    std::vector<Future<int> > futures;
+    for (int i = 0; i < 20; ++i) {
+        futures.push_back(async_call([i]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            return i;
+        }));
+    }
+    set_parallel_threads(3);
+    REQUIRE(parallel_threads() == 3);
+    for (int i = 0; i < 20; ++i) {
+        REQUIRE(futures[i].get() == i);
+    }
+
+    Future<int> inside = async_call([]() {
+        set_parallel_threads(1);
+        return 0;
+    });
+    REQUIRE_THROWS_WITH(inside.get(), "Cannot change number of threads from a parallel task");
+    set_parallel_threads(previous);
+}
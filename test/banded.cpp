@@ -0,0 +1,108 @@
+#include "catch.hpp"
+
+#include "../src/BandedMatrix.h"
+
+// pentadiagonal matrix that needs pivoting: zero on the first diagonal position
+BandedMatrix<double> make_pentadiagonal(int size) {
+    BandedMatrix<double> a = BandedMatrix<double>::zeros(size, 2, 2);
+    for (int i = 1; i <= size; ++i) {
+        a.at(i, i) = i == 1 ? 0 : 3 + i % 4;
+        for (int k = 1; k <= 2; ++k) {
+            if (i + k <= size) {
+                a.at(i + k, i) = k - 0.5 * i;
+                a.at(i, i + k) = 1.0 / (i + k);
+            }
+        }
+    }
+    return a;
+}
+
+TEST_CASE("BandedMatrix: only the band is accessible") {
+    BandedMatrix<int> a = BandedMatrix<int>::zeros(5, 1, 2);
+    a.at(2, 1) = 7;
+    a.at(1, 3) = 8;
+
+    REQUIRE(a.size() == 5);
+    REQUIRE(a.at(2, 1) == 7);
+    REQUIRE(a.at(1, 3) == 8);
+    REQUIRE_THROWS(a.at(3, 1));
+    REQUIRE_THROWS(a.at(1, 4));
+    REQUIRE_THROWS(a.at(6, 6));
+    REQUIRE_THROWS(BandedMatrix<int>::zeros(0, 1, 1));
+    REQUIRE_THROWS(BandedMatrix<int>::zeros(3, -1, 1));
+}
+
+TEST_CASE("BandedMatrix: dense round trip drops elements outside of the band") {
+    Matrix<int> dense = Matrix<int>::natural(4, 4);
+    Matrix<int> band = BandedMatrix<int>::from_dense(dense, 1, 0).to_dense();
+
+    REQUIRE(band.at(1, 1) == 1);
+    REQUIRE(band.at(2, 1) == 5);
+    REQUIRE(band.at(3, 1) == 0);
+    REQUIRE(band.at(1, 2) == 0);
+    REQUIRE(BandedMatrix<int>::from_dense(dense, 3, 3).to_dense() == dense);
+}
+
+TEST_CASE("BandedMatrix: matrix-vector product matches dense product") {
+    Matrix<int> dense = Matrix<int>::natural(6, 6);
+    BandedMatrix<int> a = BandedMatrix<int>::from_dense(dense, 2, 1);
+    Matrix<int> x = Matrix<int>::natural(6, 1);
+    Matrix<int> band = a.to_dense();
+
+    REQUIRE((a * Vector<int>::from_matrix(x)).to_matrix() == band * x);
+    REQUIRE_THROWS(a * Vector<int>::zeros(5));
+}
+
+TEST_CASE("BandedMatrix: Thomas algorithm solves large tridiagonal system") {
+    int n = 100000;
+    BandedMatrix<double> a = BandedMatrix<double>::zeros(n, 1, 1);
+    Vector<double> x = Vector<double>::zeros(n);
+    for (int i = 1; i <= n; ++i) {
+        a.at(i, i) = 4;
+        if (i > 1) {
+            a.at(i, i - 1) = -1;
+            a.at(i - 1, i) = -2;
+        }
+        x.at(i) = i % 10;
+    }
+
+    Vector<double> solved = a.solve_tridiagonal(a * x);
+    for (int i = 1; i <= n; ++i) {
+        REQUIRE(solved.at(i) == Approx(x.at(i)));
+    }
+    REQUIRE_THROWS(make_pentadiagonal(5).solve_tridiagonal(Vector<double>::zeros(5)));
+}
+
+TEST_CASE("BandedMatrix: banded LU with pivoting") {
+    BandedMatrix<double> a = make_pentadiagonal(30);
+    Vector<double> x = Vector<double>::zeros(30);
+    for (int i = 1; i <= 30; ++i) {
+        x.at(i) = 1 + i % 3;
+    }
+
+    Vector<double> solved = a.solve(a * x);
+    for (int i = 1; i <= 30; ++i) {
+        REQUIRE(solved.at(i) == Approx(x.at(i)));
+    }
+}
+
+TEST_CASE("BandedMatrix: banded LU with multiple right hand sides") {
+    BandedMatrix<double> a = make_pentadiagonal(8);
+    Matrix<double> dense = a.to_dense();
+    Matrix<double> x = Matrix<double>::zeros(8, 2);
+    for (int i = 1; i <= 8; ++i) {
+        x.at(i, 1) = i;
+        x.at(i, 2) = -i;
+    }
+
+    Matrix<double> solved = a.solve(dense * x);
+    for (int i = 1; i <= 8; ++i) {
+        REQUIRE(solved.at(i, 1) == Approx(i));
+        REQUIRE(solved.at(i, 2) == Approx(-i));
+    }
+}
+
+TEST_CASE("BandedMatrix: singular matrix cannot be solved") {
+    REQUIRE_THROWS(BandedMatrix<double>::zeros(3, 1, 1).solve(Vector<double>::zeros(3)));
+    REQUIRE_THROWS(BandedMatrix<double>::zeros(3, 1, 1).solve_tridiagonal(Vector<double>::zeros(3)));
+}
@@ -0,0 +1,130 @@
+#include "catch.hpp"
+
+#include "../src/MatrixBatch.h"
+
+// fills batch with 3x3 matrices that differ between batch entries, entry k is natural(3, 3) + k * I
+// with element (3, 3) replaced, so every entry is regular
+MatrixBatch<double> make_batch(int count) {
+    MatrixBatch<double> batch = MatrixBatch<double>::zeros(count, 3, 3);
+    for (int k = 1; k <= count; ++k) {
+        Matrix<double> m = Matrix<double>::zeros(3, 3);
+        for (int i = 1; i <= 3; ++i) {
+            for (int j = 1; j <= 3; ++j) {
+                m.at(i, j) = j + (i - 1) * 3 + (i == j ? k : 0);
+            }
+        }
+        m.at(3, 3) = -k;
+        batch.set(k, m);
+    }
+    return batch;
+}
+
+double det3(const Matrix<double>& m) {
+    return m.at(1, 1) * (m.at(2, 2) * m.at(3, 3) - m.at(2, 3) * m.at(3, 2))
+           - m.at(1, 2) * (m.at(2, 1) * m.at(3, 3) - m.at(2, 3) * m.at(3, 1))
+           + m.at(1, 3) * (m.at(2, 1) * m.at(3, 2) - m.at(2, 2) * m.at(3, 1));
+}
+
+TEST_CASE("MatrixBatch: should create zeros and throw on invalid dimensions") {
+    MatrixBatch<int> batch = MatrixBatch<int>::zeros(5, 2, 3);
+
+    REQUIRE(batch.count() == 5);
+    REQUIRE(batch.rows() == 2);
+    REQUIRE(batch.cols() == 3);
+    REQUIRE(batch.get(5) == Matrix<int>::zeros(2, 3));
+    REQUIRE_THROWS(MatrixBatch<int>::zeros(0, 2, 2));
+    REQUIRE_THROWS(batch.at(6, 1, 1));
+    REQUIRE_THROWS(batch.at(1, 3, 1));
+}
+
+TEST_CASE("MatrixBatch: set and get round trip") {
+    MatrixBatch<int> batch = MatrixBatch<int>::zeros(3, 2, 3);
+    batch.set(2, Matrix<int>::natural(2, 3));
+
+    REQUIRE(batch.get(2) == Matrix<int>::natural(2, 3));
+    REQUIRE(batch.get(1) == Matrix<int>::zeros(2, 3));
+    REQUIRE(batch.at(2, 2, 1) == 4);
+    REQUIRE_THROWS(batch.set(1, Matrix<int>::natural(3, 2)));
+}
+
+TEST_CASE("MatrixBatch: gemm matches operator* for every entry") {
+    int count = 600;
+    MatrixBatch<int> a = MatrixBatch<int>::zeros(count, 2, 3);
+    MatrixBatch<int> b = MatrixBatch<int>::zeros(count, 3, 2);
+    for (int k = 1; k <= count; ++k) {
+        a.set(k, Matrix<int>::natural(2, 3) * k);
+        b.set(k, Matrix<int>::natural(3, 2));
+    }
+
+    MatrixBatch<int> c = MatrixBatch<int>::gemm(a, b);
+    REQUIRE(c.rows() == 2);
+    REQUIRE(c.cols() == 2);
+    for (int k = 1; k <= count; ++k) {
+        Matrix<int> left = a.get(k);
+        Matrix<int> right = b.get(k);
+        REQUIRE(c.get(k) == left * right);
+    }
+
+    REQUIRE_THROWS(MatrixBatch<int>::gemm(a, a));
+}
+
+TEST_CASE("MatrixBatch: det matches cofactor expansion") {
+    int count = 600;
+    MatrixBatch<double> batch = make_batch(count);
+
+    std::vector<double> dets = batch.det();
+    REQUIRE(dets.size() == count);
+    for (int k = 1; k <= count; ++k) {
+        REQUIRE(dets[k - 1] == Approx(det3(batch.get(k))));
+        REQUIRE(dets[k - 1] == Approx(batch.get(k).det()));
+    }
+}
+
+TEST_CASE("MatrixBatch: det of singular entries is zero") {
+    MatrixBatch<double> batch = make_batch(3);
+    batch.set(2, Matrix<double>::zeros(3, 3));
+
+    std::vector<double> dets = batch.det();
+    REQUIRE(dets[0] == Approx(det3(batch.get(1))));
+    REQUIRE(dets[1] == 0);
+    REQUIRE(dets[2] == Approx(det3(batch.get(3))));
+}
+
+TEST_CASE("MatrixBatch: inverse times matrix is identity") {
+    MatrixBatch<double> batch = make_batch(300);
+    MatrixBatch<double> product = MatrixBatch<double>::gemm(batch, batch.inverse());
+
+    for (int k = 1; k <= 300; ++k) {
+        for (int i = 1; i <= 3; ++i) {
+            for (int j = 1; j <= 3; ++j) {
+                REQUIRE(product.at(k, i, j) == Approx(i == j ? 1 : 0));
+            }
+        }
+    }
+}
+
+TEST_CASE("MatrixBatch: solve") {
+    MatrixBatch<double> a = make_batch(10);
+    MatrixBatch<double> x = MatrixBatch<double>::zeros(10, 3, 1);
+    for (int k = 1; k <= 10; ++k) {
+        x.at(k, 1, 1) = k;
+        x.at(k, 2, 1) = -1;
+        x.at(k, 3, 1) = 2;
+    }
+    MatrixBatch<double> b = MatrixBatch<double>::gemm(a, x);
+
+    MatrixBatch<double> solved = MatrixBatch<double>::solve(a, b);
+    for (int k = 1; k <= 10; ++k) {
+        for (int i = 1; i <= 3; ++i) {
+            REQUIRE(solved.at(k, i, 1) == Approx(x.at(k, i, 1)));
+        }
+    }
+}
+
+TEST_CASE("MatrixBatch: solve throws on singular entry") {
+    MatrixBatch<double> a = make_batch(4);
+    a.set(3, Matrix<double>::zeros(3, 3));
+
+    REQUIRE_THROWS(a.inverse());
+    REQUIRE_THROWS(MatrixBatch<double>::solve(a, MatrixBatch<double>::zeros(4, 3, 1)));
+}
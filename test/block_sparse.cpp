@@ -0,0 +1,121 @@
+#include "catch.hpp"
+
+#include "../src/BlockSparseMatrix.h"
+
+// 3x3 grid of 2x2 tiles with tiles at (1, 1), (1, 3), (2, 2), (3, 1), inserted out of order
+BlockSparseMatrix<int> make_block_sparse() {
+    BlockSparseMatrix<int> a = BlockSparseMatrix<int>::zeros(3, 3, 2, 2);
+    a.put(Matrix<int>::natural(2, 2) * 3, 3, 1);
+    a.put(Matrix<int>::natural(2, 2), 1, 3);
+    a.put(Matrix<int>::eye(2), 1, 1);
+    a.put(Matrix<int>::natural(2, 2) * 2, 2, 2);
+    return a;
+}
+
+TEST_CASE("BlockSparseMatrix: should create empty matrix") {
+    BlockSparseMatrix<int> a = BlockSparseMatrix<int>::zeros(2, 3, 3, 2);
+
+    REQUIRE(a.rows() == 6);
+    REQUIRE(a.cols() == 6);
+    REQUIRE(a.nonzero_blocks() == 0);
+    REQUIRE(a.to_dense() == Matrix<int>::zeros(6, 6));
+    REQUIRE_THROWS(BlockSparseMatrix<int>::zeros(1, 1, 0, 3));
+}
+
+TEST_CASE("BlockSparseMatrix: put places tiles and replaces existing ones") {
+    BlockSparseMatrix<int> a = make_block_sparse();
+
+    REQUIRE(a.nonzero_blocks() == 4);
+    REQUIRE(a.block(1, 3) == Matrix<int>::natural(2, 2));
+    REQUIRE(a.block(3, 1) == Matrix<int>::natural(2, 2) * 3);
+    REQUIRE(a.block(2, 1) == Matrix<int>::zeros(2, 2));
+    REQUIRE(a.at(1, 5) == 1);
+    REQUIRE(a.at(6, 2) == 12);
+    REQUIRE(a.at(3, 1) == 0);
+
+    a.put(Matrix<int>::eye(2), 1, 3);
+    REQUIRE(a.nonzero_blocks() == 4);
+    REQUIRE(a.block(1, 3) == Matrix<int>::eye(2));
+}
+
+TEST_CASE("BlockSparseMatrix: add accumulates tiles") {
+    BlockSparseMatrix<int> a = make_block_sparse();
+    a.add(Matrix<int>::eye(2), 1, 1);
+    a.add(Matrix<int>::eye(2), 3, 3);
+
+    REQUIRE(a.block(1, 1) == Matrix<int>::eye(2) * 2);
+    REQUIRE(a.block(3, 3) == Matrix<int>::eye(2));
+    REQUIRE(a.nonzero_blocks() == 5);
+}
+
+TEST_CASE("BlockSparseMatrix: should throw on invalid positions and tile sizes") {
+    BlockSparseMatrix<int> a = make_block_sparse();
+
+    REQUIRE_THROWS(a.put(Matrix<int>::eye(2), 0, 1));
+    REQUIRE_THROWS(a.put(Matrix<int>::eye(2), 1, 4));
+    REQUIRE_THROWS(a.put(Matrix<int>::eye(3), 1, 1));
+    REQUIRE_THROWS(a.at(7, 1));
+}
+
+TEST_CASE("BlockSparseMatrix: to_dense") {
+    Matrix<int> dense = make_block_sparse().to_dense();
+
+    REQUIRE(dense.at(1, 1) == 1);
+    REQUIRE(dense.at(2, 6) == 4);
+    REQUIRE(dense.at(4, 4) == 8);
+    REQUIRE(dense.at(5, 1) == 3);
+    REQUIRE(dense.at(4, 1) == 0);
+}
+
+TEST_CASE("BlockSparseMatrix: SpMV and SpMM match dense products") {
+    BlockSparseMatrix<int> a = make_block_sparse();
+    Matrix<int> dense = a.to_dense();
+    Matrix<int> x = Matrix<int>::natural(6, 1);
+    Matrix<int> b = Matrix<int>::natural(6, 3);
+
+    REQUIRE((a * Vector<int>::from_matrix(x)).to_matrix() == dense * x);
+    REQUIRE(a * b == dense * b);
+    REQUIRE_THROWS(a * Vector<int>::zeros(5));
+    REQUIRE_THROWS(a * Matrix<int>::natural(5, 2));
+}
+
+TEST_CASE("BlockSparseMatrix: rectangular tiles") {
+    BlockSparseMatrix<int> a = BlockSparseMatrix<int>::zeros(2, 2, 2, 3);
+    a.put(Matrix<int>::natural(2, 3), 2, 1);
+    a.put(Matrix<int>::natural(2, 3), 1, 2);
+    Matrix<int> dense = a.to_dense();
+    Matrix<int> x = Matrix<int>::natural(6, 1);
+
+    REQUIRE(dense.at(1, 4) == 1);
+    REQUIRE(dense.at(4, 3) == 6);
+    REQUIRE((a * Vector<int>::from_matrix(x)).to_matrix() == dense * x);
+}
+
+TEST_CASE("BlockSparseMatrix: assembly in block row order") {
+    // tridiagonal matrix of 1x1 tiles, assembled like finite elements: every element adds to four tiles
+    int n = 200000;
+    BlockSparseMatrix<double> a = BlockSparseMatrix<double>::zeros(n, n, 1, 1);
+    Matrix<double> element = Matrix<double>::eye(1);
+    for (int e = 1; e < n; ++e) {
+        a.add(element, e, e);
+        a.add(element * -1.0, e, e + 1);
+        a.add(element * -1.0, e + 1, e);
+        a.add(element, e + 1, e + 1);
+    }
+    REQUIRE(a.nonzero_blocks() == 3 * n - 2);
+
+    Vector<double> ones = Vector<double>::zeros(n);
+    std::fill(ones.data(), ones.data() + n, 1.0);
+    Vector<double> y = a * ones;
+    REQUIRE(y.data()[0] == 0);
+    REQUIRE(y.data()[n / 2] == 0);
+    REQUIRE(a.at(n, n) == 1);
+    REQUIRE(a.at(2, 2) == 2);
+    REQUIRE(a.at(3, 1) == 0);
+
+    // tiles before stored ones still land in their places
+    a.put(Matrix<double>::eye(1) * 5.0, 1, n);
+    REQUIRE(a.at(1, n) == 5);
+    REQUIRE(a.at(2, 1) == -1);
+    REQUIRE(a.nonzero_blocks() == 3 * n - 1);
+}
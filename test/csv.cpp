@@ -0,0 +1,132 @@
+#include "catch.hpp"
+
+#include <cstdio>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include "temp_file.h"
+#include "../src/Csv.h"
+
+static void csv_store(const std::string& path, const std::string& contents) {
+    std::ofstream file(path, std::ios::binary);
+    file << contents;
+}
+
+static std::string csv_contents(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+TEST_CASE("CSV: values, headers and missing values") {
+    TempFile temp("csv-values");
+    const std::string& path = temp.path();
+    csv_store(path, "\xEF\xBB\xBF" "x,\"y, in metres\",z\r\n"
+                    "1,2.5,-3e2\r\n"
+                    "\r\n"
+                    " 4 , \"5\" ,NA\n"
+                    "7,,nan\n");
+
+    REQUIRE(read_csv_header(path) == std::vector<std::string>({"x", "y, in metres", "z"}));
+    Matrix<double> m = load_csv<double>(path, CsvFormat(',', true));
+    REQUIRE(m.rows() == 3);
+    REQUIRE(m.cols() == 3);
+    REQUIRE(m.at(1, 2) == 2.5);
+    REQUIRE(m.at(1, 3) == -300);
+    REQUIRE(m.at(2, 1) == 4);
+    REQUIRE(m.at(2, 2) == 5);
+    REQUIRE(std::isnan(m.at(2, 3)));
+    REQUIRE(std::isnan(m.at(3, 2)));
+    REQUIRE(std::isnan(m.at(3, 3)));
+
+    REQUIRE_THROWS(load_csv<double>(path));
+    REQUIRE_THROWS_WITH(load_csv<int>(path, CsvFormat(',', true)), "Cannot load csv: invalid value '2.5' in row 1");
+
+    csv_store(path, "0." + std::string(130, '1') + ",2\n");
+    REQUIRE(load_csv<double>(path).at(1, 1) == Approx(0.111111111111111));
+
+    csv_store(path, "a\tb\n1\t-2\n3\t4\n");
+    Matrix<int> tabs = load_csv<int>(path, CsvFormat::tsv(true));
+    REQUIRE(tabs.at(1, 2) == -2);
+    REQUIRE(tabs.at(2, 1) == 3);
+    REQUIRE(read_csv_header(path, CsvFormat::tsv()) == std::vector<std::string>({"a", "b"}));
+}
+
+TEST_CASE("CSV: invalid files are rejected") {
+    TempFile temp("csv-invalid");
+    const std::string& path = temp.path();
+    REQUIRE_THROWS(load_csv<double>(path));
+
+    csv_store(path, "1,2\n3\n");
+    REQUIRE_THROWS_WITH(load_csv<double>(path), "Cannot load csv: row 2 has fewer than 2 values");
+    csv_store(path, "1,2\n3,4,5\n");
+    REQUIRE_THROWS_WITH(load_csv<double>(path), "Cannot load csv: row 2 has more than 2 values");
+    csv_store(path, "1,2\n3,x\n");
+    REQUIRE_THROWS(load_csv<double>(path));
+    csv_store(path, "1,2\n3,\n");
+    REQUIRE_THROWS_WITH(load_csv<int>(path), "Cannot load csv: missing value in row 2");
+    csv_store(path, "1,300\n");
+    REQUIRE_THROWS(load_csv<int8_t>(path));
+    REQUIRE_THROWS(load_csv<uint32_t>(path + "-missing"));
+    csv_store(path, "-1\n");
+    REQUIRE_THROWS(load_csv<uint32_t>(path));
+    csv_store(path, "a,b\n\n");
+    REQUIRE_THROWS(load_csv<double>(path, CsvFormat(',', true)));
+}
+
+TEST_CASE("CSV: numbers are written shortest and read back exactly") {
+    char buffer[TEXT_NUMBER];
+    REQUIRE(std::string(buffer, text_format(buffer, 0.1)) == "0.1");
+    REQUIRE(std::string(buffer, text_format(buffer, 1.0 / 3)) == "0.3333333333333333");
+    REQUIRE(std::string(buffer, text_format(buffer, 0.1f)) == "0.1");
+    REQUIRE(std::string(buffer, text_format(buffer, 100.0)) == "100");
+    REQUIRE(std::string(buffer, text_format(buffer, -42)) == "-42");
+    REQUIRE(std::string(buffer, text_format(buffer, std::numeric_limits<int64_t>::min())) == "-9223372036854775808");
+    REQUIRE(std::string(buffer, text_format(buffer, std::numeric_limits<uint64_t>::max())) == "18446744073709551615");
+
+    TempFile temp("csv-exact");
+    const std::string& path = temp.path();
+    Matrix<double> m = Matrix<double>::zeros(50, 7);
+    for (int i = 1; i <= m.rows(); ++i) {
+        for (int j = 1; j <= m.cols(); ++j) {
+            m.at(i, j) = std::exp(i * 0.731 - j * 3.3) * (j % 2 == 0 ? -1 : 1);
+        }
+    }
+    m.at(1, 1) = std::numeric_limits<double>::denorm_min();
+    m.at(2, 2) = std::numeric_limits<double>::max();
+    save_csv(m, path);
+    REQUIRE(load_csv<double>(path) == m);
+
+    Matrix<float> floats = Matrix<float>::natural(3, 3) * 0.1f;
+    save_csv(floats.to_layout<ColumnMajor>(), path, CsvFormat::tsv());
+    REQUIRE(load_csv<float>(path, CsvFormat::tsv()) == floats);
+}
+
+TEST_CASE("CSV: names and missing values are written") {
+    TempFile temp("csv-names");
+    const std::string& path = temp.path();
+    Matrix<double> m = Matrix<double>::natural(2, 3);
+    m.at(2, 2) = std::numeric_limits<double>::quiet_NaN();
+    std::vector<std::string> names = {"id", "say \"hi\"", "a,b"};
+    save_csv(m, path, CsvFormat(), names);
+    REQUIRE(csv_contents(path) == "id,\"say \"\"hi\"\"\",\"a,b\"\n1,2,3\n4,nan,6\n");
+    REQUIRE(read_csv_header(path) == names);
+
+    Matrix<double> loaded = load_csv<double>(path, CsvFormat(',', true));
+    REQUIRE(std::isnan(loaded.at(2, 2)));
+    REQUIRE(loaded.at(2, 3) == 6);
+    REQUIRE_THROWS(save_csv(m, path, CsvFormat(), std::vector<std::string>(2, "x")));
+}
+
+TEST_CASE("CSV: large files are parsed in parallel") {
+    TempFile temp("csv-large");
+    const std::string& path = temp.path();
+    Matrix<int64_t> m = Matrix<int64_t>::natural(60000, 12);
+    m *= static_cast<int64_t>(1000003);
+    save_csv(m, path);
+    REQUIRE(csv_contents(path).size() > 4 * TEXT_CHUNK);
+    REQUIRE(load_csv<int64_t>(path) == m);
+
+    Matrix<double> halves = Matrix<double>::natural(40000, 9) * 0.5;
+    save_csv(halves.view(1, 2, 40000, 9), path, CsvFormat(';'));
+    REQUIRE(load_csv<double>(path, CsvFormat(';')) == halves.view(1, 2, 40000, 9).clone());
+}
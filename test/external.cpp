@@ -0,0 +1,99 @@
+#include "catch.hpp"
+
+#include "../src/Matrix.h"
+
+TEST_CASE("External: wrapped buffer is used without copying") {
+    std::vector<int> buffer = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+    Matrix<int> m = Matrix<int>::wrap(buffer.data(), 3, 3);
+    REQUIRE(!m.owns_storage());
+    REQUIRE(m.stride() == 3);
+    REQUIRE(&m.at(1, 1) == buffer.data());
+    REQUIRE(m == Matrix<int>::natural(3, 3));
+
+    m.at(2, 2) = 50;
+    REQUIRE(buffer[4] == 50);
+    buffer[4] = 5;
+
+    m *= 2;
+    REQUIRE(buffer[8] == 18);
+    m += Matrix<int>::natural(3, 3) * -1;
+    REQUIRE(buffer == std::vector<int>({1, 2, 3, 4, 5, 6, 7, 8, 9}));
+
+    buffer[0] = 2;
+    REQUIRE(m.det() == -3);
+    REQUIRE(m.transpose().at(3, 1) == 3);
+
+    int sum = 0;
+    for (int element : m) {
+        sum += element;
+    }
+    REQUIRE(sum == 46);
+
+    Matrix<int> view = m.view(2, 2, 3, 3);
+    view.at(1, 1) = 0;
+    REQUIRE(buffer[4] == 0);
+}
+
+TEST_CASE("External: wrapped buffer with stride") {
+    double buffer[] = {1, 2, -1, 3, 4, -1};
+    Matrix<double> m = Matrix<double>::wrap(buffer, 2, 2, 3);
+    REQUIRE(m.stride() == 3);
+    REQUIRE(!m.contiguous());
+    REQUIRE(m.at(2, 1) == 3);
+    REQUIRE(m.det() == -2);
+
+    Matrix<double> copy = m;
+    REQUIRE(copy.owns_storage());
+    copy.at(1, 1) = 10;
+    REQUIRE(buffer[0] == 1);
+    REQUIRE(m.clone().owns_storage());
+
+    REQUIRE_THROWS(Matrix<double>::wrap(buffer, 2, 3, 2));
+    REQUIRE_THROWS(Matrix<double>::wrap(buffer, 0, 2));
+    REQUIRE_THROWS(Matrix<double>::wrap(nullptr, 2, 2));
+}
+
+TEST_CASE("External: column-major buffer") {
+    int buffer[] = {1, 4, 2, 5, 3, 6};
+    Matrix<int, ColumnMajor> m = Matrix<int, ColumnMajor>::wrap(buffer, 2, 3);
+    REQUIRE(m.to_layout<RowMajor>() == Matrix<int>::natural(2, 3));
+}
+
+static int external_released = 0;
+
+TEST_CASE("External: adopted storage is released with the deleter") {
+    external_released = 0;
+    {
+        double* data = new double[6]();
+        Matrix<double> m = Matrix<double>::adopt(data, 2, 3, [](double* p) {
+            ++external_released;
+            delete[] p;
+        });
+        REQUIRE(m.owns_storage());
+        REQUIRE(&m.at(1, 1) == data);
+        m.at(2, 3) = 1;
+        REQUIRE(data[5] == 1);
+
+        Matrix<double> moved(std::move(m));
+        REQUIRE(moved.at(2, 3) == 1);
+        {
+            Matrix<double> view = moved.view(1, 1, 2, 2);
+            REQUIRE(!view.owns_storage());
+        }
+        REQUIRE(external_released == 0);
+    }
+    REQUIRE(external_released == 1);
+
+    {
+        Matrix<int> padded = Matrix<int>::adopt(new int[8](), 2, 3, 4, [](int* p) {
+            ++external_released;
+            delete[] p;
+        });
+        REQUIRE(padded.stride() == 4);
+        Matrix<int> copy = padded;
+    }
+    REQUIRE(external_released == 2);
+
+    int buffer[4];
+    REQUIRE_THROWS(Matrix<int>::adopt(buffer, 2, 2, std::function<void(int*)>()));
+}
@@ -0,0 +1,102 @@
+#include "catch.hpp"
+
+#include <cstdio>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include "temp_file.h"
+#include "../src/Matrix.h"
+
+static std::string format_legacy(const Matrix<double>& m) {
+    std::stringstream text;
+    text << "[\n";
+    for (int i = 1; i <= m.rows(); ++i) {
+        for (int j = 1; j <= m.cols(); ++j) {
+            text << std::setfill(' ') << std::setw(5) << m.at(i, j) << ", ";
+        }
+        text << "\n";
+    }
+    text << "]\n";
+    return text.str();
+}
+
+TEST_CASE("Format: to_string matches stream formatting of elements") {
+    Matrix<double> m = Matrix<double>::zeros(3, 4);
+    m.at(1, 1) = 0.1;
+    m.at(1, 2) = 1.0 / 3;
+    m.at(1, 3) = -1234567.0;
+    m.at(2, 1) = 1e-300;
+    m.at(2, 2) = std::numeric_limits<double>::infinity();
+    m.at(2, 3) = std::numeric_limits<double>::quiet_NaN();
+    m.at(3, 4) = 123456;
+    REQUIRE(m.to_string() == format_legacy(m));
+
+    REQUIRE(Matrix<int>::natural(2, 2).to_string() == "[\n    1,     2, \n    3,     4, \n]\n");
+    Matrix<int64_t> big = Matrix<int64_t>::eye(2) * static_cast<int64_t>(-10000000000LL);
+    REQUIRE(big.to_string() == "[\n-10000000000,     0, \n    0, -10000000000, \n]\n");
+
+    Matrix<char> letters = Matrix<char>::zeros(1, 2);
+    letters.at(1, 1) = 'a';
+    letters.at(1, 2) = 'b';
+    REQUIRE(letters.to_string() == "[\n    a,     b, \n]\n");
+}
+
+TEST_CASE("Format: small matrices print like to_string") {
+    Matrix<double> m = Matrix<double>::natural(10, 10) * 0.5;
+    std::stringstream out;
+    out << m;
+    REQUIRE(out.str() == m.to_string());
+
+    std::stringstream precise;
+    Matrix<double> third = Matrix<double>::zeros(1, 1);
+    third.at(1, 1) = 1.0 / 3;
+    third.print(precise, FormatOptions(1000, 3, 10));
+    REQUIRE(precise.str() == "[\n0.3333333333, \n]\n");
+}
+
+TEST_CASE("Format: large matrices are summarized") {
+    Matrix<int> m = Matrix<int>::natural(100, 200);
+    std::stringstream out;
+    out << m;
+    REQUIRE(out.str() == "[\n"
+                         "    1,     2,     3,   ...,   198,   199,   200, \n"
+                         "  201,   202,   203,   ...,   398,   399,   400, \n"
+                         "  401,   402,   403,   ...,   598,   599,   600, \n"
+                         "  ...\n"
+                         "19401, 19402, 19403,   ..., 19598, 19599, 19600, \n"
+                         "19601, 19602, 19603,   ..., 19798, 19799, 19800, \n"
+                         "19801, 19802, 19803,   ..., 19998, 19999, 20000, \n"
+                         "]\n");
+
+    // wide columns get the width of their widest shown element
+    Matrix<double> wide = Matrix<double>::zeros(50, 2);
+    wide.at(50, 2) = -1.25e-10;
+    std::stringstream summary;
+    wide.print(summary, FormatOptions(10, 1));
+    REQUIRE(summary.str() == "[\n"
+                             "    0,         0, \n"
+                             "  ...\n"
+                             "    0, -1.25e-10, \n"
+                             "]\n");
+
+    std::stringstream everything;
+    m.print(everything, FormatOptions(100 * 200));
+    REQUIRE(everything.str() == m.to_string());
+}
+
+TEST_CASE("Format: printing to file descriptors") {
+    TempFile output("format");
+    const std::string& path = output.path();
+    FILE* file = std::fopen(path.c_str(), "w");
+    Matrix<float> m = Matrix<float>::natural(300, 300);
+    m.print(fileno(file));
+    std::fclose(file);
+
+    std::ifstream in(path);
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::stringstream expected;
+    expected << m;
+    REQUIRE(text == expected.str());
+    REQUIRE(text.find("  ...\n") != std::string::npos);
+}
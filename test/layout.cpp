@@ -0,0 +1,100 @@
+#include "catch.hpp"
+
+#include "../src/Matrix.h"
+
+template<class L>
+static void layout_check_operations() {
+    Matrix<int, L> m = Matrix<int, L>::natural(3, 4);
+    Matrix<int> dense = Matrix<int>::natural(3, 4);
+    REQUIRE(m.template to_layout<RowMajor>() == dense);
+    REQUIRE(m.at(2, 3) == 7);
+    REQUIRE(m.to_string() == dense.to_string());
+
+    REQUIRE(m.clone() == m);
+    REQUIRE(m.transpose().template to_layout<RowMajor>() == dense.transpose());
+    REQUIRE((m * 2).template to_layout<RowMajor>() == dense * 2);
+    REQUIRE((m + m).template to_layout<RowMajor>() == dense + dense);
+    Matrix<int, L> transposed = m.transpose();
+    Matrix<int> dense_transposed = dense.transpose();
+    REQUIRE((m * transposed).template to_layout<RowMajor>() == dense * dense_transposed);
+    REQUIRE(!(m == Matrix<int, L>::zeros(3, 4)));
+
+    Matrix<int, L> square = Matrix<int, L>::natural(3, 3);
+    square.at(1, 1) = 2;
+    REQUIRE(square.det() == -3);
+
+    int sum = 0;
+    for (int element : m) {
+        sum += element;
+    }
+    REQUIRE(sum == 78);
+
+    Matrix<int, L> view = m.view(2, 2, 3, 4);
+    REQUIRE(view.at(1, 1) == 6);
+    REQUIRE(view.clone().template to_layout<RowMajor>() == dense.view(2, 2, 3, 4).clone());
+    view *= 10;
+    REQUIRE(m.at(3, 4) == 120);
+    REQUIRE(m.at(1, 4) == 4);
+
+    Matrix<int, L> copy = m;
+    REQUIRE(copy == m);
+    REQUIRE(&copy.at(1, 1) != &m.at(1, 1));
+}
+
+TEST_CASE("Layout: operations on row-major matrices") {
+    layout_check_operations<RowMajor>();
+}
+
+TEST_CASE("Layout: operations on column-major matrices") {
+    layout_check_operations<ColumnMajor>();
+}
+
+TEST_CASE("Layout: operations on tiled matrices") {
+    layout_check_operations<Tiled<2>>();
+    layout_check_operations<Tiled<4>>();
+    layout_check_operations<Tiled<>>();
+}
+
+typedef Matrix<int, ColumnMajor> LayoutColumns;
+
+TEST_CASE("Layout: column-major storage order") {
+    LayoutColumns m = LayoutColumns::natural(3, 2);
+    REQUIRE(m.stride() == 3);
+    REQUIRE(m.contiguous());
+    REQUIRE(&m.at(2, 1) - &m.at(1, 1) == 1);
+    REQUIRE(&m.at(1, 2) - &m.at(1, 1) == 3);
+    REQUIRE(m.view(1, 2, 3, 2).contiguous());
+    REQUIRE(!m.view(1, 1, 2, 2).contiguous());
+
+    LayoutColumns strided = LayoutColumns::with_stride(3, 2, 5);
+    REQUIRE(&strided.at(1, 2) - &strided.at(1, 1) == 5);
+    REQUIRE(!strided.contiguous());
+    REQUIRE_THROWS(LayoutColumns::with_stride(3, 2, 2));
+}
+
+typedef Matrix<int, Tiled<2>> LayoutTiled2;
+
+TEST_CASE("Layout: tiled storage order") {
+    LayoutTiled2 m = LayoutTiled2::natural(3, 5);
+    REQUIRE(m.stride() == 3);
+    REQUIRE(&m.at(1, 2) - &m.at(1, 1) == 1);
+    REQUIRE(&m.at(2, 1) - &m.at(1, 1) == 2);
+    REQUIRE(&m.at(1, 3) - &m.at(1, 1) == 4);
+    REQUIRE(&m.at(3, 1) - &m.at(1, 1) == 12);
+    REQUIRE(!m.contiguous());
+    REQUIRE(LayoutTiled2::zeros(4, 6).contiguous());
+    REQUIRE(LayoutTiled2::zeros(4, 6).view(3, 1, 4, 6).contiguous());
+    REQUIRE_THROWS(LayoutTiled2::with_stride(3, 5, 2));
+}
+
+TEST_CASE("Layout: conversion between layouts of large matrices") {
+    Matrix<double> m = Matrix<double>::natural(300, 500);
+    Matrix<double, ColumnMajor> columns = m.to_layout<ColumnMajor>();
+    Matrix<double, Tiled<>> tiles = columns.to_layout<Tiled<>>();
+    REQUIRE(columns.stride() == padded_pitch<double>(300));
+    REQUIRE(columns.at(300, 500) == 150000);
+    REQUIRE(tiles.at(123, 456) == m.at(123, 456));
+    REQUIRE(tiles.to_layout<RowMajor>() == m);
+    REQUIRE(tiles.transpose().to_layout<RowMajor>() == m.transpose());
+    REQUIRE(columns.transpose().to_layout<RowMajor>() == m.transpose());
+}
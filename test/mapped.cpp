@@ -0,0 +1,143 @@
+#include "catch.hpp"
+
+#include <cstdio>
+#include <cstddef>
+#include "temp_file.h"
+#include "../src/MappedMatrix.h"
+
+TEST_CASE("Mapped: created matrix persists after sync") {
+    TempFile temp("mapped-persist");
+    const std::string& path = temp.path();
+    {
+        MappedMatrix<double> m = MappedMatrix<double>::create(path, 3, 4);
+        REQUIRE(m.rows() == 3);
+        REQUIRE(m.cols() == 4);
+        REQUIRE(m.writable());
+        REQUIRE(m.matrix() == Matrix<double>::zeros(3, 4));
+        REQUIRE(reinterpret_cast<uintptr_t>(&m.at(1, 1)) % 4096 == 0);
+
+        m.put(Matrix<double>::natural(3, 4), 1, 1);
+        m.sync();
+        m.at(3, 4) = 100;
+        m.sync(false);
+    }
+
+    MappedMatrix<double> reopened = MappedMatrix<double>::open(path);
+    REQUIRE(!reopened.writable());
+    REQUIRE(reopened.rows() == 3);
+    REQUIRE(reopened.at(2, 1) == 5);
+    REQUIRE(reopened.at(3, 4) == 100);
+}
+
+TEST_CASE("Mapped: operations run on the mapping") {
+    TempFile temp("mapped-operations");
+    const std::string& path = temp.path();
+    MappedMatrix<int> m = MappedMatrix<int>::create(path, 3, 3);
+    Matrix<int> natural = Matrix<int>::natural(3, 3);
+
+    m.matrix() += natural;
+    REQUIRE(m.matrix() == natural);
+    m.matrix() *= 2;
+    REQUIRE(m.at(3, 3) == 18);
+    REQUIRE(m.matrix() + natural == natural * 3);
+    REQUIRE(m.matrix().transpose() == (natural * 2).transpose());
+    m.at(1, 1) = 4;
+    REQUIRE(m.matrix().det() == -24);
+
+    Matrix<int> view = m.view(2, 2, 3, 3);
+    view *= 0;
+    REQUIRE(m.at(2, 2) == 0);
+    REQUIRE(m.at(2, 1) == 8);
+
+    Matrix<int> copy = m.matrix();
+    copy.at(1, 1) = 0;
+    REQUIRE(m.at(1, 1) == 4);
+}
+
+TEST_CASE("Mapped: read-only mappings keep changes private") {
+    TempFile temp("mapped-private");
+    const std::string& path = temp.path();
+    {
+        MappedMatrix<float> m = MappedMatrix<float>::create(path, 2, 2);
+        m.at(1, 1) = 1;
+    }
+    {
+        MappedMatrix<float> m = MappedMatrix<float>::open(path);
+        m.at(1, 1) = 2;
+        m.sync();
+        REQUIRE(m.at(1, 1) == 2);
+    }
+    {
+        MappedMatrix<float> m = MappedMatrix<float>::open(path, true);
+        REQUIRE(m.at(1, 1) == 1);
+        m.at(1, 1) = 3;
+    }
+    REQUIRE(MappedMatrix<float>::open(path).at(1, 1) == 3);
+}
+
+TEST_CASE("Mapped: column-major and large sparse files") {
+    TempFile temp("mapped-large");
+    const std::string& path = temp.path();
+    {
+        MappedMatrix<double, ColumnMajor> m = MappedMatrix<double, ColumnMajor>::create(path, 5000, 3000);
+        REQUIRE(&m.at(2, 1) - &m.at(1, 1) == 1);
+        m.advise(MappedMatrix<double, ColumnMajor>::RANDOM);
+        m.at(5000, 3000) = 7;
+        m.at(1, 1) = 1;
+        m.sync();
+    }
+    {
+        MappedMatrix<double, ColumnMajor> m = MappedMatrix<double, ColumnMajor>::open(path);
+        m.advise(MappedMatrix<double, ColumnMajor>::SEQUENTIAL);
+        m.advise(MappedMatrix<double, ColumnMajor>::WILL_NEED);
+        REQUIRE(m.at(5000, 3000) == 7);
+        REQUIRE(m.at(2500, 1500) == 0);
+        m.advise(MappedMatrix<double, ColumnMajor>::DONT_NEED);
+        REQUIRE(m.at(1, 1) == 1);
+    }
+    REQUIRE_THROWS(MappedMatrix<double>::open(path));
+}
+
+TEST_CASE("Mapped: invalid files are rejected") {
+    TempFile temp("mapped-invalid");
+    const std::string& path = temp.path();
+    REQUIRE_THROWS(MappedMatrix<double>::open(path));
+    REQUIRE_THROWS(MappedMatrix<double>::create(path, 0, 3));
+
+    {
+        MappedMatrix<double> m = MappedMatrix<double>::create(path, 10, 10);
+    }
+    REQUIRE_THROWS(MappedMatrix<float>::open(path));
+    REQUIRE_THROWS(MappedMatrix<int64_t>::open(path));
+    REQUIRE(truncate(path.c_str(), 4096 + 10 * 10 * sizeof(double) - 1) == 0);
+    REQUIRE_THROWS(MappedMatrix<double>::open(path));
+
+    // data offsets past the end of the file, wrapping around, or not page aligned
+    uint64_t offsets[] = {1ULL << 20, ~0ULL - 63, 4096 + 8};
+    for (uint64_t offset : offsets) {
+        {
+            MappedMatrix<double> m = MappedMatrix<double>::create(path, 4, 4);
+        }
+        FILE* header = std::fopen(path.c_str(), "r+b");
+        std::fseek(header, offsetof(MappedHeader, data_offset), SEEK_SET);
+        std::fwrite(&offset, sizeof(offset), 1, header);
+        std::fclose(header);
+        REQUIRE_THROWS(MappedMatrix<double>::open(path));
+    }
+
+    // size of the elements does not fit 64 bits
+    {
+        MappedMatrix<double> m = MappedMatrix<double>::create(path, 4, 4);
+    }
+    int64_t huge[] = {INT32_MAX, INT32_MAX, INT32_MAX};
+    FILE* header = std::fopen(path.c_str(), "r+b");
+    std::fseek(header, offsetof(MappedHeader, rows), SEEK_SET);
+    std::fwrite(huge, sizeof(huge), 1, header);
+    std::fclose(header);
+    REQUIRE_THROWS_WITH(MappedMatrix<double>::open(path), "Cannot open matrix file " + path + ": file is truncated");
+
+    FILE* file = std::fopen(path.c_str(), "w");
+    std::fputs("not a matrix, just some text long enough to fill the whole header", file);
+    std::fclose(file);
+    REQUIRE_THROWS(MappedMatrix<double>::open(path));
+}
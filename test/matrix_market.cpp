@@ -0,0 +1,233 @@
+#include "catch.hpp"
+
+#include <cstdio>
+#include <cmath>
+#include <fstream>
+#include "temp_file.h"
+#include "../src/MatrixMarket.h"
+
+static void matrix_market_store(const std::string& path, const std::string& contents) {
+    std::ofstream file(path, std::ios::binary);
+    file << contents;
+}
+
+TEST_CASE("Matrix Market: coordinate files") {
+    TempFile temp("mtx-coordinate");
+    const std::string& path = temp.path();
+    matrix_market_store(path, "%%MatrixMarket matrix coordinate real general\n"
+                              "% written by hand\n"
+                              "\n"
+                              "3 4 5\n"
+                              "1 1 1.5\n"
+                              "2 3 -2e3\n"
+                              "  3 4\t0.25  \r\n"
+                              "% comments between entries\n"
+                              "1 4 7\n"
+                              "1 1 0.5\n");
+
+    MatrixMarketHeader header = read_matrix_market_header(path);
+    REQUIRE(header.coordinate);
+    REQUIRE(header.field == MatrixMarketHeader::REAL);
+    REQUIRE(header.rows == 3);
+    REQUIRE(header.cols == 4);
+    REQUIRE(header.entries == 5);
+
+    Matrix<double> dense = load_matrix_market<double>(path);
+    REQUIRE(dense.at(1, 1) == 2);
+    REQUIRE(dense.at(2, 3) == -2000);
+    REQUIRE(dense.at(3, 4) == 0.25);
+    REQUIRE(dense.at(1, 4) == 7);
+    REQUIRE(dense.at(2, 2) == 0);
+
+    SparseMatrix<double> sparse = load_matrix_market_sparse<double>(path);
+    REQUIRE(sparse.nonzeros() == 4);
+    REQUIRE(sparse.to_dense() == dense);
+}
+
+TEST_CASE("Matrix Market: symmetry and fields") {
+    TempFile temp("mtx-symmetry");
+    const std::string& path = temp.path();
+    matrix_market_store(path, "%%MatrixMarket matrix coordinate integer symmetric\n"
+                              "3 3 3\n"
+                              "1 1 4\n"
+                              "3 1 -2\n"
+                              "3 2 5\n");
+    Matrix<int> symmetric = load_matrix_market<int>(path);
+    REQUIRE(symmetric.at(1, 3) == -2);
+    REQUIRE(symmetric.at(3, 1) == -2);
+    REQUIRE(symmetric.at(2, 3) == 5);
+    REQUIRE(load_matrix_market_sparse<int>(path).nonzeros() == 5);
+
+    matrix_market_store(path, "%%MatrixMarket matrix coordinate real skew-symmetric\n"
+                              "2 2 1\n"
+                              "2 1 3\n");
+    Matrix<double> skew = load_matrix_market<double>(path);
+    REQUIRE(skew.at(2, 1) == 3);
+    REQUIRE(skew.at(1, 2) == -3);
+
+    matrix_market_store(path, "%%MatrixMarket matrix coordinate pattern general\n"
+                              "2 3 2\n"
+                              "1 2\n"
+                              "2 3\n");
+    SparseMatrix<float> pattern = load_matrix_market_sparse<float>(path);
+    REQUIRE(pattern.at(1, 2) == 1);
+    REQUIRE(pattern.at(2, 3) == 1);
+    REQUIRE(pattern.at(1, 1) == 0);
+
+    matrix_market_store(path, "%%MatrixMarket matrix array real general\n"
+                              "2 3\n"
+                              "1\n2\n3\n4\n5\n6\n");
+    Matrix<double> array = load_matrix_market<double>(path);
+    REQUIRE(array.at(1, 1) == 1);
+    REQUIRE(array.at(2, 1) == 2);
+    REQUIRE(array.at(1, 3) == 5);
+
+    matrix_market_store(path, "%%MatrixMarket matrix array real symmetric\n"
+                              "3 3\n"
+                              "1\n2\n3\n4\n5\n6\n");
+    Matrix<double> lower = load_matrix_market<double>(path);
+    REQUIRE(lower.at(3, 1) == 3);
+    REQUIRE(lower.at(1, 3) == 3);
+    REQUIRE(lower.at(2, 2) == 4);
+    REQUIRE(lower.at(2, 3) == 5);
+    REQUIRE(lower.at(3, 3) == 6);
+
+    matrix_market_store(path, "%%MatrixMarket matrix array integer skew-symmetric\n"
+                              "3 3\n"
+                              "1\n2\n3\n");
+    SparseMatrix<int> strict = load_matrix_market_sparse<int>(path);
+    REQUIRE(strict.nonzeros() == 6);
+    REQUIRE(strict.at(3, 2) == 3);
+    REQUIRE(strict.at(2, 3) == -3);
+    REQUIRE(strict.at(1, 1) == 0);
+}
+
+TEST_CASE("Matrix Market: real numbers are parsed exactly") {
+    const char* samples[] = {"0.1", "-2.5e-3", "123456789012345678901234", "1e400", "-1E-400", "3.14159265358979323846",
+                             "+7", ".5", "5.", "9007199254740993", "1e22", "1e23", "inf", "-nan", "0.000000000000000000001"};
+    for (const char* sample : samples) {
+        const char* position = sample;
+        double value;
+        REQUIRE(text_real(position, sample + std::strlen(sample), value));
+        REQUIRE(position == sample + std::strlen(sample));
+        double expected = std::strtod(sample, nullptr);
+        REQUIRE((value == expected || (std::isnan(value) && std::isnan(expected))));
+    }
+
+    std::string long_decimal = "0.1" + std::string(200, '0') + "1e-3";
+    const char* position = long_decimal.data();
+    double long_value;
+    REQUIRE(text_real(position, long_decimal.data() + long_decimal.size(), long_value));
+    REQUIRE(position == long_decimal.data() + long_decimal.size());
+    REQUIRE(long_value == std::strtod(long_decimal.c_str(), nullptr));
+
+    const char* invalid[] = {"", "x", "-", "."};
+    for (const char* sample : invalid) {
+        const char* position = sample;
+        double value;
+        REQUIRE_FALSE(text_real(position, sample + std::strlen(sample), value));
+    }
+}
+
+TEST_CASE("Matrix Market: dense and sparse matrices round trip") {
+    TempFile temp("mtx-round");
+    const std::string& path = temp.path();
+    Matrix<double> m = Matrix<double>::zeros(37, 23);
+    for (int i = 1; i <= m.rows(); ++i) {
+        for (int j = 1; j <= m.cols(); ++j) {
+            m.at(i, j) = (i * j % 5 == 0) ? 0 : std::sin(i * 0.37 + j) / 3;
+        }
+    }
+
+    save_matrix_market(m, path);
+    REQUIRE(load_matrix_market<double>(path) == m);
+    save_matrix_market(m.to_layout<ColumnMajor>(), path);
+    REQUIRE(load_matrix_market<double>(path) == m);
+
+    SparseMatrix<double> sparse = SparseMatrix<double>::from_dense(m);
+    save_matrix_market(sparse, path);
+    REQUIRE(read_matrix_market_header(path).entries == sparse.nonzeros());
+    REQUIRE(load_matrix_market_sparse<double>(path) == sparse);
+
+    Matrix<int64_t> integers = Matrix<int64_t>::natural(4, 4) * static_cast<int64_t>(-1000000000000LL);
+    save_matrix_market(integers, path);
+    REQUIRE(read_matrix_market_header(path).field == MatrixMarketHeader::INTEGER);
+    REQUIRE(load_matrix_market<int64_t>(path) == integers);
+}
+
+TEST_CASE("Matrix Market: large files are parsed in chunks") {
+    std::string lines;
+    for (int i = 0; lines.size() < 5 * TEXT_CHUNK; ++i) {
+        lines += std::to_string(i) + " 1 0.5\n";
+    }
+    std::vector<size_t> bounds = text_chunks(lines.data(), 0, lines.size());
+    REQUIRE(bounds.front() == 0);
+    REQUIRE(bounds.back() == lines.size());
+    REQUIRE(static_cast<int>(bounds.size()) - 1 == std::min(5, parallel_threads() * 4));
+    for (size_t c = 1; c + 1 < bounds.size(); ++c) {
+        REQUIRE(lines[bounds[c] - 1] == '\n');
+    }
+
+    TempFile temp("mtx-large");
+    const std::string& path = temp.path();
+    int n = 600;
+    std::vector<Triplet<double> > triplets;
+    for (int i = 1; i <= n; ++i) {
+        for (int j = 1; j <= i; ++j) {
+            if ((i + 3 * j) % 4 != 0) {
+                Triplet<double> triplet = {i, j, (i * 7 + j) / 8.0};
+                triplets.push_back(triplet);
+            }
+        }
+    }
+    SparseMatrix<double> general = SparseMatrix<double>::from_triplets(n, n, triplets);
+    save_matrix_market(general, path);
+    REQUIRE(load_matrix_market_sparse<double>(path) == general);
+    REQUIRE(load_matrix_market<double>(path) == general.to_dense());
+
+    // the same lower triangle declared symmetric
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "%%MatrixMarket matrix coordinate real symmetric\n" << n << " " << n << " " << triplets.size() << "\n";
+        for (const Triplet<double>& triplet : triplets) {
+            file << triplet.row << " " << triplet.col << " " << triplet.value << "\n";
+        }
+    }
+    Matrix<double> symmetric = load_matrix_market<double>(path);
+    Matrix<double> lower = general.to_dense();
+    for (int i = 1; i <= n; ++i) {
+        for (int j = 1; j <= n; ++j) {
+            REQUIRE(symmetric.at(i, j) == (i >= j ? lower.at(i, j) : lower.at(j, i)));
+        }
+    }
+
+    Matrix<float> dense = Matrix<float>::natural(700, 500);
+    save_matrix_market(dense, path);
+    REQUIRE(load_matrix_market<float>(path) == dense);
+}
+
+TEST_CASE("Matrix Market: invalid files are rejected") {
+    TempFile temp("mtx-invalid");
+    const std::string& path = temp.path();
+    REQUIRE_THROWS(load_matrix_market<double>(path));
+
+    const char* files[] = {
+            "plain text\n",
+            "%%MatrixMarket matrix coordinate complex general\n1 1 1\n1 1 1 0\n",
+            "%%MatrixMarket matrix array pattern general\n1 1\n",
+            "%%MatrixMarket matrix coordinate real symmetric\n2 3 0\n",
+            "%%MatrixMarket matrix coordinate real general\n2 2\n",
+            "%%MatrixMarket matrix coordinate real general\n2 2 1\n3 1 1.0\n",
+            "%%MatrixMarket matrix coordinate real general\n2 2 1\n1 1 abc\n",
+            "%%MatrixMarket matrix coordinate real general\n2 2 1\n1 1 1.0 2.0\n",
+            "%%MatrixMarket matrix array real general\n2 2\n1\n2\n3\n",
+    };
+    for (const char* contents : files) {
+        matrix_market_store(path, contents);
+        REQUIRE_THROWS(load_matrix_market<double>(path));
+        REQUIRE_THROWS(load_matrix_market_sparse<double>(path));
+    }
+
+    matrix_market_store(path, "%%MatrixMarket matrix coordinate real general\n2 2 2\n1 1 1.0\n");
+    REQUIRE_THROWS_WITH(load_matrix_market<double>(path), "Cannot load matrix market: expected 2 entries, found 1");
+}
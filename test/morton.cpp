@@ -0,0 +1,146 @@
+#include "catch.hpp"
+
+#include "../src/MortonMatrix.h"
+
+static Matrix<double> morton_sample(int rows, int cols) {
+    Matrix<double> m = Matrix<double>::zeros(rows, cols);
+    for (int i = 1; i <= rows; ++i) {
+        for (int j = 1; j <= cols; ++j) {
+            m.at(i, j) = (i * 7 + j * 3) % 11 - 5;
+        }
+    }
+    return m;
+}
+
+TEST_CASE("Morton: encoding interleaves bits") {
+    REQUIRE(morton_encode(0, 0) == 0);
+    REQUIRE(morton_encode(0, 1) == 1);
+    REQUIRE(morton_encode(1, 0) == 2);
+    REQUIRE(morton_encode(1, 1) == 3);
+    REQUIRE(morton_encode(2, 0) == 8);
+    REQUIRE(morton_encode(3, 5) == 0x1B);
+    REQUIRE(morton_encode(0xFFFFFFFF, 0) == 0xAAAAAAAAAAAAAAAAULL);
+
+    uint32_t row, col;
+    for (uint32_t r = 0; r < 50; r += 7) {
+        for (uint32_t c = 0; c < 50; c += 3) {
+            morton_decode(morton_encode(r, c), row, col);
+            REQUIRE(row == r);
+            REQUIRE(col == c);
+        }
+    }
+    morton_decode(morton_encode(123456789, 987654321), row, col);
+    REQUIRE(row == 123456789);
+    REQUIRE(col == 987654321);
+}
+
+TEST_CASE("Morton: tiles are stored in Z-order") {
+    MortonMatrix<int> m = MortonMatrix<int>::zeros(100, 70);
+    REQUIRE(m.level() == 2);
+    REQUIRE(m.side() == 128);
+    int tile = MORTON_TILE * MORTON_TILE;
+    REQUIRE(m.tile_data(1, 2) - m.tile_data(1, 1) == tile);
+    REQUIRE(m.tile_data(2, 1) - m.tile_data(1, 1) == 2 * tile);
+    REQUIRE(m.tile_data(1, 3) - m.tile_data(1, 1) == 4 * tile);
+    REQUIRE(&m.at(34, 35) == m.tile_data(2, 2) + MORTON_TILE + 2);
+    REQUIRE(MortonMatrix<int>::zeros(32, 1).level() == 0);
+
+    REQUIRE_THROWS(m.at(101, 1));
+    REQUIRE_THROWS(m.at(1, 0));
+    REQUIRE_THROWS(m.tile_data(5, 1));
+    REQUIRE_THROWS(MortonMatrix<int>::zeros(0, 3));
+}
+
+TEST_CASE("Morton: conversion from and to dense matrices") {
+    int sizes[][2] = {{1, 1}, {5, 7}, {32, 32}, {33, 65}, {200, 130}};
+    for (auto& size : sizes) {
+        Matrix<double> dense = morton_sample(size[0], size[1]);
+        MortonMatrix<double> m = MortonMatrix<double>::from_dense(dense);
+        REQUIRE(m.rows() == size[0]);
+        REQUIRE(m.cols() == size[1]);
+        REQUIRE(m.at(size[0], size[1]) == dense.at(size[0], size[1]));
+        REQUIRE(m.to_dense() == dense);
+    }
+}
+
+TEST_CASE("Morton: quadrants are contiguous views") {
+    Matrix<double> dense = morton_sample(100, 50);
+    MortonMatrix<double> m = MortonMatrix<double>::from_dense(dense);
+
+    MortonMatrix<double> first = m.quadrant(1, 1);
+    MortonMatrix<double> right = m.quadrant(1, 2);
+    MortonMatrix<double> bottom = m.quadrant(2, 1);
+    MortonMatrix<double> empty = m.quadrant(2, 2);
+    REQUIRE(first.is_view());
+    REQUIRE(first.level() == 1);
+    REQUIRE(first.rows() == 64);
+    REQUIRE(first.cols() == 50);
+    REQUIRE(right.cols() == 0);
+    REQUIRE(bottom.rows() == 36);
+    REQUIRE(bottom.cols() == 50);
+    REQUIRE(empty.cols() == 0);
+    REQUIRE(bottom.tile_data(1, 1) - first.tile_data(1, 1) == 8 * MORTON_TILE * MORTON_TILE);
+
+    REQUIRE(bottom.at(1, 1) == dense.at(65, 1));
+    REQUIRE(bottom.quadrant(1, 2).at(4, 18) == dense.at(68, 50));
+    REQUIRE(bottom.to_dense() == dense.view(65, 1, 100, 50).clone());
+
+    bottom.at(36, 50) = 100;
+    REQUIRE(m.at(100, 50) == 100);
+
+    MortonMatrix<double> copy = bottom;
+    REQUIRE(!copy.is_view());
+    copy.at(1, 1) = 100;
+    REQUIRE(m.at(65, 1) == dense.at(65, 1));
+
+    REQUIRE_THROWS(m.quadrant(3, 1));
+    REQUIRE_THROWS(MortonMatrix<double>::zeros(10, 10).quadrant(1, 1));
+}
+
+TEST_CASE("Morton: transpose") {
+    int sizes[][2] = {{3, 4}, {32, 33}, {100, 50}, {257, 130}};
+    for (auto& size : sizes) {
+        Matrix<double> dense = morton_sample(size[0], size[1]);
+        MortonMatrix<double> t = MortonMatrix<double>::from_dense(dense).transpose();
+        REQUIRE(t.rows() == size[1]);
+        REQUIRE(t.cols() == size[0]);
+        REQUIRE(t.to_dense() == dense.transpose());
+        REQUIRE(t.transpose() == MortonMatrix<double>::from_dense(dense));
+    }
+}
+
+TEST_CASE("Morton: multiplication matches dense multiplication") {
+    int sizes[][3] = {{2, 3, 4}, {32, 32, 32}, {40, 70, 33}, {130, 20, 90}, {10, 150, 5}};
+    for (auto& size : sizes) {
+        Matrix<double> a = morton_sample(size[0], size[1]);
+        Matrix<double> b = morton_sample(size[1], size[2]);
+        Matrix<double> expected = a * b;
+
+        MortonMatrix<double> ma = MortonMatrix<double>::from_dense(a);
+        MortonMatrix<double> mb = MortonMatrix<double>::from_dense(b);
+        REQUIRE((ma * mb).to_dense() == expected);
+
+        MortonMatrix<double> c = MortonMatrix<double>::from_dense(expected);
+        MortonMatrix<double>::gemm(ma, mb, c);
+        REQUIRE(c.to_dense() == expected * 2);
+    }
+
+    MortonMatrix<double> a = MortonMatrix<double>::zeros(3, 4);
+    REQUIRE_THROWS(a * a);
+}
+
+TEST_CASE("Morton: multiplication of large matrices") {
+    Matrix<double> a = morton_sample(300, 260);
+    Matrix<double> b = morton_sample(260, 280);
+    MortonMatrix<double> product = MortonMatrix<double>::from_dense(a) * MortonMatrix<double>::from_dense(b);
+
+    for (int i = 1; i <= 300; i += 37) {
+        for (int j = 1; j <= 280; j += 29) {
+            double expected = 0;
+            for (int k = 1; k <= 260; ++k) {
+                expected += a.at(i, k) * b.at(k, j);
+            }
+            REQUIRE(product.at(i, j) == expected);
+        }
+    }
+}
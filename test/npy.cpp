@@ -0,0 +1,180 @@
+#include "catch.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include "temp_file.h"
+#include "../src/Npy.h"
+
+static std::string npy_contents(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static void npy_store(const std::string& path, const std::string& contents) {
+    std::ofstream file(path, std::ios::binary);
+    file << contents;
+}
+
+TEST_CASE("Npy: files are written like numpy.save") {
+    TempFile temp("npy-format");
+    const std::string& path = temp.path();
+    save_npy(Matrix<int32_t>::natural(2, 3), path);
+    std::string contents = npy_contents(path);
+
+    std::string dictionary = "{'descr': '<i4', 'fortran_order': False, 'shape': (2, 3), }";
+    REQUIRE(contents.size() == 128 + 6 * 4);
+    REQUIRE(contents.substr(0, 10) == std::string("\x93NUMPY\x01\x00\x76\x00", 10));
+    REQUIRE(contents.substr(10, dictionary.size()) == dictionary);
+    REQUIRE(contents[127] == '\n');
+    int32_t fourth;
+    std::memcpy(&fourth, &contents[128 + 3 * 4], 4);
+    REQUIRE(fourth == 4);
+
+    save_npy(Matrix<double>::natural(2, 3).to_layout<ColumnMajor>(), path);
+    REQUIRE(npy_contents(path).find("'descr': '<f8', 'fortran_order': True, 'shape': (2, 3)") == 11);
+}
+
+TEST_CASE("Npy: matrices round trip in both orders") {
+    TempFile temp("npy-orders");
+    const std::string& path = temp.path();
+    Matrix<double> rows = Matrix<double>::natural(7, 5);
+    Matrix<double, ColumnMajor> columns = rows.to_layout<ColumnMajor>();
+
+    save_npy(rows, path);
+    REQUIRE(load_npy<double>(path) == rows);
+    Matrix<double, ColumnMajor> converted = load_npy<double, ColumnMajor>(path);
+    REQUIRE(converted == columns);
+
+    save_npy(columns, path);
+    Matrix<double, ColumnMajor> loaded = load_npy<double, ColumnMajor>(path);
+    REQUIRE(loaded == columns);
+    REQUIRE(load_npy<double>(path) == rows);
+
+    typedef Matrix<int64_t, Tiled<4>> NpyTiled;
+    NpyTiled tiles = NpyTiled::natural(9, 6);
+    save_npy(tiles, path);
+    REQUIRE(load_npy<int64_t>(path) == Matrix<int64_t>::natural(9, 6));
+    NpyTiled loaded_tiles = load_npy<int64_t, Tiled<4>>(path);
+    REQUIRE(loaded_tiles == tiles);
+
+    Matrix<float> natural = Matrix<float>::natural(6, 6);
+    save_npy(natural.view(2, 3, 5, 4), path);
+    REQUIRE(load_npy<float>(path) == natural.view(2, 3, 5, 4).clone());
+}
+
+TEST_CASE("Npy: loads map the file without copying") {
+    TempFile temp("npy-mapped");
+    const std::string& path = temp.path();
+    Matrix<float> m = Matrix<float>::natural(20, 1000);
+    save_npy(m, path);
+
+    Matrix<float> loaded = load_npy<float>(path);
+    REQUIRE(loaded == m);
+    REQUIRE(loaded.owns_storage());
+    REQUIRE(loaded.stride() == 1000);
+
+    // private mapping: changes never reach the file, which can go away while mapped
+    loaded.at(1, 1) = -1;
+    std::remove(path.c_str());
+    REQUIRE(loaded.at(1, 1) == -1);
+    REQUIRE(loaded.at(20, 1000) == 20000);
+    Matrix<float> moved = std::move(loaded);
+    REQUIRE(moved.at(2, 1) == 1001);
+}
+
+TEST_CASE("Npy: one-dimensional arrays and other writers") {
+    TempFile temp("npy-vector");
+    const std::string& path = temp.path();
+    std::string header = "{\"descr\": \"<u2\", \"fortran_order\": True, \"shape\": (3,)}";
+    std::string contents = std::string("\x93NUMPY\x02\x00", 8) + std::string(1, static_cast<char>(header.size())) +
+                           std::string(3, '\0') + header;
+    uint16_t values[] = {7, 8, 65535};
+    contents.append(reinterpret_cast<const char*>(values), sizeof(values));
+    npy_store(path, contents);
+
+    // header of odd length leaves elements unaligned, they are copied
+    Matrix<uint16_t> vector = load_npy<uint16_t>(path);
+    REQUIRE(vector.rows() == 1);
+    REQUIRE(vector.cols() == 3);
+    REQUIRE(vector.at(1, 3) == 65535);
+    REQUIRE_THROWS(load_npy<int16_t>(path));
+}
+
+TEST_CASE("Npy: invalid files are rejected") {
+    TempFile temp("npy-invalid");
+    const std::string& path = temp.path();
+    REQUIRE_THROWS(load_npy<double>(path));
+
+    save_npy(Matrix<double>::natural(4, 4), path);
+    REQUIRE_THROWS_WITH(load_npy<float>(path), "Cannot load npy: stored elements are float64");
+    std::string contents = npy_contents(path);
+
+    npy_store(path, contents.substr(0, contents.size() - 1));
+    REQUIRE_THROWS_WITH(load_npy<double>(path), "Cannot load npy: file is truncated");
+
+    std::string big = contents;
+    big.replace(big.find("<f8"), 3, ">f8");
+    npy_store(path, big);
+    REQUIRE_THROWS(load_npy<double>(path));
+
+    std::string cube = contents;
+    cube.replace(cube.find("(4, 4)"), 6, "(2,2,4)");
+    npy_store(path, cube);
+    REQUIRE_THROWS(load_npy<double>(path));
+
+    npy_store(path, "plain text");
+    REQUIRE_THROWS(load_npy<double>(path));
+    npy_store(path, "");
+    REQUIRE_THROWS(load_npy<double>(path));
+}
+
+TEST_CASE("Npy: npz archives hold several arrays") {
+    TempFile temp("npy-archive-npz");
+    const std::string& path = temp.path();
+    Matrix<double> weights = Matrix<double>::natural(30, 17);
+    Matrix<int32_t, ColumnMajor> labels = Matrix<int32_t>::natural(5, 2).to_layout<ColumnMajor>();
+    {
+        NpzWriter writer = NpzWriter::create(path);
+        writer.add("weights", weights);
+        writer.add("labels", labels);
+        writer.add("bias", Matrix<float>::natural(1, 3));
+        writer.close();
+        REQUIRE_THROWS(writer.add("late", weights));
+    }
+
+    NpzArchive archive = NpzArchive::open(path);
+    REQUIRE(archive.names() == std::vector<std::string>({"weights", "labels", "bias"}));
+    REQUIRE(archive.contains("labels"));
+    REQUIRE_FALSE(archive.contains("labels.npy"));
+
+    Matrix<double> loaded = archive.load<double>("weights");
+    REQUIRE(loaded == weights);
+    REQUIRE(loaded.stride() == 17);
+    REQUIRE(reinterpret_cast<uintptr_t>(&loaded.at(1, 1)) % 64 == 0);
+    Matrix<int32_t, ColumnMajor> loaded_labels = archive.load<int32_t, ColumnMajor>("labels");
+    REQUIRE(loaded_labels == labels);
+    REQUIRE(load_npz<float>(path, "bias") == Matrix<float>::natural(1, 3));
+    REQUIRE_THROWS(archive.load<float>("weights"));
+    REQUIRE_THROWS(archive.load<double>("missing"));
+
+    // zip checksums of the entries are those of the whole npy files
+    std::string contents = npy_contents(path);
+    TempFile npy_file("npy-single-npy");
+    const std::string& npy = npy_file.path();
+    save_npy(weights, npy);
+    std::string single = npy_contents(npy);
+    REQUIRE(contents.find(single) != std::string::npos);
+    uint32_t crc;
+    std::memcpy(&crc, &contents[14], 4);
+    REQUIRE(crc == crc32(single.data(), single.size()));
+
+    // arrays keep the archive mapped
+    std::remove(path.c_str());
+    REQUIRE(loaded.at(30, 17) == 510);
+
+    npy_store(path, contents.substr(0, contents.size() - 10));
+    REQUIRE_THROWS(NpzArchive::open(path));
+    npy_store(path, single);
+    REQUIRE_THROWS(NpzArchive::open(path));
+}
@@ -0,0 +1,159 @@
+#include "catch.hpp"
+
+#include <cstdio>
+#include <cmath>
+#include <limits>
+#include "temp_file.h"
+#include "../src/OutOfCore.h"
+
+static Matrix<double> out_of_core_sample(int rows, int cols, int seed) {
+    Matrix<double> m = Matrix<double>::zeros(rows, cols);
+    for (int i = 1; i <= rows; ++i) {
+        for (int j = 1; j <= cols; ++j) {
+            m.at(i, j) = (i * 13 + j * 7 + seed) % 17 - 8;
+        }
+    }
+    return m;
+}
+
+static void out_of_core_store(const std::string& path, const Matrix<double>& m) {
+    MappedMatrix<double> file = MappedMatrix<double>::create(path, m.rows(), m.cols());
+    file.put(m, 1, 1);
+}
+
+static Matrix<double> out_of_core_load(const std::string& path) {
+    return MappedMatrix<double>::open(path).matrix();
+}
+
+TEST_CASE("Out of core: tile files read and write blocks") {
+    TempFile temp("ooc-tiles");
+    const std::string& path = temp.path();
+    out_of_core_store(path, Matrix<double>::natural(5, 6));
+    {
+        TileFile<double> file = TileFile<double>::open(path, true);
+        REQUIRE(file.rows() == 5);
+        REQUIRE(file.cols() == 6);
+
+        Matrix<double> block = Matrix<double>::zeros(2, 3);
+        file.read(2, 3, 2, 3, block.row_data(1), block.stride());
+        REQUIRE(block.at(1, 1) == 9);
+        REQUIRE(block.at(2, 3) == 17);
+
+        block *= -1;
+        file.write(4, 4, 2, 3, block.row_data(1), block.stride());
+        REQUIRE_THROWS(file.read(5, 1, 2, 1, block.row_data(1), block.stride()));
+        REQUIRE_THROWS(file.write(1, 5, 1, 3, block.row_data(1), block.stride()));
+    }
+    Matrix<double> m = out_of_core_load(path);
+    REQUIRE(m.at(4, 4) == -9);
+    REQUIRE(m.at(5, 6) == -17);
+    REQUIRE(m.at(3, 3) == 15);
+    REQUIRE_THROWS(TileFile<float>::open(path));
+}
+
+TEST_CASE("Out of core: multiplication matches in-memory multiplication") {
+    TempFile a_file("ooc-a"), b_file("ooc-b"), c_file("ooc-c");
+    const std::string& a = a_file.path();
+    const std::string& b = b_file.path();
+    const std::string& c = c_file.path();
+    int sizes[][3] = {{1, 1, 1}, {7, 5, 9}, {40, 33, 21}, {64, 64, 64}};
+    size_t budgets[] = {6 * 8 * 4, 6 * 8 * 100, 1 << 20};
+    for (auto& size : sizes) {
+        Matrix<double> ma = out_of_core_sample(size[0], size[1], 1);
+        Matrix<double> mb = out_of_core_sample(size[1], size[2], 2);
+        Matrix<double> expected = ma * mb;
+        out_of_core_store(a, ma);
+        out_of_core_store(b, mb);
+        for (size_t budget : budgets) {
+            OutOfCore<double> engine(budget);
+            engine.multiply(a, b, c);
+            REQUIRE(out_of_core_load(c) == expected);
+        }
+    }
+
+    // non-finite values of one tile must not leak into the next one computed in the same buffer
+    Matrix<double> infinite = Matrix<double>::eye(4);
+    infinite.at(1, 1) = std::numeric_limits<double>::infinity();
+    out_of_core_store(a, infinite);
+    out_of_core_store(b, Matrix<double>::eye(4));
+    OutOfCore<double>(6 * 8 * 4).multiply(a, b, c);
+    Matrix<double> product = out_of_core_load(c);
+    REQUIRE(std::isinf(product.at(1, 1)));
+    REQUIRE(product.view(2, 1, 4, 4) == Matrix<double>::eye(4).view(2, 1, 4, 4));
+
+    REQUIRE(OutOfCore<double>(6 * 8 * 100).tile_size() == 10);
+    REQUIRE_THROWS(OutOfCore<double>(8).multiply(a, b, c));
+    REQUIRE_THROWS(OutOfCore<double>(1 << 20).multiply(a, a, c + "-missing/c"));
+    out_of_core_store(b, Matrix<double>::zeros(3, 3));
+    REQUIRE_THROWS(OutOfCore<double>(1 << 20).multiply(a, b, c));
+}
+
+static double out_of_core_residual(const Matrix<double>& a, const Matrix<double>& x, const Matrix<double>& b) {
+    double worst = 0;
+    for (int i = 1; i <= a.rows(); ++i) {
+        for (int c = 1; c <= b.cols(); ++c) {
+            double sum = -b.at(i, c);
+            for (int k = 1; k <= a.cols(); ++k) {
+                sum += a.at(i, k) * x.at(k, c);
+            }
+            worst = std::max(worst, std::abs(sum));
+        }
+    }
+    return worst;
+}
+
+TEST_CASE("Out of core: LU with pivoting solves systems") {
+    TempFile temp("ooc-lu");
+    const std::string& path = temp.path();
+    int sizes[] = {1, 2, 10, 37, 80};
+    for (int n : sizes) {
+        Matrix<double> a = out_of_core_sample(n, n, 3);
+        for (int i = 1; i <= n; ++i) {
+            a.at(i, i) += 0.5;
+        }
+        Matrix<double> b = out_of_core_sample(n, 3, 4);
+
+        // panels from a single column to the whole matrix
+        size_t budgets[] = {3 * 8 * static_cast<size_t>(n), 3 * 8 * 7 * static_cast<size_t>(n), 1 << 20};
+        for (size_t budget : budgets) {
+            OutOfCore<double> engine(budget);
+            out_of_core_store(path, a);
+            Matrix<double> x = engine.solve(path, b);
+            REQUIRE(out_of_core_residual(a, x, b) < 1e-8);
+        }
+    }
+}
+
+TEST_CASE("Out of core: LU factors reconstruct the matrix") {
+    TempFile temp("ooc-factors");
+    const std::string& path = temp.path();
+    int n = 9;
+    Matrix<double> a = out_of_core_sample(n, n, 5);
+    for (int i = 1; i <= n; ++i) {
+        a.at(i, i) += 0.5;
+    }
+    out_of_core_store(path, a);
+    OutOfCore<double> engine(3 * 8 * 9 * 4);
+    REQUIRE(engine.panel_width(n) == 4);
+    std::vector<int> pivots = engine.lu(path);
+    REQUIRE(pivots.size() == 9);
+    for (int i = 1; i <= n; ++i) {
+        REQUIRE(pivots[i - 1] >= i);
+        REQUIRE(pivots[i - 1] <= n);
+    }
+
+    // solving for identity gives the inverse
+    Matrix<double> inverse = engine.lu_solve(path, pivots, Matrix<double>::eye(n));
+    Matrix<double> product = a * inverse;
+    for (int i = 1; i <= n; ++i) {
+        for (int j = 1; j <= n; ++j) {
+            REQUIRE(std::abs(product.at(i, j) - (i == j ? 1 : 0)) < 1e-9);
+        }
+    }
+
+    REQUIRE_THROWS(engine.lu_solve(path, pivots, Matrix<double>::zeros(n - 1, 1)));
+    out_of_core_store(path, Matrix<double>::zeros(4, 4));
+    REQUIRE_THROWS(engine.lu(path));
+    out_of_core_store(path, Matrix<double>::zeros(4, 5));
+    REQUIRE_THROWS(engine.lu(path));
+}
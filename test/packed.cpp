@@ -0,0 +1,127 @@
+#include "catch.hpp"
+
+#include "../src/SymmetricMatrix.h"
+#include "../src/TriangularMatrix.h"
+
+Matrix<int> make_symmetric4() {
+    Matrix<int> a = Matrix<int>::natural(4, 4);
+    return a + a.transpose();
+}
+
+Matrix<double> make_lower4() {
+    Matrix<double> a = Matrix<double>::zeros(4, 4);
+    for (int i = 1; i <= 4; ++i) {
+        for (int j = 1; j <= i; ++j) {
+            a.at(i, j) = i == j ? 2 + i : i - j + 0.5;
+        }
+    }
+    return a;
+}
+
+TEST_CASE("SymmetricMatrix: packed storage mirrors elements") {
+    SymmetricMatrix<int> s = SymmetricMatrix<int>::zeros(3);
+    s.at(3, 1) = 7;
+
+    REQUIRE(s.size() == 3);
+    REQUIRE(s.at(1, 3) == 7);
+    s.at(1, 3) = 5;
+    REQUIRE(s.at(3, 1) == 5);
+    REQUIRE_THROWS(s.at(0, 1));
+    REQUIRE_THROWS(s.at(1, 4));
+    REQUIRE_THROWS(SymmetricMatrix<int>::zeros(0));
+}
+
+TEST_CASE("SymmetricMatrix: dense round trip") {
+    Matrix<int> dense = make_symmetric4();
+
+    REQUIRE(SymmetricMatrix<int>::from_dense(dense).to_dense() == dense);
+    REQUIRE_THROWS(SymmetricMatrix<int>::from_dense(Matrix<int>::natural(2, 3)));
+}
+
+TEST_CASE("SymmetricMatrix: symm and matrix-vector product match dense product") {
+    Matrix<int> dense = make_symmetric4();
+    SymmetricMatrix<int> s = SymmetricMatrix<int>::from_dense(dense);
+    Matrix<int> b = Matrix<int>::natural(4, 3);
+    Matrix<int> x = Matrix<int>::natural(4, 1);
+
+    REQUIRE(s * b == dense * b);
+    REQUIRE((s * Vector<int>::from_matrix(x)).to_matrix() == dense * x);
+    REQUIRE_THROWS(s * Matrix<int>::natural(3, 3));
+}
+
+TEST_CASE("SymmetricMatrix: syrk computes A * A^T") {
+    Matrix<int> a = Matrix<int>::natural(5, 3);
+    Matrix<int> transposed = a.transpose();
+
+    REQUIRE(SymmetricMatrix<int>::syrk(a).to_dense() == a * transposed);
+}
+
+TEST_CASE("TriangularMatrix: only the triangle is accessible") {
+    TriangularMatrix<int> lower = TriangularMatrix<int>::zeros(3, TriangularMatrix<int>::LOWER);
+    TriangularMatrix<int> upper = TriangularMatrix<int>::zeros(3, TriangularMatrix<int>::UPPER);
+    lower.at(3, 1) = 4;
+    upper.at(1, 3) = 5;
+
+    REQUIRE(lower.at(3, 1) == 4);
+    REQUIRE(upper.at(1, 3) == 5);
+    REQUIRE_THROWS(lower.at(1, 3));
+    REQUIRE_THROWS(upper.at(3, 1));
+    REQUIRE_THROWS(lower.at(4, 4));
+}
+
+TEST_CASE("TriangularMatrix: dense round trip drops the other triangle") {
+    Matrix<int> dense = Matrix<int>::natural(4, 4);
+    Matrix<int> lower = TriangularMatrix<int>::from_dense(dense, TriangularMatrix<int>::LOWER).to_dense();
+    Matrix<int> upper = TriangularMatrix<int>::from_dense(dense, TriangularMatrix<int>::UPPER).to_dense();
+
+    REQUIRE(lower.at(4, 1) == 13);
+    REQUIRE(lower.at(1, 4) == 0);
+    REQUIRE(upper.at(1, 4) == 4);
+    REQUIRE(upper.at(4, 1) == 0);
+    Matrix<int> diagonal = Matrix<int>::zeros(4, 4);
+    for (int i = 1; i <= 4; ++i) {
+        diagonal.at(i, i) = dense.at(i, i);
+    }
+    REQUIRE(lower + upper - diagonal == dense);
+}
+
+TEST_CASE("TriangularMatrix: trmm and matrix-vector product match dense product") {
+    Matrix<int> b = Matrix<int>::natural(4, 2);
+    Matrix<int> x = Matrix<int>::natural(4, 1);
+
+    for (auto part : {TriangularMatrix<int>::LOWER, TriangularMatrix<int>::UPPER}) {
+        TriangularMatrix<int> t = TriangularMatrix<int>::from_dense(Matrix<int>::natural(4, 4), part);
+        Matrix<int> dense = t.to_dense();
+        REQUIRE(t * b == dense * b);
+        REQUIRE((t * Vector<int>::from_matrix(x)).to_matrix() == dense * x);
+    }
+}
+
+TEST_CASE("TriangularMatrix: trsm solves lower and upper systems") {
+    Matrix<double> lower = make_lower4();
+    Matrix<double> upper = lower.transpose();
+    Matrix<double> x = Matrix<double>::zeros(4, 3);
+    for (int i = 1; i <= 4; ++i) {
+        for (int j = 1; j <= 3; ++j) {
+            x.at(i, j) = i - 2 * j;
+        }
+    }
+
+    Matrix<double> dense_pair[] = {lower, upper};
+    TriangularMatrix<double>::Part parts[] = {TriangularMatrix<double>::LOWER, TriangularMatrix<double>::UPPER};
+    for (int k = 0; k < 2; ++k) {
+        TriangularMatrix<double> t = TriangularMatrix<double>::from_dense(dense_pair[k], parts[k]);
+        Matrix<double> solved = t.solve(t * x);
+        for (int i = 1; i <= 4; ++i) {
+            for (int j = 1; j <= 3; ++j) {
+                REQUIRE(solved.at(i, j) == Approx(x.at(i, j)));
+            }
+        }
+    }
+}
+
+TEST_CASE("TriangularMatrix: trsm throws on singular matrix") {
+    TriangularMatrix<double> t = TriangularMatrix<double>::zeros(2, TriangularMatrix<double>::LOWER);
+
+    REQUIRE_THROWS(t.solve(Matrix<double>::zeros(2, 1)));
+}
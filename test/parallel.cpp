@@ -0,0 +1,211 @@
+#include "catch.hpp"
+
+#include <atomic>
+#include <set>
+#include <thread>
+#include "../src/Matrix.h"
+#include "../src/Parallel.h"
+
+TEST_CASE("Parallel: deque takes in LIFO and steals in FIFO order") {
+    WorkStealingDeque deque;
+    std::vector<ParallelTask*> tasks;
+    for (int i = 0; i < 200; ++i) {
+        tasks.push_back(reinterpret_cast<ParallelTask*>(static_cast<intptr_t>(i + 1) * 8));
+        deque.push(tasks.back());
+    }
+
+    REQUIRE(deque.steal() == tasks[0]);
+    REQUIRE(deque.take() == tasks[199]);
+    for (int i = 198; i >= 1; --i) {
+        REQUIRE(deque.take() == tasks[i]);
+    }
+    REQUIRE(deque.take() == nullptr);
+    REQUIRE(deque.steal() == nullptr);
+}
+
+TEST_CASE("Parallel: deque hands every task out exactly once under contention") {
+    WorkStealingDeque deque;
+    const int count = 100000;
+    std::vector<std::atomic<int> > seen(count + 1);
+    for (std::atomic<int>& s : seen) {
+        s = 0;
+    }
+    std::atomic<bool> done(false);
+
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < 3; ++t) {
+        thieves.push_back(std::thread([&]() {
+            while (!done) {
+                if (ParallelTask* task = deque.steal()) {
+                    seen[reinterpret_cast<intptr_t>(task) / 8]++;
+                }
+            }
+        }));
+    }
+    for (int i = 1; i <= count; ++i) {
+        deque.push(reinterpret_cast<ParallelTask*>(static_cast<intptr_t>(i) * 8));
+        if (i % 3 == 0) {
+            if (ParallelTask* task = deque.take()) {
+                seen[reinterpret_cast<intptr_t>(task) / 8]++;
+            }
+        }
+    }
+    while (ParallelTask* task = deque.take()) {
+        seen[reinterpret_cast<intptr_t>(task) / 8]++;
+    }
+    done = true;
+    for (std::thread& thief : thieves) {
+        thief.join();
+    }
+
+    for (int i = 1; i <= count; ++i) {
+        REQUIRE(seen[i] == 1);
+    }
+}
+
+TEST_CASE("Parallel: every index is processed exactly once") {
+    const int count = 1000000;
+    std::vector<std::atomic<int> > hits(count);
+    for (std::atomic<int>& h : hits) {
+        h = 0;
+    }
+
+    parallel_for(0, count, 100, [&](int from, int to) {
+        for (int i = from; i < to; ++i) {
+            hits[i]++;
+        }
+    });
+
+    for (int i = 0; i < count; ++i) {
+        REQUIRE(hits[i] == 1);
+    }
+}
+
+TEST_CASE("Parallel: small ranges run serially on the calling thread") {
+    std::thread::id caller = std::this_thread::get_id();
+    int calls = 0;
+    parallel_for(0, 100, 100, [&](int from, int to) {
+        REQUIRE(std::this_thread::get_id() == caller);
+        REQUIRE(from == 0);
+        REQUIRE(to == 100);
+        calls++;
+    });
+    REQUIRE(calls == 1);
+
+    parallel_for(5, 5, 1, [&](int, int) {
+        calls++;
+    });
+    REQUIRE(calls == 1);
+}
+
+TEST_CASE("Parallel: thread count can be limited globally and per call") {
+    int previous = parallel_threads();
+    std::thread::id caller = std::this_thread::get_id();
+
+    set_parallel_threads(1);
+    REQUIRE(parallel_threads() == 1);
+    int calls = 0;
+    parallel_for(0, 1000000, 1, [&](int, int) {
+        REQUIRE(std::this_thread::get_id() == caller);
+        calls++;
+    });
+    REQUIRE(calls == 1);
+
+    set_parallel_threads(4);
+    REQUIRE(parallel_threads() == 4);
+    std::atomic<int> chunks(0);
+    parallel_for(0, 1000000, 1, [&](int, int) {
+        chunks++;
+    }, 2);
+    REQUIRE(chunks == 2);
+
+    set_parallel_threads(previous);
+}
+
+TEST_CASE("Parallel: nested loops complete") {
+    std::atomic<long> sum(0);
+    parallel_for(0, 64, 1, [&](int from, int to) {
+        for (int i = from; i < to; ++i) {
+            parallel_for(0, 1000, 10, [&](int inner_from, int inner_to) {
+                sum += inner_to - inner_from;
+            });
+        }
+    });
+    REQUIRE(sum == 64000);
+}
+
+TEST_CASE("Parallel: exception is propagated to the caller") {
+    REQUIRE_THROWS_WITH(parallel_for(0, 100000, 10, [](int from, int to) {
+        if (from <= 5000 && 5000 < to) {
+            throw std::runtime_error("failure");
+        }
+    }), "failure");
+
+    // scheduler stays usable afterwards
+    std::atomic<int> total(0);
+    parallel_for(0, 100000, 10, [&](int from, int to) {
+        total += to - from;
+    });
+    REQUIRE(total == 100000);
+}
+
+TEST_CASE("Parallel: large matrix operations match element-wise definitions") {
+    int rows = 300, cols = 250;
+    Matrix<double> m = Matrix<double>::natural(rows, cols);
+    for (int i = 1; i <= rows; ++i) {
+        for (int j = 1; j <= cols; ++j) {
+            REQUIRE(m.at(i, j) == j + (i - 1) * cols);
+        }
+    }
+
+    Matrix<double> t = m.transpose();
+    REQUIRE(t.rows() == cols);
+    REQUIRE(t.cols() == rows);
+    for (int i = 1; i <= rows; ++i) {
+        for (int j = 1; j <= cols; ++j) {
+            REQUIRE(t.at(j, i) == m.at(i, j));
+        }
+    }
+
+    Matrix<double> cloned = m.clone();
+    REQUIRE(cloned == m);
+    cloned.at(rows, cols) += 1;
+    REQUIRE(cloned != m);
+
+    Matrix<double> doubled = m.clone();
+    doubled += m;
+    REQUIRE(doubled == m * 2.0);
+    REQUIRE(doubled.at(17, 33) == 2 * m.at(17, 33));
+}
+
+TEST_CASE("Parallel: large views are handled row by row") {
+    Matrix<int> m = Matrix<int>::natural(400, 400);
+    Matrix<int> view = m.view(101, 51, 400, 350);
+    Matrix<int> cloned = view.clone();
+
+    REQUIRE(cloned.rows() == 300);
+    REQUIRE(cloned.cols() == 300);
+    REQUIRE(cloned.at(1, 1) == m.at(101, 51));
+    REQUIRE(cloned.at(300, 300) == m.at(400, 350));
+
+    view += cloned;
+    REQUIRE(m.at(101, 51) == 2 * cloned.at(1, 1));
+    REQUIRE(m.at(100, 51) == 99 * 400 + 51);
+}
+
+TEST_CASE("Parallel: large to_string keeps row order") {
+    Matrix<int> m = Matrix<int>::natural(2000, 20);
+    std::string text = m.to_string();
+
+    std::string expected = "[\n";
+    for (int i = 1; i <= 2000; ++i) {
+        for (int j = 1; j <= 20; ++j) {
+            std::stringstream element;
+            element << std::setw(5) << m.at(i, j) << ", ";
+            expected += element.str();
+        }
+        expected += "\n";
+    }
+    expected += "]\n";
+    REQUIRE(text == expected);
+}
@@ -0,0 +1,149 @@
+#include "catch.hpp"
+
+#include "../src/Preconditioner.h"
+
+// 1D Poisson matrix with a varying diagonal, symmetric positive definite
+Matrix<double> make_spd(int size) {
+    Matrix<double> a = Matrix<double>::zeros(size);
+    for (int i = 1; i <= size; ++i) {
+        a.at(i, i) = 2 + i;
+        if (i > 1) {
+            a.at(i, i - 1) = -1;
+            a.at(i - 1, i) = -1;
+        }
+    }
+    return a;
+}
+
+Matrix<double> make_rhs(int size) {
+    Matrix<double> b = Matrix<double>::zeros(size, 1);
+    for (int i = 1; i <= size; ++i) {
+        b.at(i, 1) = i;
+    }
+    return b;
+}
+
+void require_solution(const Matrix<double>& a, const Matrix<double>& x, const Matrix<double>& b) {
+    for (int i = 1; i <= a.rows(); ++i) {
+        double sum = 0;
+        for (int j = 1; j <= a.cols(); ++j) {
+            sum += a.at(i, j) * x.at(j, 1);
+        }
+        REQUIRE(sum == Approx(b.at(i, 1)));
+    }
+}
+
+TEST_CASE("Preconditioner: should not be applied before setup") {
+    JacobiPreconditioner<double> jacobi;
+
+    REQUIRE_FALSE(jacobi.ready());
+    REQUIRE_THROWS(jacobi.apply(Matrix<double>::zeros(2, 1)));
+}
+
+TEST_CASE("Preconditioner: should throw on non-square or incompatible dimensions") {
+    JacobiPreconditioner<double> jacobi;
+
+    REQUIRE_THROWS(jacobi.setup(Matrix<double>::zeros(2, 3)));
+    jacobi.setup(make_spd(3));
+    REQUIRE_THROWS(jacobi.apply(Matrix<double>::zeros(2, 1)));
+}
+
+TEST_CASE("Preconditioner: Jacobi divides by diagonal") {
+    JacobiPreconditioner<double> jacobi;
+    jacobi.setup(make_spd(3));
+
+    Matrix<double> z = jacobi.apply(make_rhs(3));
+    REQUIRE(z.at(1, 1) == Approx(1.0 / 3));
+    REQUIRE(z.at(2, 1) == Approx(2.0 / 4));
+    REQUIRE(z.at(3, 1) == Approx(3.0 / 5));
+}
+
+TEST_CASE("Preconditioner: ILU(0) and IC(0) are exact for tridiagonal matrices") {
+    // no fill-in is produced by a tridiagonal matrix, so incomplete factorizations are complete
+    Matrix<double> a = make_spd(6);
+    Matrix<double> b = make_rhs(6);
+
+    ILU0Preconditioner<double> ilu;
+    ilu.setup(a);
+    require_solution(a, ilu.apply(b), b);
+
+    IC0Preconditioner<double> ic;
+    ic.setup(a);
+    require_solution(a, ic.apply(b), b);
+}
+
+TEST_CASE("Preconditioner: IC(0) rejects indefinite matrices") {
+    Matrix<double> a = Matrix<double>::zeros(2);
+    a.at(1, 1) = 1;
+    a.at(1, 2) = 2;
+    a.at(2, 1) = 2;
+    a.at(2, 2) = 1;
+
+    IC0Preconditioner<double> ic;
+    REQUIRE_THROWS(ic.setup(a));
+}
+
+TEST_CASE("Preconditioner: SSOR rejects invalid relaxation factor") {
+    REQUIRE_THROWS(SSORPreconditioner<double>(0));
+    REQUIRE_THROWS(SSORPreconditioner<double>(2));
+}
+
+TEST_CASE("Preconditioner: conjugate gradient converges with every preconditioner") {
+    Matrix<double> a = make_spd(20);
+    Matrix<double> b = make_rhs(20);
+
+    JacobiPreconditioner<double> jacobi;
+    SSORPreconditioner<double> ssor(1.2);
+    ILU0Preconditioner<double> ilu;
+    IC0Preconditioner<double> ic;
+    Preconditioner<double>* all[] = {&jacobi, &ssor, &ilu, &ic};
+
+    for (Preconditioner<double>* m : all) {
+        m->setup(a);
+        int iterations = 0;
+        Matrix<double> x = conjugate_gradient(a, b, *m, 1e-12, 100, &iterations);
+        require_solution(a, x, b);
+        REQUIRE(iterations <= 20);
+    }
+}
+
+TEST_CASE("Preconditioner: setup is reused across solves") {
+    Matrix<double> a = make_spd(10);
+    IC0Preconditioner<double> ic;
+    ic.setup(a);
+
+    for (int k = 1; k <= 3; ++k) {
+        Matrix<double> b = make_rhs(10) * k;
+        int iterations = 0;
+        Matrix<double> x = conjugate_gradient(a, b, ic, 1e-12, 100, &iterations);
+        require_solution(a, x, b);
+        REQUIRE(iterations <= 1);
+    }
+}
+
+TEST_CASE("Preconditioner: sparse operators give the same results as dense ones") {
+    Matrix<double> dense = make_spd(30);
+    dense.at(1, 5) = dense.at(5, 1) = -0.5;
+    SparseMatrix<double> a = SparseMatrix<double>::from_dense(dense);
+    Vector<double> b = Vector<double>::from_matrix(make_rhs(30));
+
+    JacobiPreconditioner<double> jacobi;
+    SSORPreconditioner<double> ssor(1.2);
+    ILU0Preconditioner<double> ilu;
+    IC0Preconditioner<double> ic;
+    Preconditioner<double>* all[] = {&jacobi, &ssor, &ilu, &ic};
+
+    for (Preconditioner<double>* m : all) {
+        m->setup(a);
+        Matrix<double> sparse_z = m->apply(b).to_matrix();
+        m->setup(dense);
+        Matrix<double> dense_z = m->apply(b.to_matrix());
+        for (int i = 1; i <= 30; ++i) {
+            REQUIRE(sparse_z.at(i, 1) == Approx(dense_z.at(i, 1)));
+        }
+
+        m->setup(a);
+        Vector<double> x = conjugate_gradient(a, b, *m, 1e-12, 100);
+        require_solution(dense, x.to_matrix(), b.to_matrix());
+    }
+}
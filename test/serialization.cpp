@@ -0,0 +1,123 @@
+#include "catch.hpp"
+
+#include <cstdio>
+#include <cmath>
+#include <limits>
+#include <fstream>
+#include "temp_file.h"
+#include "../src/Serialization.h"
+
+TEST_CASE("Serialization: CRC-32 matches the standard check value") {
+    const char* text = "123456789";
+    REQUIRE(crc32(text, 9) == 0xCBF43926u);
+    REQUIRE(crc32(text, 0) == 0);
+    REQUIRE(crc32(text + 4, 5, crc32(text, 4)) == 0xCBF43926u);
+    REQUIRE(crc32_combine(crc32(text, 4), crc32(text + 4, 5), 5) == 0xCBF43926u);
+
+    std::vector<unsigned char> data(3 * CRC32_CHUNK + 12345);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<unsigned char>(i * 31 + (i >> 11));
+    }
+    REQUIRE(crc32_parallel(data.data(), data.size()) == crc32(data.data(), data.size()));
+}
+
+TEST_CASE("Serialization: doubles round trip exactly") {
+    TempFile temp("serialization-doubles");
+    const std::string& path = temp.path();
+    Matrix<double> m = Matrix<double>::zeros(3, 4);
+    m.at(1, 1) = 0.1;
+    m.at(1, 2) = 1.0 / 3;
+    m.at(2, 3) = std::numeric_limits<double>::denorm_min();
+    m.at(3, 4) = -std::numeric_limits<double>::max();
+    m.at(3, 1) = std::numeric_limits<double>::infinity();
+
+    save_matrix(m, path);
+    Matrix<double> loaded = load_matrix<double>(path);
+    REQUIRE(loaded == m);
+    REQUIRE(loaded.at(1, 2) == 1.0 / 3);
+}
+
+TEST_CASE("Serialization: storage is kept as it is") {
+    TempFile temp("serialization-storage");
+    const std::string& path = temp.path();
+    Matrix<float> padded = Matrix<float>::natural(20, 1000);
+    save_matrix(padded, path);
+    Matrix<float> loaded = load_matrix<float>(path);
+    REQUIRE(loaded.stride() == padded.stride());
+    REQUIRE(loaded == padded);
+
+    Matrix<int> natural = Matrix<int>::natural(5, 6);
+    save_matrix(natural.view(2, 2, 4, 5), path);
+    REQUIRE(load_matrix<int>(path) == natural.view(2, 2, 4, 5).clone());
+
+    Matrix<int64_t, ColumnMajor> columns = Matrix<int64_t>::natural(4, 3).to_layout<ColumnMajor>();
+    save_matrix(columns, path);
+    Matrix<int64_t, ColumnMajor> loaded_columns = load_matrix<int64_t, ColumnMajor>(path);
+    REQUIRE(loaded_columns == columns);
+    REQUIRE(load_matrix<int64_t>(path) == Matrix<int64_t>::natural(4, 3));
+
+    typedef Matrix<double, Tiled<4>> SerializationTiled;
+    SerializationTiled tiles = SerializationTiled::natural(9, 7);
+    save_matrix(tiles, path);
+    SerializationTiled loaded_tiles = load_matrix<double, Tiled<4>>(path);
+    REQUIRE(loaded_tiles == tiles);
+    REQUIRE_THROWS(load_matrix<double>(path));
+}
+
+TEST_CASE("Serialization: large matrices") {
+    TempFile temp("serialization-large");
+    const std::string& path = temp.path();
+    Matrix<double> m = Matrix<double>::natural(700, 900);
+    save_matrix(m, path);
+    REQUIRE(load_matrix<double>(path) == m);
+}
+
+TEST_CASE("Serialization: streams") {
+    std::stringstream stream;
+    Matrix<int> first = Matrix<int>::natural(2, 3);
+    Matrix<int> second = Matrix<int>::natural(4, 1);
+    save_matrix(first, stream);
+    save_matrix(second, stream);
+    REQUIRE(load_matrix<int>(stream) == first);
+    REQUIRE(load_matrix<int>(stream) == second);
+    REQUIRE_THROWS(load_matrix<int>(stream));
+
+    std::stringstream columns;
+    save_matrix(first.to_layout<ColumnMajor>(), columns);
+    save_matrix(first, columns);
+    REQUIRE(load_matrix<int>(columns) == first);
+    Matrix<int, ColumnMajor> converted = load_matrix<int, ColumnMajor>(columns);
+    REQUIRE(converted == first.to_layout<ColumnMajor>());
+
+    std::stringstream tiles;
+    save_matrix(first.to_layout<Tiled<4>>(), tiles);
+    REQUIRE_THROWS_WITH(load_matrix<int>(tiles), "Cannot load matrix: unsupported layout");
+}
+
+TEST_CASE("Serialization: damaged files are rejected") {
+    TempFile temp("serialization-damaged");
+    const std::string& path = temp.path();
+    REQUIRE_THROWS(load_matrix<double>(path));
+
+    save_matrix(Matrix<double>::natural(10, 10), path);
+    REQUIRE_THROWS(load_matrix<float>(path));
+
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(sizeof(SerializedHeader) + 8 * 33);
+        file.put(1);
+    }
+    REQUIRE_THROWS_WITH(load_matrix<double>(path), "Cannot load matrix: checksum mismatch");
+
+    save_matrix(Matrix<double>::natural(10, 10), path);
+    REQUIRE(truncate(path.c_str(), sizeof(SerializedHeader) + 799) == 0);
+    REQUIRE_THROWS(load_matrix<double>(path));
+    REQUIRE(truncate(path.c_str(), 10) == 0);
+    REQUIRE_THROWS(load_matrix<double>(path));
+
+    {
+        std::ofstream file(path);
+        file << "this is plain text that is long enough to be mistaken for a header";
+    }
+    REQUIRE_THROWS(load_matrix<double>(path));
+}
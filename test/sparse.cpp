@@ -0,0 +1,127 @@
+#include "catch.hpp"
+
+#include "../src/SparseMatrix.h"
+
+// [ 1 0 2 0
+//   0 0 3 0
+//   4 5 0 6 ]
+SparseMatrix<int> make_sparse3x4() {
+    std::vector<Triplet<int> > triplets = {
+            {3, 4, 6}, {1, 1, 1}, {2, 3, 3}, {3, 1, 4}, {1, 3, 2}, {3, 2, 5}
+    };
+    return SparseMatrix<int>::from_triplets(3, 4, triplets);
+}
+
+TEST_CASE("SparseMatrix: should build from triplets with sorted rows") {
+    SparseMatrix<int> a = make_sparse3x4();
+
+    REQUIRE(a.rows() == 3);
+    REQUIRE(a.cols() == 4);
+    REQUIRE(a.nonzeros() == 6);
+    REQUIRE(a.row_offsets() == std::vector<int>({0, 2, 3, 6}));
+    REQUIRE(a.col_indices() == std::vector<int>({0, 2, 2, 0, 1, 3}));
+    REQUIRE(a.values() == std::vector<int>({1, 2, 3, 4, 5, 6}));
+}
+
+TEST_CASE("SparseMatrix: duplicate triplets are summed") {
+    std::vector<Triplet<int> > triplets = {{1, 1, 1}, {2, 2, 5}, {1, 1, 2}};
+    SparseMatrix<int> a = SparseMatrix<int>::from_triplets(2, 2, triplets);
+
+    REQUIRE(a.nonzeros() == 2);
+    REQUIRE(a.at(1, 1) == 3);
+}
+
+TEST_CASE("SparseMatrix: should throw on invalid dimensions and coordinates") {
+    std::vector<Triplet<int> > outside = {{3, 1, 1}};
+
+    REQUIRE_THROWS(SparseMatrix<int>::zeros(0, 2));
+    REQUIRE_THROWS(SparseMatrix<int>::from_triplets(2, 2, outside));
+    REQUIRE_THROWS(make_sparse3x4().at(0, 1));
+    REQUIRE_THROWS(make_sparse3x4().at(4, 1));
+    REQUIRE_THROWS(make_sparse3x4().at(1, 5));
+}
+
+TEST_CASE("SparseMatrix: at() returns stored elements and zeros elsewhere") {
+    SparseMatrix<int> a = make_sparse3x4();
+
+    REQUIRE(a.at(1, 1) == 1);
+    REQUIRE(a.at(1, 2) == 0);
+    REQUIRE(a.at(2, 3) == 3);
+    REQUIRE(a.at(3, 4) == 6);
+    REQUIRE(a.at(2, 4) == 0);
+}
+
+TEST_CASE("SparseMatrix: dense round trip") {
+    Matrix<int> dense = make_sparse3x4().to_dense();
+
+    REQUIRE(dense.at(3, 2) == 5);
+    REQUIRE(dense.at(2, 1) == 0);
+    REQUIRE(SparseMatrix<int>::from_dense(dense) == make_sparse3x4());
+    REQUIRE(SparseMatrix<int>::from_dense(Matrix<int>::natural(3, 3)).to_dense() == Matrix<int>::natural(3, 3));
+}
+
+TEST_CASE("SparseMatrix: transpose") {
+    SparseMatrix<int> a = make_sparse3x4();
+
+    REQUIRE(a.transpose().to_dense() == a.to_dense().transpose());
+    REQUIRE(a.transpose().transpose() == a);
+}
+
+TEST_CASE("SparseMatrix: SpMV matches dense product") {
+    SparseMatrix<int> a = make_sparse3x4();
+    Matrix<int> x = Matrix<int>::natural(4, 1);
+    Matrix<int> dense = a.to_dense();
+
+    Vector<int> y = a * Vector<int>::from_matrix(x);
+    REQUIRE(y.to_matrix() == dense * x);
+    REQUIRE_THROWS(a * Vector<int>::zeros(3));
+}
+
+TEST_CASE("SparseMatrix: SpMM with dense matrix") {
+    SparseMatrix<int> a = make_sparse3x4();
+    Matrix<int> b = Matrix<int>::natural(4, 2);
+    Matrix<int> dense = a.to_dense();
+
+    REQUIRE(a * b == dense * b);
+    REQUIRE_THROWS(a * Matrix<int>::natural(3, 2));
+}
+
+TEST_CASE("SparseMatrix: large SpMV is split between threads") {
+    int n = 100000;
+    std::vector<Triplet<long> > triplets;
+    for (int i = 1; i <= n; ++i) {
+        triplets.push_back({i, i, 2});
+        if (i > 1) {
+            triplets.push_back({i, i - 1, -1});
+        }
+    }
+    SparseMatrix<long> a = SparseMatrix<long>::from_triplets(n, n, triplets);
+    Vector<long> x = Vector<long>::zeros(n);
+    for (int i = 1; i <= n; ++i) {
+        x.at(i) = i;
+    }
+
+    Vector<long> y = a * x;
+    REQUIRE(y.at(1) == 2);
+    for (int i = 2; i <= n; ++i) {
+        REQUIRE(y.at(i) == i + 1);
+    }
+}
+
+TEST_CASE("SparseMatrix: elementwise operations") {
+    SparseMatrix<int> a = make_sparse3x4();
+    SparseMatrix<int> b = SparseMatrix<int>::from_dense(Matrix<int>::natural(3, 4));
+    Matrix<int> dense_a = a.to_dense();
+    Matrix<int> dense_b = b.to_dense();
+
+    REQUIRE((a + b).to_dense() == dense_a + dense_b);
+    REQUIRE((a - b).to_dense() == dense_a - dense_b);
+    REQUIRE((a * 3).to_dense() == dense_a * 3);
+
+    SparseMatrix<int> product = a.multiply_elementwise(b);
+    REQUIRE(product.nonzeros() == a.nonzeros());
+    REQUIRE(product.at(3, 4) == 6 * 12);
+    REQUIRE(product.at(2, 3) == 3 * 7);
+
+    REQUIRE_THROWS(a + SparseMatrix<int>::zeros(3, 3));
+}
@@ -0,0 +1,119 @@
+#include "catch.hpp"
+
+#include "../src/SparseCholesky.h"
+
+// 5-point Laplacian on a size x size grid with shifted diagonal, symmetric positive definite
+SparseMatrix<double> make_laplacian(int size, double shift = 0) {
+    std::vector<Triplet<double> > triplets;
+    for (int x = 0; x < size; ++x) {
+        for (int y = 0; y < size; ++y) {
+            int node = x * size + y + 1;
+            triplets.push_back({node, node, 4 + shift});
+            if (x > 0) {
+                triplets.push_back({node, node - size, -1});
+            }
+            if (x < size - 1) {
+                triplets.push_back({node, node + size, -1});
+            }
+            if (y > 0) {
+                triplets.push_back({node, node - 1, -1});
+            }
+            if (y < size - 1) {
+                triplets.push_back({node, node + 1, -1});
+            }
+        }
+    }
+    return SparseMatrix<double>::from_triplets(size * size, size * size, triplets);
+}
+
+void require_sparse_solution(const SparseMatrix<double>& a, const Vector<double>& x, const Vector<double>& b) {
+    Vector<double> product = a * x;
+    for (int i = 1; i <= b.size(); ++i) {
+        REQUIRE(product.at(i) == Approx(b.at(i)));
+    }
+}
+
+TEST_CASE("Minimum degree: returns a permutation") {
+    SparseMatrix<double> a = make_laplacian(6);
+    std::vector<int> order = minimum_degree_ordering(a);
+
+    REQUIRE(order.size() == 36);
+    std::sort(order.begin(), order.end());
+    for (int i = 0; i < 36; ++i) {
+        REQUIRE(order[i] == i);
+    }
+}
+
+TEST_CASE("Minimum degree: arrow matrix eliminates the hub at the end") {
+    // dense first row and column, natural order would fill the whole matrix
+    std::vector<Triplet<double> > triplets;
+    for (int i = 1; i <= 8; ++i) {
+        triplets.push_back({i, i, 10});
+        if (i > 1) {
+            triplets.push_back({1, i, 1});
+            triplets.push_back({i, 1, 1});
+        }
+    }
+    SparseMatrix<double> a = SparseMatrix<double>::from_triplets(8, 8, triplets);
+
+    // hub and the last leaf tie at the end
+    std::vector<int> order = minimum_degree_ordering(a);
+    REQUIRE((order[6] == 0 || order[7] == 0));
+    SparseCholesky<double> cholesky(a);
+    REQUIRE(cholesky.factor_nonzeros() == 8 + 7);
+}
+
+TEST_CASE("SparseCholesky: solves Laplacian system") {
+    SparseMatrix<double> a = make_laplacian(12);
+    Vector<double> b = Vector<double>::zeros(a.rows());
+    for (int i = 1; i <= b.size(); ++i) {
+        b.at(i) = i % 7;
+    }
+
+    SparseCholesky<double> cholesky(a);
+    require_sparse_solution(a, cholesky.solve(b), b);
+    REQUIRE(cholesky.supernodes() < a.rows());
+}
+
+TEST_CASE("SparseCholesky: dense matrix is a single supernode") {
+    Matrix<double> dense = Matrix<double>::zeros(5, 5);
+    for (int i = 1; i <= 5; ++i) {
+        for (int j = 1; j <= 5; ++j) {
+            dense.at(i, j) = i == j ? 10 : 1.0 / (i + j);
+        }
+    }
+    SparseMatrix<double> a = SparseMatrix<double>::from_dense(dense);
+    Vector<double> b = Vector<double>::from_matrix(Matrix<double>::natural(5, 1));
+
+    SparseCholesky<double> cholesky(a);
+    REQUIRE(cholesky.supernodes() == 1);
+    REQUIRE(cholesky.factor_nonzeros() == 15);
+    require_sparse_solution(a, cholesky.solve(b), b);
+}
+
+TEST_CASE("SparseCholesky: symbolic analysis is reused by refactorization") {
+    SparseCholesky<double> cholesky;
+    cholesky.analyze(make_laplacian(8));
+    std::vector<int> ordering = cholesky.permutation();
+    Vector<double> b = Vector<double>::zeros(64);
+    b.at(10) = 1;
+
+    for (int k = 0; k < 3; ++k) {
+        SparseMatrix<double> a = make_laplacian(8, k);
+        cholesky.factorize(a);
+        require_sparse_solution(a, cholesky.solve(b), b);
+        REQUIRE(cholesky.permutation() == ordering);
+    }
+}
+
+TEST_CASE("SparseCholesky: should throw on invalid use") {
+    SparseCholesky<double> cholesky;
+
+    REQUIRE_THROWS(cholesky.factorize(make_laplacian(3)));
+    REQUIRE_THROWS(cholesky.analyze(SparseMatrix<double>::zeros(2, 3)));
+
+    cholesky.analyze(make_laplacian(3));
+    REQUIRE_THROWS(cholesky.solve(Vector<double>::zeros(9)));
+    REQUIRE_THROWS(cholesky.factorize(make_laplacian(4)));
+    REQUIRE_THROWS(cholesky.factorize(make_laplacian(3, -10)));
+}
@@ -0,0 +1,107 @@
+#include "catch.hpp"
+
+#include "../src/Matrix.h"
+
+static bool storage_all_zero(const Matrix<double>& m) {
+    for (int i = 1; i <= m.rows(); ++i) {
+        const double* row = m.row_data(i);
+        for (int j = 0; j < m.cols(); ++j) {
+            if (row[j] != 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+TEST_CASE("Storage: machine has at least one NUMA node") {
+    REQUIRE(numa_nodes() >= 1);
+}
+
+TEST_CASE("Storage: large storage is mapped, small is not") {
+    REQUIRE(!storage_is_mapped<double>(100));
+    REQUIRE(storage_is_mapped<double>(1 << 20));
+    REQUIRE(!storage_is_mapped<std::string>(1 << 20));
+}
+
+TEST_CASE("Storage: every placement gives zeroed matrices") {
+    NumaPolicy policies[] = {
+            NumaPolicy::default_placement(), NumaPolicy::first_touch(),
+            NumaPolicy::interleave(), NumaPolicy::bind(0)
+    };
+    for (const NumaPolicy& policy : policies) {
+        Matrix<double> small = Matrix<double>::zeros(10, 10, policy);
+        Matrix<double> large = Matrix<double>::zeros(700, 500, policy);
+        REQUIRE(storage_all_zero(small));
+        REQUIRE(storage_all_zero(large));
+
+        large.at(700, 500) = 1;
+        Matrix<double> copy = large;
+        REQUIRE(copy == large);
+        REQUIRE(copy.at(700, 500) == 1);
+    }
+}
+
+TEST_CASE("Storage: binding to nonexistent node is rejected") {
+    REQUIRE_THROWS(Matrix<double>::zeros(10, 10, NumaPolicy::bind(numa_nodes())));
+    REQUIRE_THROWS(Matrix<double>::zeros(10, 10, NumaPolicy::bind(-1)));
+    REQUIRE_THROWS(set_numa_policy(NumaPolicy::bind(numa_nodes())));
+}
+
+TEST_CASE("Storage: global policy applies to new matrices") {
+    set_numa_policy(NumaPolicy::first_touch());
+    REQUIRE(numa_policy().placement == NumaPolicy::FIRST_TOUCH);
+    Matrix<double> m = Matrix<double>::natural(600, 600);
+    REQUIRE(m.at(600, 600) == 360000);
+    set_numa_policy(NumaPolicy::default_placement());
+    REQUIRE(numa_policy().placement == NumaPolicy::DEFAULT);
+}
+
+TEST_CASE("Storage: moved views keep their bounds") {
+    Matrix<int> m = Matrix<int>::natural(4, 4);
+    Matrix<int> view(std::move(m.view(2, 2, 3, 3)));
+    REQUIRE(view.rows() == 2);
+    REQUIRE(view.cols() == 2);
+    REQUIRE(view.at(1, 1) == 6);
+
+    Matrix<int> moved(std::move(m));
+    REQUIRE(moved.at(4, 4) == 16);
+}
+
+TEST_CASE("Storage: storage is aligned to cache lines") {
+    Matrix<char> small = Matrix<char>::zeros(3, 7);
+    Matrix<double> large = Matrix<double>::zeros(1000, 1000);
+    REQUIRE(reinterpret_cast<uintptr_t>(small.row_data(1)) % STORAGE_ALIGNMENT == 0);
+    REQUIRE(reinterpret_cast<uintptr_t>(large.row_data(1)) % STORAGE_ALIGNMENT == 0);
+
+    Matrix<std::string> strings = Matrix<std::string>::zeros(2, 2);
+    REQUIRE(reinterpret_cast<uintptr_t>(&strings.at(1, 1)) % STORAGE_ALIGNMENT == 0);
+    strings.at(2, 2) = "text";
+    REQUIRE(strings.at(1, 1).empty());
+}
+
+TEST_CASE("Storage: huge page eligible storage is aligned to huge pages") {
+    HugePages::Mode modes[] = {HugePages::NONE, HugePages::TRANSPARENT, HugePages::EXPLICIT};
+    for (HugePages::Mode mode : modes) {
+        set_huge_pages(mode);
+        Matrix<double> m = Matrix<double>::zeros(1500, 1500);
+        if (mode != HugePages::NONE) {
+            REQUIRE(reinterpret_cast<uintptr_t>(m.row_data(1)) % HUGE_PAGE_SIZE == 0);
+        }
+        m.at(1500, 1500) = 1;
+        REQUIRE(m.at(1500, 1500) == 1);
+        REQUIRE(m.at(1, 1) == 0);
+    }
+    set_huge_pages(HugePages::TRANSPARENT);
+    REQUIRE(storage_mapped_length<double>(1500 * 1500) % HUGE_PAGE_SIZE == 0);
+    REQUIRE(storage_mapped_length<double>(300000) % 4096 == 0);
+}
+
+TEST_CASE("Storage: padded pitch keeps rows aligned and avoids 4K multiples") {
+    REQUIRE(padded_pitch<double>(8) == 8);
+    REQUIRE(padded_pitch<double>(10) == 16);
+    REQUIRE(padded_pitch<double>(512) == 520);
+    REQUIRE(padded_pitch<double>(1024) == 1032);
+    REQUIRE(padded_pitch<float>(100) == 112);
+    REQUIRE(padded_pitch<char>(4096) == 4160);
+}
@@ -0,0 +1,90 @@
+#include "catch.hpp"
+
+#include "../src/Matrix.h"
+
+static Matrix<int> stride_natural(int rows, int cols, int stride) {
+    Matrix<int> m = Matrix<int>::with_stride(rows, cols, stride);
+    for (int i = 1; i <= rows; ++i) {
+        for (int j = 1; j <= cols; ++j) {
+            m.at(i, j) = j + (i - 1) * cols;
+        }
+    }
+    return m;
+}
+
+TEST_CASE("Stride: small matrices are not padded") {
+    Matrix<int> m = Matrix<int>::zeros(3, 5);
+    REQUIRE(m.stride() == 5);
+    REQUIRE(m.contiguous());
+}
+
+TEST_CASE("Stride: long rows are padded to cache lines and away from 4K multiples") {
+    Matrix<double> m = Matrix<double>::zeros(4, 1024);
+    REQUIRE(m.stride() == 1032);
+    REQUIRE(!m.contiguous());
+    REQUIRE(m.row_data(2) - m.row_data(1) == 1032);
+    REQUIRE(reinterpret_cast<uintptr_t>(m.row_data(3)) % STORAGE_ALIGNMENT == 0);
+
+    Matrix<double> odd = Matrix<double>::zeros(4, 100);
+    REQUIRE(odd.stride() == 104);
+}
+
+TEST_CASE("Stride: explicit stride") {
+    Matrix<int> m = Matrix<int>::with_stride(3, 4, 7);
+    REQUIRE(m.rows() == 3);
+    REQUIRE(m.cols() == 4);
+    REQUIRE(m.stride() == 7);
+    REQUIRE(m.row_data(3) - m.row_data(1) == 14);
+    REQUIRE(Matrix<int>::with_stride(2, 4, 4).contiguous());
+
+    REQUIRE_THROWS(Matrix<int>::with_stride(3, 4, 3));
+    REQUIRE_THROWS(Matrix<int>::with_stride(0, 4, 4));
+}
+
+TEST_CASE("Stride: views report the stride of the parent") {
+    Matrix<int> m = stride_natural(4, 4, 9);
+    Matrix<int> view = m.view(2, 2, 3, 4);
+    REQUIRE(view.stride() == 9);
+    REQUIRE(!view.contiguous());
+    REQUIRE(m.view(2, 1, 2, 3).contiguous());
+    REQUIRE(view.at(1, 1) == 6);
+    REQUIRE(view.row_data(2)[2] == 12);
+}
+
+TEST_CASE("Stride: operations ignore padding") {
+    Matrix<int> padded = stride_natural(3, 3, 8);
+    Matrix<int> dense = Matrix<int>::natural(3, 3);
+
+    REQUIRE(padded == dense);
+    REQUIRE(padded.clone() == dense);
+    REQUIRE(padded.transpose() == dense.transpose());
+    REQUIRE(padded * 2 == dense * 2);
+    REQUIRE(padded + dense == dense * 2);
+    REQUIRE(padded * dense == dense * dense);
+    REQUIRE(padded.det() == dense.det());
+    REQUIRE(padded.to_string() == dense.to_string());
+    REQUIRE(padded.concat_horizontal(dense) == dense.concat_horizontal(dense));
+
+    int sum = 0;
+    for (int element : padded) {
+        sum += element;
+    }
+    REQUIRE(sum == 45);
+
+    padded += dense;
+    REQUIRE(padded == dense * 2);
+    padded.put(Matrix<int>::zeros(2), 2, 2);
+    REQUIRE(padded.at(3, 3) == 0);
+    REQUIRE(padded.at(3, 1) == 14);
+}
+
+TEST_CASE("Stride: padded large matrices") {
+    Matrix<double> m = Matrix<double>::natural(300, 1024);
+    REQUIRE(m.stride() > m.cols());
+    REQUIRE(m.at(300, 1024) == 300 * 1024);
+
+    Matrix<double> t = m.transpose();
+    REQUIRE(t.stride() == padded_pitch<double>(300));
+    REQUIRE(t.at(1024, 300) == 300 * 1024);
+    REQUIRE(t.transpose() == m);
+}
@@ -0,0 +1,102 @@
+#include "catch.hpp"
+
+#include "../src/StructuredMatrix.h"
+
+DiagonalMatrix<int> make_diagonal123() {
+    return DiagonalMatrix<int>(Vector<int>::from_matrix(Matrix<int>::natural(3, 1)));
+}
+
+TEST_CASE("IdentityMatrix: behaves like eye()") {
+    IdentityMatrix<int> identity(3);
+    Matrix<int> a = Matrix<int>::natural(3, 3);
+
+    REQUIRE(identity.at(2, 2) == 1);
+    REQUIRE(identity.at(2, 3) == 0);
+    REQUIRE(identity.to_dense() == Matrix<int>::eye(3));
+    REQUIRE(identity * a == a);
+    REQUIRE(a * identity == a);
+    REQUIRE_THROWS(identity * Matrix<int>::natural(2, 2));
+    REQUIRE_THROWS(IdentityMatrix<int>(0));
+}
+
+TEST_CASE("DiagonalMatrix: element access and dense conversion") {
+    DiagonalMatrix<int> d = make_diagonal123();
+
+    REQUIRE(d.size() == 3);
+    REQUIRE(d.at(2) == 2);
+    REQUIRE(d.at(3, 3) == 3);
+    REQUIRE(d.at(1, 3) == 0);
+    REQUIRE(DiagonalMatrix<int>::from_dense(d.to_dense()).to_dense() == d.to_dense());
+    REQUIRE_THROWS(d.at(4, 4));
+}
+
+TEST_CASE("DiagonalMatrix: products scale rows and columns") {
+    DiagonalMatrix<int> d = make_diagonal123();
+    Matrix<int> dense = d.to_dense();
+    Matrix<int> a = Matrix<int>::natural(3, 3);
+    Matrix<int> tall = Matrix<int>::natural(3, 2);
+    Matrix<int> wide = Matrix<int>::natural(2, 3);
+
+    REQUIRE(d * a == dense * a);
+    REQUIRE(a * d == a * dense);
+    REQUIRE(d * tall == dense * tall);
+    REQUIRE(wide * d == wide * dense);
+    REQUIRE((d * d).to_dense() == dense * dense);
+    REQUIRE((d * Vector<int>::from_matrix(Matrix<int>::natural(3, 1))).at(3) == 9);
+    REQUIRE_THROWS(d * wide);
+    REQUIRE_THROWS(tall * d);
+}
+
+TEST_CASE("DiagonalMatrix: inverse") {
+    DiagonalMatrix<double> d = DiagonalMatrix<double>::zeros(2);
+    d.at(1) = 2;
+    d.at(2) = 4;
+
+    REQUIRE(d.inverse().at(1) == Approx(0.5));
+    REQUIRE(d.inverse().at(2) == Approx(0.25));
+    REQUIRE_THROWS(DiagonalMatrix<double>::zeros(2).inverse());
+}
+
+TEST_CASE("PermutationMatrix: should reject invalid permutations") {
+    REQUIRE_THROWS(PermutationMatrix(std::vector<int>()));
+    REQUIRE_THROWS(PermutationMatrix({1, 1, 2}));
+    REQUIRE_THROWS(PermutationMatrix({0, 1, 2}));
+    REQUIRE_THROWS(PermutationMatrix({1, 2, 4}));
+}
+
+TEST_CASE("PermutationMatrix: dense form has single 1 in every row") {
+    PermutationMatrix p({3, 1, 2});
+    Matrix<int> dense = p.to_dense<int>();
+
+    REQUIRE(dense.at(1, 3) == 1);
+    REQUIRE(dense.at(2, 1) == 1);
+    REQUIRE(dense.at(3, 2) == 1);
+    REQUIRE(dense.at(1, 1) == 0);
+    REQUIRE(p.at(1, 3) == 1);
+    REQUIRE(p.at(1, 2) == 0);
+    REQUIRE(PermutationMatrix::identity(3).to_dense<int>() == Matrix<int>::eye(3));
+}
+
+TEST_CASE("PermutationMatrix: products gather rows and scatter columns") {
+    PermutationMatrix p({3, 1, 2});
+    Matrix<int> dense = p.to_dense<int>();
+    Matrix<int> a = Matrix<int>::natural(3, 4);
+    Matrix<int> b = Matrix<int>::natural(2, 3);
+    Matrix<int> x = Matrix<int>::natural(3, 1);
+
+    REQUIRE(p * a == dense * a);
+    REQUIRE(b * p == b * dense);
+    REQUIRE((p * Vector<int>::from_matrix(x)).to_matrix() == dense * x);
+    REQUIRE_THROWS(p * b);
+}
+
+TEST_CASE("PermutationMatrix: composition and inverse") {
+    PermutationMatrix p({3, 1, 2});
+    PermutationMatrix q = PermutationMatrix::swap(3, 1, 2);
+    Matrix<int> dense_p = p.to_dense<int>();
+    Matrix<int> dense_q = q.to_dense<int>();
+
+    REQUIRE((p * q).to_dense<int>() == dense_p * dense_q);
+    REQUIRE(p * p.inverse() == PermutationMatrix::identity(3));
+    REQUIRE(p.transpose().to_dense<int>() == dense_p.transpose());
+}
@@ -0,0 +1,158 @@
+#include "catch.hpp"
+
+#include <atomic>
+#include <cmath>
+#include "../src/TiledMatrix.h"
+
+static Matrix<double> task_graph_spd(int size) {
+    Matrix<double> m = Matrix<double>::zeros(size);
+    for (int i = 1; i <= size; ++i) {
+        for (int j = 1; j <= size; ++j) {
+            m.at(i, j) = 1.0 / (i + j) + (i == j ? size : 0);
+        }
+    }
+    return m;
+}
+
+static double task_graph_difference(const Matrix<double>& a, const Matrix<double>& b) {
+    double largest = 0;
+    for (int i = 1; i <= a.rows(); ++i) {
+        for (int j = 1; j <= a.cols(); ++j) {
+            largest = std::max(largest, std::abs(a.at(i, j) - b.at(i, j)));
+        }
+    }
+    return largest;
+}
+
+TEST_CASE("Task graph: writers and readers are ordered") {
+    TaskGraph graph;
+    TaskGraph::Handle h = graph.handle();
+    std::vector<int> log;
+    std::mutex log_mutex;
+    int value = 0;
+
+    graph.submit([&]() { value = 1; }, {}, {h});
+    std::atomic<int> seen_one(0);
+    for (int i = 0; i < 10; ++i) {
+        graph.submit([&]() {
+            if (value == 1) {
+                seen_one++;
+            }
+        }, {h}, {});
+    }
+    graph.submit([&]() { value = 2; }, {}, {h});
+    graph.submit([&]() {
+        std::lock_guard<std::mutex> lock(log_mutex);
+        log.push_back(value);
+    }, {h}, {});
+
+    REQUIRE(graph.tasks() == 13);
+    graph.wait();
+    REQUIRE(graph.tasks() == 0);
+    REQUIRE(seen_one == 10);
+    REQUIRE(log.size() == 1);
+    REQUIRE(log[0] == 2);
+}
+
+TEST_CASE("Task graph: independent chains all complete") {
+    TaskGraph graph;
+    std::vector<TaskGraph::Handle> handles;
+    std::vector<int> counters(16, 0);
+    for (int i = 0; i < 16; ++i) {
+        handles.push_back(graph.handle());
+    }
+    for (int step = 0; step < 100; ++step) {
+        for (int i = 0; i < 16; ++i) {
+            int* counter = &counters[i];
+            graph.submit([counter]() { ++*counter; }, {}, {handles[i]});
+        }
+    }
+    graph.wait();
+    for (int i = 0; i < 16; ++i) {
+        REQUIRE(counters[i] == 100);
+    }
+}
+
+TEST_CASE("Task graph: exception is rethrown by wait") {
+    TaskGraph graph;
+    TaskGraph::Handle h = graph.handle();
+    bool later = false;
+    graph.submit([]() { throw std::runtime_error("failure"); }, {}, {h});
+    graph.submit([&later]() { later = true; }, {h}, {});
+    REQUIRE_THROWS_WITH(graph.wait(), "failure");
+    REQUIRE(!later);
+
+    // graph stays usable
+    graph.submit([&later]() { later = true; }, {h}, {});
+    graph.wait();
+    REQUIRE(later);
+
+    REQUIRE_THROWS(graph.submit([]() {}, {TaskGraph::Handle{5}}, {}));
+}
+
+TEST_CASE("Task graph: tiled matrix round trip") {
+    Matrix<int> m = Matrix<int>::natural(7, 5);
+    TiledMatrix<int> tiled = TiledMatrix<int>::from_dense(m, 3);
+    REQUIRE(tiled.tile_rows() == 3);
+    REQUIRE(tiled.tile_cols() == 2);
+    REQUIRE(tiled.tile(3, 2).rows() == 1);
+    REQUIRE(tiled.tile(3, 2).cols() == 2);
+    REQUIRE(tiled.tile(2, 1).at(1, 1) == m.at(4, 1));
+    REQUIRE(tiled.to_dense() == m);
+    REQUIRE_THROWS(tiled.tile(4, 1));
+    REQUIRE_THROWS(TiledMatrix<int>::from_dense(m, 0));
+}
+
+TEST_CASE("Task graph: tiled LU reproduces the matrix") {
+    for (int tile : {1, 4, 7, 40}) {
+        Matrix<double> a = task_graph_spd(30);
+        a.at(1, 30) = 3;
+        a.at(25, 2) = -2;
+        TiledMatrix<double> tiled = TiledMatrix<double>::from_dense(a, tile);
+        tiled.lu();
+        Matrix<double> factors = tiled.to_dense();
+
+        Matrix<double> l = Matrix<double>::eye(30);
+        Matrix<double> u = Matrix<double>::zeros(30);
+        for (int i = 1; i <= 30; ++i) {
+            for (int j = 1; j <= 30; ++j) {
+                if (j < i) {
+                    l.at(i, j) = factors.at(i, j);
+                } else {
+                    u.at(i, j) = factors.at(i, j);
+                }
+            }
+        }
+        REQUIRE(task_graph_difference(l * u, a) < 1e-10);
+    }
+}
+
+TEST_CASE("Task graph: tiled LU zero pivot") {
+    Matrix<double> a = Matrix<double>::zeros(4);
+    TiledMatrix<double> tiled = TiledMatrix<double>::from_dense(a, 2);
+    REQUIRE_THROWS(tiled.lu());
+}
+
+TEST_CASE("Task graph: tiled Cholesky reproduces the matrix") {
+    for (int tile : {1, 5, 8, 50}) {
+        Matrix<double> a = task_graph_spd(37);
+        TiledMatrix<double> tiled = TiledMatrix<double>::from_dense(a, tile);
+        tiled.cholesky();
+        Matrix<double> l = tiled.to_dense();
+
+        for (int i = 1; i <= 37; ++i) {
+            for (int j = i + 1; j <= 37; ++j) {
+                REQUIRE(l.at(i, j) == 0);
+            }
+        }
+        Matrix<double> lt = l.transpose();
+        REQUIRE(task_graph_difference(l * lt, a) < 1e-10);
+    }
+}
+
+TEST_CASE("Task graph: tiled Cholesky rejects indefinite matrix") {
+    Matrix<double> a = Matrix<double>::eye(6);
+    a.at(5, 5) = -1;
+    TiledMatrix<double> tiled = TiledMatrix<double>::from_dense(a, 2);
+    REQUIRE_THROWS(tiled.cholesky());
+}
@@ -0,0 +1,45 @@
+#ifndef _TEMP_FILE_H
+#define _TEMP_FILE_H
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+#include <unistd.h>
+
+/**
+ * Unique file under /tmp, created empty with mkstemp and removed when leaving scope, so tests leave
+ * nothing behind even when an assertion fails.
+ */
+class TempFile {
+public:
+
+    explicit TempFile(const std::string& name) {
+        std::string pattern = "/tmp/zbp-" + name + "-XXXXXX";
+        std::vector<char> buffer(pattern.begin(), pattern.end());
+        buffer.push_back('\0');
+        int fd = mkstemp(buffer.data());
+        if (fd < 0) {
+            throw std::runtime_error("Cannot create temporary file " + pattern);
+        }
+        ::close(fd);
+        _path = buffer.data();
+    }
+
+    TempFile(const TempFile&) = delete;
+
+    ~TempFile() {
+        std::remove(_path.c_str());
+    }
+
+    const std::string& path() const {
+        return _path;
+    }
+
+private:
+    std::string _path;
+};
+
+#endif
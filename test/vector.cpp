@@ -0,0 +1,82 @@
+#include "catch.hpp"
+
+#include "../src/Vector.h"
+
+TEST_CASE("Vector: should create zeros and throw on nonpositive size") {
+    Vector<int> v = Vector<int>::zeros(3);
+
+    REQUIRE(v.size() == 3);
+    REQUIRE(v.at(1) == 0);
+    REQUIRE(v.at(3) == 0);
+    REQUIRE_THROWS(Vector<int>::zeros(0));
+    REQUIRE_THROWS(v.at(0));
+    REQUIRE_THROWS(v.at(4));
+}
+
+TEST_CASE("Vector: should convert from and to Nx1 matrix") {
+    Matrix<int> column = Matrix<int>::natural(4, 1);
+    Vector<int> v = Vector<int>::from_matrix(column);
+
+    REQUIRE(v.size() == 4);
+    REQUIRE(v.at(2) == 2);
+    REQUIRE(v.to_matrix() == column);
+    REQUIRE(Vector<int>::from_matrix(Matrix<int>::natural(1, 4)) == v);
+    REQUIRE_THROWS(Vector<int>::from_matrix(Matrix<int>::natural(2, 2)));
+}
+
+TEST_CASE("Vector: dot product") {
+    Vector<int> v = Vector<int>::from_matrix(Matrix<int>::natural(1, 7));
+
+    REQUIRE(v.dot(v) == 140);
+    REQUIRE_THROWS(v.dot(Vector<int>::zeros(2)));
+}
+
+TEST_CASE("gemv: should match operator*") {
+    Matrix<int> a = Matrix<int>::natural(3, 5);
+    Matrix<int> x = Matrix<int>::natural(5, 1);
+
+    Vector<int> y = gemv(a, Vector<int>::from_matrix(x));
+    REQUIRE(y.to_matrix() == a * x);
+}
+
+TEST_CASE("gemv: should work on views") {
+    Matrix<int> a = Matrix<int>::natural(4, 4);
+    Matrix<int> view = a.view(2, 2, 3, 4);
+    Vector<int> x = Vector<int>::from_matrix(Matrix<int>::natural(3, 1));
+
+    Vector<int> y = gemv(view, x);
+    REQUIRE(y.at(1) == 6 * 1 + 7 * 2 + 8 * 3);
+    REQUIRE(y.at(2) == 10 * 1 + 11 * 2 + 12 * 3);
+}
+
+TEST_CASE("gemv: should throw on invalid dimensions") {
+    REQUIRE_THROWS(gemv(Matrix<int>::zeros(2, 3), Vector<int>::zeros(2)));
+    REQUIRE_THROWS(gemv_transposed(Matrix<int>::zeros(2, 3), Vector<int>::zeros(3)));
+}
+
+TEST_CASE("gemv_transposed: should match transposed product") {
+    Matrix<int> a = Matrix<int>::natural(3, 5);
+    Matrix<int> x = Matrix<int>::natural(3, 1);
+
+    Vector<int> y = gemv_transposed(a, Vector<int>::from_matrix(x));
+    REQUIRE(y.to_matrix() == a.transpose() * x);
+}
+
+TEST_CASE("gemv: large products are split between threads") {
+    int n = 400;
+    Matrix<long> a = Matrix<long>::zeros(n, n);
+    Vector<long> x = Vector<long>::zeros(n);
+    for (int i = 1; i <= n; ++i) {
+        x.at(i) = 1;
+        for (int j = 1; j <= n; ++j) {
+            a.at(i, j) = i;
+        }
+    }
+
+    Vector<long> y = gemv(a, x);
+    Vector<long> t = gemv_transposed(a, x);
+    for (int i = 1; i <= n; ++i) {
+        REQUIRE(y.at(i) == static_cast<long>(i) * n);
+        REQUIRE(t.at(i) == static_cast<long>(n) * (n + 1) / 2);
+    }
+}